@@ -0,0 +1,107 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef CLASSES_BLOOM_FILTER_H
+#define CLASSES_BLOOM_FILTER_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+
+namespace Firebird
+{
+
+// Register-blocked bloom filter over 32-bit hash values.
+// Every value sets (and tests) a few bits inside a single 64-bit word,
+// so both operations access exactly one cache line.
+
+class BloomFilter : public PermanentStorage
+{
+	static const unsigned BITS_PER_VALUE = 16;
+	static const unsigned BITS_PER_WORD = 64;
+	static const unsigned HASH_COUNT = 4;
+	static const FB_SIZE_T MAX_WORDS = 1u << 23;	// 64MB
+
+public:
+	BloomFilter(MemoryPool& pool, FB_SIZE_T expectedCount)
+		: PermanentStorage(pool), m_words(pool), m_mask(0)
+	{
+		const FB_UINT64 bits = (FB_UINT64) MAX(expectedCount, 1u) * BITS_PER_VALUE;
+
+		FB_SIZE_T count = 1;
+		while (count < MAX_WORDS && (FB_UINT64) count * BITS_PER_WORD < bits)
+			count <<= 1;
+
+		FB_UINT64* const words = m_words.getBuffer(count, false);
+		memset(words, 0, count * sizeof(FB_UINT64));
+
+		m_mask = count - 1;
+	}
+
+	void add(ULONG hash)
+	{
+		const FB_UINT64 value = mix(hash);
+		m_words[getWord(value)] |= getBits(value);
+	}
+
+	bool mayContain(ULONG hash) const
+	{
+		const FB_UINT64 value = mix(hash);
+		const FB_UINT64 bits = getBits(value);
+		return (m_words[getWord(value)] & bits) == bits;
+	}
+
+	FB_SIZE_T getSize() const
+	{
+		return m_words.getCount() * sizeof(FB_UINT64);
+	}
+
+private:
+	static FB_UINT64 mix(ULONG hash)
+	{
+		FB_UINT64 value = hash;
+		value *= FB_CONST64(0x9E3779B97F4A7C15);
+		value ^= value >> 29;
+		value *= FB_CONST64(0xBF58476D1CE4E5B9);
+		value ^= value >> 32;
+		return value;
+	}
+
+	FB_SIZE_T getWord(FB_UINT64 value) const
+	{
+		return (FB_SIZE_T) (value >> 32) & m_mask;
+	}
+
+	static FB_UINT64 getBits(FB_UINT64 value)
+	{
+		FB_UINT64 bits = 0;
+
+		for (unsigned i = 0; i < HASH_COUNT; i++, value >>= 6)
+			bits |= FB_CONST64(1) << (value & (BITS_PER_WORD - 1));
+
+		return bits;
+	}
+
+	Array<FB_UINT64> m_words;
+	FB_SIZE_T m_mask;
+};
+
+} // namespace Firebird
+
+#endif // CLASSES_BLOOM_FILTER_H
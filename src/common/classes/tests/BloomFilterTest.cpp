@@ -0,0 +1,56 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/BloomFilter.h"
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(BloomFilterSuite)
+
+
+BOOST_AUTO_TEST_CASE(NoFalseNegativesTest)
+{
+	const ULONG count = 10000;
+	BloomFilter filter(*getDefaultMemoryPool(), count);
+
+	for (ULONG i = 0; i < count; i++)
+		filter.add(i * 7919);
+
+	for (ULONG i = 0; i < count; i++)
+		BOOST_TEST(filter.mayContain(i * 7919));
+}
+
+
+BOOST_AUTO_TEST_CASE(FalsePositiveRateTest)
+{
+	const ULONG count = 10000;
+	BloomFilter filter(*getDefaultMemoryPool(), count);
+
+	for (ULONG i = 0; i < count; i++)
+		filter.add(i);
+
+	ULONG falsePositives = 0;
+
+	for (ULONG i = count; i < count * 11; i++)
+	{
+		if (filter.mayContain(i))
+			falsePositives++;
+	}
+
+	// Expected rate is well below 1% for 16 bits per value
+	BOOST_TEST(falsePositives < count * 10 / 100);
+}
+
+
+BOOST_AUTO_TEST_CASE(EmptyFilterTest)
+{
+	BloomFilter filter(*getDefaultMemoryPool(), 0);
+
+	BOOST_TEST(filter.getSize() == sizeof(FB_UINT64));
+	BOOST_TEST(!filter.mayContain(0));
+	BOOST_TEST(!filter.mayContain(12345));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BloomFilterSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
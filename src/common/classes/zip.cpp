@@ -50,6 +50,7 @@ void ZLib::symbols()
 	FB_ZSYMB(deflateInit_)
 	FB_ZSYMB(inflateInit_)
 	FB_ZSYMB(deflate)
+	FB_ZSYMB(deflateParams)
 	FB_ZSYMB(inflate)
 	FB_ZSYMB(deflateEnd)
 	FB_ZSYMB(inflateEnd)
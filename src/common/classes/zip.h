@@ -42,6 +42,7 @@ namespace Firebird {
 		int ZEXPORT (*deflateInit_)(z_stream* strm, int level, const char *version, int stream_size);
 		int ZEXPORT (*inflateInit_)(z_stream* strm, const char *version, int stream_size);
 		int ZEXPORT (*deflate)(z_stream* strm, int flush);
+		int ZEXPORT (*deflateParams)(z_stream* strm, int level, int strategy);
 		int ZEXPORT (*inflate)(z_stream* strm, int flush);
 		void ZEXPORT (*deflateEnd)(z_stream* strm);
 		void ZEXPORT (*inflateEnd)(z_stream* strm);
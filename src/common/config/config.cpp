@@ -430,6 +430,23 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_HASH_JOIN_MEMORY_LIMIT, 0, true);
+
+	checkIntForLoBound(KEY_READ_AHEAD_PAGES, 0, true);
+	checkIntForHiBound(KEY_READ_AHEAD_PAGES, MAX_READ_AHEAD_PAGES, false);
+
+	checkIntForLoBound(KEY_WIRE_COMPRESSION_LEVEL, 1, false);
+	checkIntForHiBound(KEY_WIRE_COMPRESSION_LEVEL, 9, false);
+
+	checkIntForLoBound(KEY_WIRE_COMPRESSION_THRESHOLD, 0, true);
+
+	checkIntForLoBound(KEY_STATEMENT_TEMP_CACHE_LIMIT, 0, true);
+
+	checkIntForLoBound(KEY_HASH_AGGREGATE_MEMORY_LIMIT, 0, true);
+
+	checkIntForLoBound(KEY_GC_PARALLEL_WORKERS, 1, true);
+	checkIntForHiBound(KEY_GC_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
 }
 
 
@@ -90,6 +90,8 @@ const int MODE_CLASSIC = 2;
 
 const char* const CONFIG_FILE = "firebird.conf";
 
+const int MAX_READ_AHEAD_PAGES = 256;
+
 struct ConfigValue
 {
 	ConfigValue() : intVal(0) {};
@@ -187,6 +189,17 @@ enum ConfigKey
 	KEY_PARALLEL_WORKERS,
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
+	KEY_HASH_JOIN_MEMORY_LIMIT,
+	KEY_READ_AHEAD_PAGES,
+	KEY_DB_CACHE_HUGE_PAGES,
+	KEY_DB_CACHE_NUMA_POLICY,
+	KEY_WIRE_COMPRESSION_LEVEL,
+	KEY_WIRE_COMPRESSION_THRESHOLD,
+	KEY_LZ_RECORD_COMPRESSION,
+	KEY_TEMP_COMPRESSION,
+	KEY_STATEMENT_TEMP_CACHE_LIMIT,
+	KEY_HASH_AGGREGATE_MEMORY_LIMIT,
+	KEY_GC_PARALLEL_WORKERS,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -300,7 +313,18 @@ constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"MaxStatementCacheSize",	false,	2 * 1048576},	// bytes
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
-	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false}
+	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
+	{TYPE_INTEGER,	"HashJoinMemoryLimit",		false,	64 * 1048576},	// bytes
+	{TYPE_INTEGER,	"ReadAheadPages",			false,	32},	// pages
+	{TYPE_BOOLEAN,	"DbCacheHugePages",			false,	false},
+	{TYPE_STRING,	"DbCacheNumaPolicy",		false,	""},
+	{TYPE_INTEGER,	"WireCompressionLevel",		false,	6},
+	{TYPE_INTEGER,	"WireCompressionThreshold",	false,	128},	// bytes
+	{TYPE_BOOLEAN,	"LZRecordCompression",		false,	false},
+	{TYPE_BOOLEAN,	"TempCompression",			true,	false},
+	{TYPE_INTEGER,	"StatementTempCacheLimit",	false,	0},		// bytes
+	{TYPE_INTEGER,	"HashAggregateMemoryLimit",	false,	64 * 1048576},	// bytes
+	{TYPE_INTEGER,	"GCParallelWorkers",		false,	1}
 };
 
 
@@ -624,6 +648,28 @@ public:
 	CONFIG_GET_GLOBAL_INT(getMaxParallelWorkers, KEY_MAX_PARALLEL_WORKERS);
 
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
+
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getHashJoinMemoryLimit, KEY_HASH_JOIN_MEMORY_LIMIT, getInt);
+
+	CONFIG_GET_PER_DB_INT(getReadAheadPages, KEY_READ_AHEAD_PAGES);
+
+	CONFIG_GET_PER_DB_BOOL(getDbCacheHugePages, KEY_DB_CACHE_HUGE_PAGES);
+
+	CONFIG_GET_PER_DB_STR(getDbCacheNumaPolicy, KEY_DB_CACHE_NUMA_POLICY);
+
+	CONFIG_GET_PER_DB_INT(getWireCompressionLevel, KEY_WIRE_COMPRESSION_LEVEL);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getWireCompressionThreshold, KEY_WIRE_COMPRESSION_THRESHOLD, getInt);
+
+	CONFIG_GET_PER_DB_BOOL(getLZRecordCompression, KEY_LZ_RECORD_COMPRESSION);
+
+	CONFIG_GET_GLOBAL_BOOL(getTempCompression, KEY_TEMP_COMPRESSION);
+
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getStatementTempCacheLimit, KEY_STATEMENT_TEMP_CACHE_LIMIT, getInt);
+
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getHashAggregateMemoryLimit, KEY_HASH_AGGREGATE_MEMORY_LIMIT, getInt);
+
+	CONFIG_GET_PER_DB_INT(getGCParallelWorkers, KEY_GC_PARALLEL_WORKERS);
 };
 
 // Implementation of interface to access master configuration file
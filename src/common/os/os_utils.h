@@ -83,6 +83,11 @@ namespace os_utils
 
 	bool getCurrentModulePath(char* buffer, size_t bufferSize);
 
+	// placement hints for big long living memory blocks (page cache),
+	// should be given before the memory is touched for the first time
+	bool adviseHugePages(void* address, size_t length);
+	bool bindMemory(void* address, size_t length, FB_UINT64 nodeMask, bool interleave);
+
 	// force descriptor to have O_CLOEXEC set
 	int open(const char* pathname, int flags, mode_t mode = DEFAULT_OPEN_MODE);
 	void setCloseOnExec(int fd);	// posix only
@@ -90,6 +90,10 @@
 #include <utime.h>
 #endif
 
+#ifdef LINUX
+#include <sys/syscall.h>
+#endif
+
 #include <stdio.h>
 
 using namespace Firebird;
@@ -434,6 +438,61 @@ void getUniqueFileId(const char* name, UCharBuffer& id)
 	makeUniqueFileId(statistics, id);
 }
 
+// Shrink [address, address + length) to the system pages it covers completely
+
+static bool alignToPages(void*& address, size_t& length)
+{
+	const size_t pageSize = sysconf(_SC_PAGESIZE);
+	UCHAR* const begin = FB_ALIGN((UCHAR*) address, pageSize);
+	UCHAR* const end = (UCHAR*) (((U_IPTR) address + length) & ~(U_IPTR) (pageSize - 1));
+
+	if (end <= begin)
+		return false;
+
+	address = begin;
+	length = end - begin;
+	return true;
+}
+
+
+bool adviseHugePages(void* address, size_t length)
+{
+#ifdef MADV_HUGEPAGE
+	if (!alignToPages(address, length))
+		return false;
+
+	return ::madvise(address, length, MADV_HUGEPAGE) == 0;
+#else
+	return false;
+#endif
+}
+
+
+bool bindMemory(void* address, size_t length, FB_UINT64 nodeMask, bool interleave)
+{
+#if defined(LINUX) && defined(SYS_mbind)
+	if (!nodeMask || !alignToPages(address, length))
+		return false;
+
+	// Values from <numaif.h>, libnuma is not required for the raw system call
+	const int MPOL_BIND_MODE = 2;
+	const int MPOL_INTERLEAVE_MODE = 3;
+
+	const unsigned BITS_PER_MASK_WORD = 8 * sizeof(unsigned long);
+	unsigned long mask[64 / BITS_PER_MASK_WORD];
+
+	for (unsigned i = 0; i < 64 / BITS_PER_MASK_WORD; i++)
+		mask[i] = (unsigned long) (nodeMask >> (i * BITS_PER_MASK_WORD));
+
+	return syscall(SYS_mbind, address, length,
+		interleave ? MPOL_INTERLEAVE_MODE : MPOL_BIND_MODE,
+		mask, (unsigned long) 64 + 1, 0) == 0;
+#else
+	return false;
+#endif
+}
+
+
 /// class CtrlCHandler
 
 bool CtrlCHandler::terminated = false;
@@ -621,6 +621,21 @@ void setDefaultAffinity()
 }
 
 
+// Large pages require SeLockMemoryPrivilege and have to be requested when
+// the memory is allocated, NUMA placement too - not supported for now
+
+bool adviseHugePages(void*, size_t)
+{
+	return false;
+}
+
+
+bool bindMemory(void*, size_t, FB_UINT64, bool)
+{
+	return false;
+}
+
+
 /// class CtrlCHandler
 
 bool CtrlCHandler::terminated = false;
@@ -435,6 +435,24 @@ bool AggNode::aggPass(thread_db* tdbb, Request* request) const
 	return true;
 }
 
+// Revert aggPass() of the current record. NULLs are skipped the same way.
+bool AggNode::aggRetract(thread_db* tdbb, Request* request) const
+{
+	if (distinct)
+		return false;
+
+	dsc* desc = NULL;
+
+	if (arg)
+	{
+		desc = EVL_expr(tdbb, request, arg);
+		if (request->req_flags & req_null)
+			return true;
+	}
+
+	return aggRetract(tdbb, request, desc);
+}
+
 void AggNode::aggFinish(thread_db* /*tdbb*/, Request* request) const
 {
 	if (asb)
@@ -867,6 +885,19 @@ dsc* AvgAggNode::aggExecute(thread_db* tdbb, Request* request) const
 	return &impureTemp->vlu_desc;
 }
 
+// Exact sums may be reverted, approximate ones would lose the precision
+bool AvgAggNode::aggRetract(thread_db* tdbb, Request* request, dsc* desc) const
+{
+	if (dialect1 || (nodFlags & (FLAG_DOUBLE | FLAG_DECFLOAT)))
+		return false;
+
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+	--impure->vlux_count;
+
+	ArithmeticNode::add2(tdbb, desc, impure, this, blr_subtract);
+	return true;
+}
+
 AggNode* AvgAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) AvgAggNode(dsqlScratch->getPool(), distinct, dialect1,
@@ -1104,6 +1135,16 @@ void CountAggNode::aggPass(thread_db* /*tdbb*/, Request* request, dsc* /*desc*/)
 		++impure->vlu_misc.vlu_int64;
 }
 
+void CountAggNode::aggPassCount(Request* request, FB_UINT64 count) const
+{
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+
+	if (dialect1)
+		impure->vlu_misc.vlu_long += (SLONG) count;
+	else
+		impure->vlu_misc.vlu_int64 += (SINT64) count;
+}
+
 dsc* CountAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 {
 	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
@@ -1114,6 +1155,18 @@ dsc* CountAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 	return &impure->vlu_desc;
 }
 
+bool CountAggNode::aggRetract(thread_db* /*tdbb*/, Request* request, dsc* /*desc*/) const
+{
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+
+	if (dialect1)
+		--impure->vlu_misc.vlu_long;
+	else
+		--impure->vlu_misc.vlu_int64;
+
+	return true;
+}
+
 AggNode* CountAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) CountAggNode(dsqlScratch->getPool(), distinct, dialect1,
@@ -1376,6 +1429,19 @@ dsc* SumAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 	return &impure->vlu_desc;
 }
 
+// Exact sums may be reverted, approximate ones would lose the precision
+bool SumAggNode::aggRetract(thread_db* tdbb, Request* request, dsc* desc) const
+{
+	if (dialect1 || (nodFlags & (FLAG_DOUBLE | FLAG_DECFLOAT)))
+		return false;
+
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+	--impure->vlux_count;
+
+	ArithmeticNode::add2(tdbb, desc, impure, this, blr_subtract);
+	return true;
+}
+
 AggNode* SumAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) SumAggNode(dsqlScratch->getPool(), distinct, dialect1,
@@ -1466,6 +1532,24 @@ dsc* MaxMinAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 	return &impure->vlu_desc;
 }
 
+// The value may be removed only if it does not define the current result,
+// otherwise the new extreme is unknown
+bool MaxMinAggNode::aggRetract(thread_db* tdbb, Request* request, dsc* desc) const
+{
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+
+	if (!impure->vlu_desc.dsc_dtype)
+		return false;
+
+	const int result = MOV_compare(tdbb, desc, &impure->vlu_desc);
+
+	if ((type == TYPE_MAX && result >= 0) || (type == TYPE_MIN && result <= 0))
+		return false;
+
+	--impure->vlux_count;
+	return true;
+}
+
 AggNode* MaxMinAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) MaxMinAggNode(dsqlScratch->getPool(),
@@ -27,9 +27,12 @@
 #include "../jrd/EngineInterface.h"
 #include "../jrd/jrd.h"
 #include "../jrd/status.h"
+#include "../jrd/tra.h"
 #include "../jrd/exe_proto.h"
+#include "../jrd/btr.h"
 #include "../dsql/dsql.h"
 #include "../dsql/errd_proto.h"
+#include "../dsql/movd_proto.h"
 #include "../common/classes/ClumpletWriter.h"
 #include "../common/classes/auto.h"
 #include "../common/classes/fb_string.h"
@@ -667,102 +670,158 @@ private:
 	const auto receiveMessage = isExecBlock ? m_dsqlRequest->getDsqlStatement()->getReceiveMsg() : nullptr;
 	auto receiveMsgBuffer = isExecBlock ? m_dsqlRequest->req_msg_buffers[receiveMessage->msg_buffer_number] : nullptr;
 
-	// process messages
-	ULONG remains;
-	UCHAR* data;
-	while ((remains = m_messages.get(&data)) > 0)
+	// Keys of non-unique indices are collected and put into the indices in key order
+	// after a bunch of messages. Only plain INSERT is covered, as other statements
+	// may look for the stored records (MERGE, UPDATE OR INSERT) or run anything.
+	const bool deferKeys = (m_dsqlRequest->getDsqlStatement()->getFlags() & DsqlStatement::FLAG_PLAIN_INSERT);
+	BulkIndexKeys bulkKeys(*tdbb->getDefaultPool());
+	AutoSetRestore<BulkIndexKeys*> bulkKeysMode(&req->req_bulk_keys, deferKeys ? &bulkKeys : nullptr);
+
+	// Savepoints of the stored records are already released, so the only way
+	// to undo the records left without index entries is the transaction rollback
+	const auto flushKeys = [&]()
 	{
-		if (remains < m_messageSize)
+		try
 		{
-			ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
-				Arg::Gds(isc_batch_blob_buf) <<
-				Arg::Gds(isc_batch_small_data) << "messages");
+			bulkKeys.flush(tdbb, transaction);
 		}
-
-		while (remains >= m_messageSize)
+		catch (const Exception&)
 		{
-			// skip alignment data
-			UCHAR* alignedData = FB_ALIGN(data, m_alignment);
-			if (alignedData != data)
-			{
-				remains -= (alignedData - data);
-				data = alignedData;
-				continue;
-			}
+			transaction->tra_flags |= TRA_invalidated;
+			throw;
+		}
+	};
 
-			const bool start = startRequest;
-			if (startRequest)
+	// process messages
+	ULONG remains;
+	UCHAR* data;
+	try
+	{
+		while ((remains = m_messages.get(&data)) > 0)
+		{
+			if (remains < m_messageSize)
 			{
-				EXE_unwind(tdbb, req);
-				EXE_start(tdbb, req, transaction);
-				startRequest = isExecBlock;
+				ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
+					Arg::Gds(isc_batch_blob_buf) <<
+					Arg::Gds(isc_batch_small_data) << "messages");
 			}
 
-			// translate blob IDs
-			fb_assert(intptr_t(data) % m_alignment == 0);
-			for (unsigned i = 0; i < m_blobMeta.getCount(); ++i)
+			while (remains >= m_messageSize)
 			{
-				const SSHORT* nullFlag = reinterpret_cast<const SSHORT*>(&data[m_blobMeta[i].nullOffset]);
-				if (*nullFlag)
-					continue;
-
-				ISC_QUAD* id = reinterpret_cast<ISC_QUAD*>(&data[m_blobMeta[i].offset]);
-				if (id->gds_quad_high == 0 && id->gds_quad_low == 0)
+				// skip alignment data
+				UCHAR* alignedData = FB_ALIGN(data, m_alignment);
+				if (alignedData != data)
+				{
+					remains -= (alignedData - data);
+					data = alignedData;
 					continue;
+				}
 
-				ISC_QUAD newId;
-				if (!m_blobMap.get(*id, newId))
+				const bool start = startRequest;
+				if (startRequest)
 				{
-					ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
-						Arg::Gds(isc_batch_blob_id) << Arg::Quad(id));
+					EXE_unwind(tdbb, req);
+					EXE_start(tdbb, req, transaction);
+					startRequest = isExecBlock;
 				}
 
-				m_blobMap.remove(*id);
-				*id = newId;
-			}
+				// translate blob IDs
+				fb_assert(intptr_t(data) % m_alignment == 0);
+				for (unsigned i = 0; i < m_blobMeta.getCount(); ++i)
+				{
+					const SSHORT* nullFlag = reinterpret_cast<const SSHORT*>(&data[m_blobMeta[i].nullOffset]);
+					if (*nullFlag)
+						continue;
 
-			// map message to internal engine format
-			// pass m_meta one time only to avoid parsing its metadata for every message
-			m_dsqlRequest->mapInOut(tdbb, false, message, start ? m_meta : nullptr, nullptr, data);
-			data += m_messageSize;
-			remains -= m_messageSize;
+					ISC_QUAD* id = reinterpret_cast<ISC_QUAD*>(&data[m_blobMeta[i].offset]);
+					if (id->gds_quad_high == 0 && id->gds_quad_low == 0)
+						continue;
 
-			UCHAR* msgBuffer = m_dsqlRequest->req_msg_buffers[message->msg_buffer_number];
-			try
-			{
-				// runsend data to request and collect stats
-				ULONG before = req->req_records_inserted + req->req_records_updated +
-					req->req_records_deleted;
-				EXE_send(tdbb, req, message->msg_number, message->msg_length, msgBuffer);
-				ULONG after = req->req_records_inserted + req->req_records_updated +
-					req->req_records_deleted;
-				completionState->regUpdate(after - before);
-
-				if (isExecBlock)
-					EXE_receive(tdbb, req, receiveMessage->msg_number, receiveMessage->msg_length, receiveMsgBuffer);
-			}
-			catch (const Exception& ex)
-			{
-				FbLocalStatus status;
-				ex.stuffException(&status);
-				tdbb->tdbb_status_vector->init();
+					ISC_QUAD newId;
+					if (!m_blobMap.get(*id, newId))
+					{
+						ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
+							Arg::Gds(isc_batch_blob_id) << Arg::Quad(id));
+					}
 
-				JTransliterate trLit(tdbb);
-				completionState->regError(&status, &trLit);
+					m_blobMap.remove(*id);
+					*id = newId;
+				}
 
-				if (!(m_flags & (1 << IBatch::TAG_MULTIERROR)))
+				// map message to internal engine format
+				// pass m_meta one time only to avoid parsing its metadata for every message,
+				// next messages are copied using the moves prepared from it
+				if (start)
 				{
-					cancel(tdbb);
-					remains = 0;
-					break;
+					m_dsqlRequest->mapInOut(tdbb, false, message, m_meta, nullptr, data);
+					prepareMoves(message);
 				}
+				else if (m_fastMoves)
+					moveParams(tdbb, data);
+				else
+					m_dsqlRequest->mapInOut(tdbb, false, message, nullptr, nullptr, data);
+				data += m_messageSize;
+				remains -= m_messageSize;
+
+				UCHAR* msgBuffer = m_dsqlRequest->req_msg_buffers[message->msg_buffer_number];
+				const FB_SIZE_T keysMark = bulkKeys.getCount();
+				try
+				{
+					// runsend data to request and collect stats
+					ULONG before = req->req_records_inserted + req->req_records_updated +
+						req->req_records_deleted;
+					EXE_send(tdbb, req, message->msg_number, message->msg_length, msgBuffer);
+					ULONG after = req->req_records_inserted + req->req_records_updated +
+						req->req_records_deleted;
+					completionState->regUpdate(after - before);
+
+					if (isExecBlock)
+						EXE_receive(tdbb, req, receiveMessage->msg_number, receiveMessage->msg_length, receiveMsgBuffer);
+				}
+				catch (const Exception& ex)
+				{
+					// records of the failed message were undone
+					bulkKeys.truncate(keysMark);
+
+					FbLocalStatus status;
+					ex.stuffException(&status);
+					tdbb->tdbb_status_vector->init();
+
+					JTransliterate trLit(tdbb);
+					completionState->regError(&status, &trLit);
+
+					if (!(m_flags & (1 << IBatch::TAG_MULTIERROR)))
+					{
+						cancel(tdbb);
+						remains = 0;
+						break;
+					}
 
-				startRequest = true;
+					startRequest = true;
+				}
+
+				if (bulkKeys.isFull())
+					flushKeys();
 			}
+
+			UCHAR* alignedData = FB_ALIGN(data, m_alignment);
+			m_messages.remained(remains, alignedData - data);
 		}
 
-		UCHAR* alignedData = FB_ALIGN(data, m_alignment);
-		m_messages.remained(remains, alignedData - data);
+		flushKeys();
+	}
+	catch (const Exception&)
+	{
+		// stored records must not be left without index entries,
+		// if that fails the transaction is already invalidated
+		try
+		{
+			flushKeys();
+		}
+		catch (const Exception&)
+		{} // no-op
+
+		throw;
 	}
 
 	DEB_BATCH(fprintf(stderr, "Sent %d messages\n", completionState->getSize(tdbb->tdbb_status_vector)));
@@ -780,6 +839,87 @@ private:
 	return completionState.release();
 }
 
+void DsqlBatch::prepareMoves(const dsql_msg* message)
+{
+	// Per message mapInOut() looks up the user descriptors of each parameter.
+	// All messages of a batch share the same format, so do it once here.
+
+	m_moves.clear();
+	m_fastMoves = false;
+
+	const auto dsqlStatement = m_dsqlRequest->getDsqlStatement();
+	if (dsqlStatement->getParentDbKey() || dsqlStatement->getParentRecVersion())
+		return;
+
+	for (const auto parameter : message->msg_parameters)
+	{
+		if (!parameter->par_index)
+			continue;
+
+		ParamMove move;
+		if (!m_dsqlRequest->req_user_descs.get(parameter, move.from))
+			return;
+
+		UCHAR* const msgBuffer =
+			m_dsqlRequest->req_msg_buffers[parameter->par_message->msg_buffer_number];
+
+		move.to = parameter->par_desc;
+		move.to.dsc_address = msgBuffer + (IPTR) move.to.dsc_address;
+		move.toNull = nullptr;
+		move.fromNull = 0;
+
+		if (const auto nullInd = parameter->par_null)
+		{
+			dsc userNullDesc;
+			if (!m_dsqlRequest->req_user_descs.get(nullInd, userNullDesc))
+				return;
+
+			move.fromNull = (IPTR) userNullDesc.dsc_address;
+			move.toNull = msgBuffer + (IPTR) nullInd->par_desc.dsc_address;
+		}
+
+		move.plainCopy = !move.from.isText() && !DTYPE_IS_BLOB_OR_QUAD(move.from.dsc_dtype) &&
+			move.from.dsc_dtype == move.to.dsc_dtype &&
+			move.from.dsc_length == move.to.dsc_length &&
+			move.from.dsc_scale == move.to.dsc_scale &&
+			move.from.dsc_sub_type == move.to.dsc_sub_type;
+
+		m_moves.add(move);
+	}
+
+	m_fastMoves = true;
+}
+
+void DsqlBatch::moveParams(thread_db* tdbb, const UCHAR* data)
+{
+	for (auto& move : m_moves)
+	{
+		bool notNull = true;
+
+		if (move.toNull)
+		{
+			const SSHORT flag = *reinterpret_cast<const SSHORT*>(data + move.fromNull);
+			*reinterpret_cast<SSHORT*>(move.toNull) = flag;
+			notNull = (flag >= 0);
+		}
+
+		if (notNull && !move.to.isNull())
+		{
+			if (move.plainCopy)
+				memcpy(move.to.dsc_address, data + (IPTR) move.from.dsc_address, move.to.dsc_length);
+			else
+			{
+				// Safe cast because desc is used as source only.
+				dsc from = move.from;
+				from.dsc_address = const_cast<UCHAR*>(data) + (IPTR) from.dsc_address;
+				MOVD_move(tdbb, &from, &move.to);
+			}
+		}
+		else
+			memset(move.to.dsc_address, 0, move.to.dsc_length);
+	}
+}
+
 void DsqlBatch::cancel(thread_db* tdbb)
 {
 	m_messages.clear();
@@ -28,6 +28,7 @@
 #include "../common/classes/RefCounted.h"
 #include "../common/classes/vector.h"
 #include "../common/classes/GenericMap.h"
+#include "../common/dsc.h"
 
 #define DEB_BATCH(x)
 
@@ -92,6 +93,8 @@ private:
 	void registerBlob(const ISC_QUAD* engineBlob, const ISC_QUAD* batchBlob);
 	void setDefBpb(unsigned parLength, const unsigned char* par);
 	void putSegment(ULONG length, const void* inBuffer);
+	void prepareMoves(const dsql_msg* message);
+	void moveParams(thread_db* tdbb, const UCHAR* data);
 
 	void setFlag(UCHAR bit, bool value)
 	{
@@ -143,6 +146,16 @@ private:
 		unsigned nullOffset, offset;
 	};
 
+	// Precomputed copy of a parameter from the batch message into the request message
+	struct ParamMove
+	{
+		dsc from;			// dsc_address is an offset in the batch message
+		dsc to;				// dsc_address points into the request message
+		UCHAR* toNull;		// null flag in the request message
+		ULONG fromNull;		// offset of null flag in the batch message
+		bool plainCopy;		// same format, no conversion needed
+	};
+
 	class QuadComparator
 	{
 	public:
@@ -156,6 +169,7 @@ private:
 	DataCache m_blobs;
 	Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<ISC_QUAD, ISC_QUAD>>, QuadComparator> m_blobMap;
 	Firebird::HalfStaticArray<BlobMeta, 4> m_blobMeta;
+	Firebird::HalfStaticArray<ParamMove, 16> m_moves;
 	typedef Firebird::HalfStaticArray<UCHAR, 64> Bpb;
 	Bpb m_defaultBpb;
 	ISC_QUAD m_genId;
@@ -167,6 +181,7 @@ private:
 	ULONG m_bufferSize = BUFFER_LIMIT;
 	ULONG m_lastBlob = MAX_ULONG;
 	bool m_setBlobSize = false;
+	bool m_fastMoves = false;
 	UCHAR m_blobPolicy = Firebird::IBatch::BLOB_NONE;
 };
 
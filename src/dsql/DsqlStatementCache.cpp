@@ -108,9 +108,13 @@ RefPtr<DsqlStatement> DsqlStatementCache::getStatement(thread_db* tdbb, const st
 		dump();
 #endif
 
+		++hits;
+
 		return dsqlStatement;
 	}
 
+	++misses;
+
 	return {};
 }
 
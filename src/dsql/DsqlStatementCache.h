@@ -100,6 +100,16 @@ public:
 		return activeStatementList.isEmpty() && inactiveStatementList.isEmpty();
 	}
 
+	FB_UINT64 getHits() const
+	{
+		return hits;
+	}
+
+	FB_UINT64 getMisses() const
+	{
+		return misses;
+	}
+
 	Firebird::RefPtr<DsqlStatement> getStatement(thread_db* tdbb, const Firebird::string& text,
 		USHORT clientDialect, bool isInternalRequest);
 
@@ -139,6 +149,8 @@ private:
 	Firebird::AutoPtr<Lock> lock;
 	unsigned maxCacheSize = 0;
 	unsigned cacheSize = 0;
+	FB_UINT64 hits = 0;		// statements reused, reported as MON$STATEMENT_CACHE_HITS
+	FB_UINT64 misses = 0;	// statements compiled anew, reported as MON$STATEMENT_CACHE_MISSES
 };
 
 
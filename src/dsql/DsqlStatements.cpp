@@ -23,6 +23,7 @@
 #include "../dsql/DsqlStatements.h"
 #include "../dsql/dsql.h"
 #include "../dsql/Nodes.h"
+#include "../dsql/StmtNodes.h"
 #include "../dsql/DsqlCompilerScratch.h"
 #include "../dsql/DsqlStatementCache.h"
 #include "../jrd/Statement.h"
@@ -145,6 +146,9 @@ void DsqlDmlStatement::dsqlPass(thread_db* tdbb, DsqlCompilerScratch* scratch, n
 		node = Node::doDsqlPass(scratch, node);
 	}
 
+	if (nodeIs<StoreNode>(node))
+		addFlags(FLAG_PLAIN_INSERT);
+
 	if (scratch->clientDialect > SQL_DIALECT_V5)
 		scratch->getDsqlStatement()->setBlrVersion(5);
 	else
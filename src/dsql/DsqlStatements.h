@@ -64,6 +64,7 @@ public:
 	//static const unsigned FLAG_BLR_VERSION4	= 0x04;
 	//static const unsigned FLAG_BLR_VERSION5	= 0x08;
 	static const unsigned FLAG_SELECTABLE	= 0x10;
+	static const unsigned FLAG_PLAIN_INSERT	= 0x20;	// INSERT not being a part of MERGE or UPDATE OR INSERT
 
 	static void rethrowDdlException(Firebird::status_exception& ex, bool metadataUpdate, DdlNode* node);
 
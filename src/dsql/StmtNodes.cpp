@@ -8898,7 +8898,12 @@ const StmtNode* StoreNode::store(thread_db* tdbb, Request* request, WhichTrigger
 				else if (!relation->rel_view_rse)
 				{
 					VIO_store(tdbb, rpb, transaction);
-					IDX_store(tdbb, rpb, transaction);
+
+					// Triggers may look for the stored records, don't defer their keys
+					IDX_store(tdbb, rpb, transaction,
+						(relation->rel_pre_store || relation->rel_post_store) ?
+							nullptr : request->req_bulk_keys);
+
 					REPL_store(tdbb, rpb, transaction);
 				}
 
@@ -178,6 +178,12 @@ enum db_info_types
 
 	fb_info_parallel_workers = 149,
 
+	// Network traffic of the connection as seen by the server
+	fb_info_wire_snd_bytes = 150,
+	fb_info_wire_rcv_bytes = 151,
+	fb_info_wire_snd_raw_bytes = 152,
+	fb_info_wire_rcv_raw_bytes = 153,
+
 	isc_info_db_last_value   /* Leave this LAST! */
 };
 
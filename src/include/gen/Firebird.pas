@@ -4506,6 +4506,10 @@ const
 	fb_info_username = byte(147);
 	fb_info_sqlrole = byte(148);
 	fb_info_parallel_workers = byte(149);
+	fb_info_wire_snd_bytes = byte(150);
+	fb_info_wire_rcv_bytes = byte(151);
+	fb_info_wire_snd_raw_bytes = byte(152);
+	fb_info_wire_rcv_raw_bytes = byte(153);
 	fb_info_crypt_encrypted = $01;
 	fb_info_crypt_process = $02;
 	fb_feature_multi_statements = byte(1);
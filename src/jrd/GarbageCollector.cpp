@@ -33,6 +33,7 @@ namespace Jrd {
 void GarbageCollector::RelationData::clear()
 {
 	m_pages.clear();
+	m_count = 0;
 }
 
 
@@ -58,13 +59,15 @@ TraNumber GarbageCollector::RelationData::addPage(const ULONG pageno, const TraN
 		return findTran;
 
 	m_pages.add(PageTran(pageno, tranid));
+	m_count++;
 	return tranid;
 }
 
 
-void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, PageBitmap** bm)
+ULONG GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, PageBitmap** bm)
 {
 	PageTranMap::Accessor pages(&m_pages);
+	ULONG count = 0;
 
 	bool next = pages.getFirst();
 	while (next)
@@ -76,10 +79,14 @@ void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, Page
 				PBM_SET(&m_pool, bm, pages.current().pageno);
 			}
 			next = pages.fastRemove();
+			count++;
 		}
 		else
 			next = pages.getNext();
 	}
+
+	m_count -= count;
+	return count;
 }
 
 
@@ -121,7 +128,7 @@ TraNumber GarbageCollector::addPage(const USHORT relID, const ULONG pageno, cons
 }
 
 
-PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &relID)
+PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &relID, ULONG& pageCount)
 {
 	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getPages");
 
@@ -141,10 +148,12 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::getPages");
 
 		PageBitmap* bm = NULL;
-		relData->swept(oldest_snapshot, &bm);
+		const ULONG count = relData->swept(oldest_snapshot, &bm);
 
 		if (bm)
 		{
+			m_queuedPages += count;
+			pageCount = count;
 			relID = relData->getRelID();
 			m_nextRelID = relID + 1;
 			return bm;
@@ -156,6 +165,19 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 }
 
 
+FB_UINT64 GarbageCollector::getBacklog()
+{
+	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getBacklog");
+
+	// Per-relation counters are read without locking, exact precision is not required here
+	FB_UINT64 count = m_queuedPages;
+	for (const auto relData : m_relations)
+		count += relData->getCount();
+
+	return count;
+}
+
+
 void GarbageCollector::removeRelation(const USHORT relID)
 {
 	Sync syncGC(&m_sync, "GarbageCollector::removeRelation");
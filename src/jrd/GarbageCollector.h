@@ -24,6 +24,7 @@
 #define JRD_GARBAGE_COLLECTOR_H
 
 #include "firebird.h"
+#include <atomic>
 #include "../common/classes/array.h"
 #include "../common/classes/GenericMap.h"
 #include "../common/classes/SyncObject.h"
@@ -39,16 +40,38 @@ class GarbageCollector
 {
 public:
 	GarbageCollector(MemoryPool& p, Database* dbb)
-	  : m_pool(p), m_relations(m_pool), m_nextRelID(0)
+	  : m_pool(p), m_relations(m_pool), m_nextRelID(0),
+		m_queuedPages(0), m_processedPages(0)
 	{}
 
 	~GarbageCollector();
 
 	TraNumber addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid);
-	PageBitmap* getPages(const TraNumber oldest_snapshot, USHORT &relID);
+	PageBitmap* getPages(const TraNumber oldest_snapshot, USHORT &relID, ULONG& pageCount);
 	void removeRelation(const USHORT relID);
 	void sweptRelation(const TraNumber oldest_snapshot, const USHORT relID);
 
+	// Number of data pages waiting for garbage collection, including
+	// pages returned by getPages() but not processed yet
+	FB_UINT64 getBacklog();
+
+	FB_UINT64 getProcessed() const
+	{
+		return m_processedPages;
+	}
+
+	// Account pages returned by getPages() as either processed or skipped
+	void pageProcessed()
+	{
+		--m_queuedPages;
+		++m_processedPages;
+	}
+
+	void pagesSkipped(const ULONG count)
+	{
+		m_queuedPages -= count;
+	}
+
 private:
 	struct PageTran
 	{
@@ -77,7 +100,7 @@ private:
 	{
 	public:
 		explicit RelationData(MemoryPool& p, USHORT relID)
-			: m_pool(p), m_pages(p), m_relID(relID)
+			: m_pool(p), m_pages(p), m_relID(relID), m_count(0)
 		{}
 
 		~RelationData()
@@ -87,13 +110,18 @@ private:
 
 		TraNumber addPage(const ULONG pageno, const TraNumber tranid);
 		TraNumber findPage(const ULONG pageno, const TraNumber tranid);
-		void swept(const TraNumber oldest_snapshot, PageBitmap** bm = NULL);
+		ULONG swept(const TraNumber oldest_snapshot, PageBitmap** bm = NULL);
 
 		USHORT getRelID() const
 		{
 			return m_relID;
 		}
 
+		ULONG getCount() const
+		{
+			return m_count;
+		}
+
 		static inline const USHORT generate(const RelationData* item)
 		{
 			return item->m_relID;
@@ -105,6 +133,7 @@ private:
 		Firebird::SyncObject m_sync;
 		PageTranMap m_pages;
 		USHORT m_relID;
+		ULONG m_count;
 	};
 
 	typedef	Firebird::SortedArray<
@@ -119,6 +148,8 @@ private:
 	Firebird::SyncObject m_sync;
 	RelGarbageArray m_relations;
 	USHORT m_nextRelID;
+	std::atomic<FB_UINT64> m_queuedPages;
+	std::atomic<FB_UINT64> m_processedPages;
 };
 
 } // namespace Jrd
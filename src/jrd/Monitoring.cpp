@@ -42,11 +42,14 @@
 #include "../jrd/pag_proto.h"
 #include "../jrd/cvt_proto.h"
 #include "../jrd/CryptoManager.h"
+#include "../jrd/GarbageCollector.h"
 #include "../jrd/Relation.h"
 #include "../jrd/RecordBuffer.h"
 #include "../jrd/Monitoring.h"
 #include "../jrd/Function.h"
 #include "../jrd/optimizer/Optimizer.h"
+#include "../dsql/dsql.h"
+#include "../dsql/DsqlStatementCache.h"
 
 #ifdef WIN_NT
 #include <process.h>
@@ -947,6 +950,32 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 
 	record.storeInteger(f_mon_db_repl_mode, dbb->dbb_replica_mode);
 
+	// page cache memory placement
+	if (dbb->getEncodedOdsVersion() >= ODS_13_3)
+	{
+		string cacheMemory;
+		const ULONG bcbFlags = dbb->dbb_bcb->bcb_flags;
+		if (bcbFlags & BCB_huge_pages)
+			cacheMemory = "HUGE PAGES";
+		if (bcbFlags & (BCB_numa_interleave | BCB_numa_bind))
+		{
+			if (cacheMemory.hasData())
+				cacheMemory += ", ";
+			cacheMemory += (bcbFlags & BCB_numa_interleave) ? "NUMA INTERLEAVE" : "NUMA BIND";
+		}
+		if (cacheMemory.isEmpty())
+			cacheMemory = "DEFAULT";
+		record.storeString(f_mon_db_page_bufs_memory, cacheMemory);
+	}
+
+	// background garbage collection progress
+	const auto gc = dbb->dbb_garbage_collector;
+	if (gc && dbb->getEncodedOdsVersion() >= ODS_13_3)
+	{
+		record.storeInteger(f_mon_db_gc_backlog, gc->getBacklog());
+		record.storeInteger(f_mon_db_gc_processed, gc->getProcessed());
+	}
+
 	// statistics
 	const int stat_id = fb_utils::genUniqueId();
 	record.storeGlobalId(f_mon_db_stat_id, getGlobalId(stat_id));
@@ -1059,6 +1088,13 @@ void Monitoring::putAttachment(SnapshotData::DumpRecord& record, const Jrd::Atta
 
 	record.storeInteger(f_mon_att_par_workers, attachment->att_parallel_workers);
 
+	if (dbb->getEncodedOdsVersion() >= ODS_13_3 && attachment->att_dsql_instance)
+	{
+		const auto cache = attachment->att_dsql_instance->dbb_statement_cache.get();
+		record.storeInteger(f_mon_att_stmt_cache_hits, cache->getHits());
+		record.storeInteger(f_mon_att_stmt_cache_misses, cache->getMisses());
+	}
+
 	record.write();
 
 	if (attachment->att_database->dbb_flags & DBB_shared)
@@ -1242,6 +1278,13 @@ void Monitoring::putRequest(SnapshotData::DumpRecord& record, const Request* req
 	if (dbb->getEncodedOdsVersion() >= ODS_13_1)
 		record.storeInteger(f_mon_stmt_cmp_stmt_id, statement->getStatementId());
 
+	if (dbb->getEncodedOdsVersion() >= ODS_13_3)
+	{
+		record.storeInteger(f_mon_stmt_temp_cache, request->req_temp_cache_usage);
+		record.storeInteger(f_mon_stmt_max_temp_cache, request->req_temp_cache_peak);
+		record.storeInteger(f_mon_stmt_temp_file, request->req_temp_file_usage);
+	}
+
 	record.write();
 
 	putStatistics(record, request->req_stats, stat_id, stat_statement);
@@ -1320,6 +1363,8 @@ void Monitoring::putCall(SnapshotData::DumpRecord& record, const Request* reques
 void Monitoring::putStatistics(SnapshotData::DumpRecord& record, const RuntimeStatistics& statistics,
 							   int stat_id, int stat_group)
 {
+	const auto dbb = JRD_get_thread_data()->getDatabase();
+
 	// statistics id
 	const auto id = getGlobalId(stat_id);
 
@@ -1331,6 +1376,13 @@ void Monitoring::putStatistics(SnapshotData::DumpRecord& record, const RuntimeSt
 	record.storeInteger(f_mon_io_page_writes, statistics.getValue(RuntimeStatistics::PAGE_WRITES));
 	record.storeInteger(f_mon_io_page_fetches, statistics.getValue(RuntimeStatistics::PAGE_FETCHES));
 	record.storeInteger(f_mon_io_page_marks, statistics.getValue(RuntimeStatistics::PAGE_MARKS));
+
+	if (dbb->getEncodedOdsVersion() >= ODS_13_3)
+	{
+		record.storeInteger(f_mon_io_page_hot_hits, statistics.getValue(RuntimeStatistics::PAGE_HOT_HITS));
+		record.storeInteger(f_mon_io_page_cold_hits, statistics.getValue(RuntimeStatistics::PAGE_COLD_HITS));
+	}
+
 	record.write();
 
 	// logical I/O statistics (global)
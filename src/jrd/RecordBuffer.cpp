@@ -49,7 +49,7 @@ offset_t RecordBuffer::store(const Record* new_record)
 	fb_assert(new_record->getLength() == length);
 
 	if (!space)
-		space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH);
+		space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH, true, true);
 
 	space->write(count * length, new_record->getData(), length);
 
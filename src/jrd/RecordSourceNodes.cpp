@@ -1859,12 +1859,33 @@ RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool
 		rse->firstRows = true;
 	}
 
+	// Let the optimizer replace the grouping sort with hashing, unless the parent
+	// relies on the groups order or the user-specified plan is to be followed
+
+	rse->flags &= ~RseNode::FLAG_HASH_GROUPING;
+
+	if (group && !orderedGroups && !rse->rse_aggregate && !rse->rse_plan &&
+		HashAggregatedStream::isSupported(tdbb, csb, group->expressions, map))
+	{
+		rse->flags |= RseNode::FLAG_HASH_GROUPING;
+	}
+
 	RecordSource* const nextRsb = opt->compile(rse, &deliverStack);
 
 	// allocate and optimize the record source block
 
-	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
-		stream, (group ? &group->expressions : NULL), map, nextRsb);
+	RecordSource* rsb;
+
+	if (rse->flags & RseNode::FLAG_HASH_GROUPING)
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) HashAggregatedStream(tdbb, csb,
+			stream, &group->expressions, map, nextRsb);
+	}
+	else
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
+			stream, (group ? &group->expressions : NULL), map, nextRsb);
+	}
 
 	if (rse->rse_aggregate)
 	{
@@ -527,7 +527,8 @@ public:
 		  group(NULL),
 		  map(NULL),
 		  rse(NULL),
-		  dsqlWindow(false)
+		  dsqlWindow(false),
+		  orderedGroups(false)
 	{
 	}
 
@@ -577,6 +578,7 @@ private:
 
 public:
 	bool dsqlWindow;
+	bool orderedGroups;	// parent relies on the groups being returned in the GROUP BY order
 };
 
 class UnionSourceNode final : public TypedNode<RecordSourceNode, RecordSourceNode::TYPE_UNION>
@@ -720,7 +722,8 @@ public:
 		FLAG_DSQL_COMPARATIVE	= 0x10,	// transformed from DSQL ComparativeBoolNode
 		FLAG_LATERAL			= 0x20,	// lateral derived table
 		FLAG_SKIP_LOCKED		= 0x40,	// skip locked
-		FLAG_SUB_QUERY			= 0x80	// sub-query
+		FLAG_SUB_QUERY			= 0x80,	// sub-query
+		FLAG_HASH_GROUPING		= 0x100	// grouping may be evaluated by hashing instead of sorting
 	};
 
 	bool isInvariant() const
@@ -57,6 +57,8 @@ public:
 		PAGE_READS,
 		PAGE_MARKS,
 		PAGE_WRITES,
+		PAGE_HOT_HITS,		// engine internal, reported via MON$IO_STATS only and
+		PAGE_COLD_HITS,		// not a part of the public PerformanceInfo::PageCounters
 		RECORD_FIRST_ITEM,
 		RECORD_SEQ_READS = RECORD_FIRST_ITEM,
 		RECORD_IDX_READS,
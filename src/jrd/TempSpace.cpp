@@ -30,6 +30,9 @@
 #include "../common/isc_proto.h"
 #include "../common/os/path_utils.h"
 #include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/err_proto.h"
+#include "../jrd/sqz.h"
 
 #include "../jrd/TempSpace.h"
 
@@ -41,10 +44,12 @@ using namespace Jrd;
 GlobalPtr<Mutex> TempSpace::initMutex;
 TempDirectoryList* TempSpace::tempDirs = NULL;
 FB_SIZE_T TempSpace::minBlockSize = 0;
+bool TempSpace::compression = false;
 
 namespace
 {
 	const size_t MIN_TEMP_BLOCK_SIZE = 64 * 1024;
+	const FB_SIZE_T TEMP_CHUNK_SIZE = MIN_TEMP_BLOCK_SIZE;
 
 	class TempCacheLimitGuard
 	{
@@ -79,6 +84,16 @@ namespace
 		Database* const m_dbb;
 		FB_SIZE_T m_size;
 	};
+
+	// Temporary space allocated in the request pool is accounted to that request
+
+	Request* getPoolOwner(MemoryPool& pool)
+	{
+		thread_db* const tdbb = JRD_get_thread_data();
+		Request* const request = tdbb ? tdbb->getRequest() : NULL;
+
+		return (request && request->req_pool == &pool) ? request : NULL;
+	}
 }
 
 //
@@ -115,8 +130,33 @@ FB_SIZE_T TempSpace::FileBlock::read(offset_t offset, void* buffer, FB_SIZE_T le
 	{
 		length = size - offset;
 	}
-	offset += seek;
-	return file->read(offset, buffer, length);
+
+	UCHAR* p = static_cast<UCHAR*>(buffer);
+	FB_SIZE_T l = length;
+
+	while (l)
+	{
+		const ULONG chunk = static_cast<ULONG>(offset / TEMP_CHUNK_SIZE);
+		const FB_SIZE_T chunkOffset = static_cast<FB_SIZE_T>(offset % TEMP_CHUNK_SIZE);
+		const FB_SIZE_T n = MIN(l, TEMP_CHUNK_SIZE - chunkOffset);
+
+		// whole chunks are read directly into the caller's buffer, as well as
+		// parts of the chunks stored uncompressed, so that random reads do not
+		// cost the whole chunk each
+
+		if (const auto cached = findChunk(chunk))
+			memcpy(p, getData(cached) + chunkOffset, n);
+		else if (n == TEMP_CHUNK_SIZE)
+			readChunk(chunk, p);
+		else if (!readPart(chunk, chunkOffset, p, n))
+			memcpy(p, getData(getChunk(chunk)) + chunkOffset, n);
+
+		p += n;
+		l -= n;
+		offset += n;
+	}
+
+	return length;
 }
 
 FB_SIZE_T TempSpace::FileBlock::write(offset_t offset, const void* buffer, FB_SIZE_T length)
@@ -125,8 +165,180 @@ FB_SIZE_T TempSpace::FileBlock::write(offset_t offset, const void* buffer, FB_SI
 	{
 		length = size - offset;
 	}
-	offset += seek;
-	return file->write(offset, buffer, length);
+
+	const UCHAR* p = static_cast<const UCHAR*>(buffer);
+	FB_SIZE_T l = length;
+
+	while (l)
+	{
+		const ULONG chunk = static_cast<ULONG>(offset / TEMP_CHUNK_SIZE);
+		const FB_SIZE_T chunkOffset = static_cast<FB_SIZE_T>(offset % TEMP_CHUNK_SIZE);
+		const FB_SIZE_T n = MIN(l, TEMP_CHUNK_SIZE - chunkOffset);
+
+		// whole chunks are written directly from the caller's buffer,
+		// partial ones are accumulated in the cached chunks
+		if (n == TEMP_CHUNK_SIZE)
+		{
+			if (const auto cached = findChunk(chunk))
+			{
+				cached->chunk = NO_CHUNK;
+				cached->dirty = false;
+			}
+
+			writeChunk(chunk, p);
+		}
+		else
+		{
+			const auto cached = getChunk(chunk);
+			UCHAR* const data = getData(cached) + chunkOffset;
+
+			// chunks left unchanged are not written back
+			if (memcmp(data, p, n))
+			{
+				memcpy(data, p, n);
+				cached->dirty = true;
+			}
+		}
+
+		p += n;
+		l -= n;
+		offset += n;
+	}
+
+	return length;
+}
+
+TempSpace::FileBlock::CachedChunk* TempSpace::FileBlock::findChunk(ULONG chunk)
+{
+	for (auto& cached : cachedChunks)
+	{
+		if (cached.chunk == chunk)
+		{
+			cached.lastUse = ++useCounter;
+			return &cached;
+		}
+	}
+
+	return NULL;
+}
+
+TempSpace::FileBlock::CachedChunk* TempSpace::FileBlock::getChunk(ULONG chunk)
+{
+	if (const auto cached = findChunk(chunk))
+		return cached;
+
+	if (chunkBuffer.isEmpty())
+		chunkBuffer.getBuffer(CACHED_CHUNKS * TEMP_CHUNK_SIZE, false);
+
+	// replace the least recently used chunk
+
+	CachedChunk* victim = cachedChunks;
+
+	for (auto& cached : cachedChunks)
+	{
+		if (cached.lastUse < victim->lastUse)
+			victim = &cached;
+	}
+
+	UCHAR* const data = getData(victim);
+
+	if (victim->dirty)
+	{
+		fb_assert(victim->chunk != NO_CHUNK);
+		writeChunk(victim->chunk, data);
+		victim->dirty = false;
+	}
+
+	victim->chunk = NO_CHUNK;
+	readChunk(chunk, data);
+	victim->chunk = chunk;
+	victim->lastUse = ++useCounter;
+
+	return victim;
+}
+
+UCHAR* TempSpace::FileBlock::getData(const CachedChunk* cached)
+{
+	fb_assert(chunkBuffer.getCount() == CACHED_CHUNKS * TEMP_CHUNK_SIZE);
+	return chunkBuffer.begin() + (cached - cachedChunks) * TEMP_CHUNK_SIZE;
+}
+
+bool TempSpace::FileBlock::readPart(ULONG chunk, FB_SIZE_T offset, UCHAR* buffer, FB_SIZE_T length)
+{
+	const ULONG stored = (chunk < chunkLengths.getCount()) ? chunkLengths[chunk] : 0;
+
+	if (!stored)
+	{
+		// never written
+		memset(buffer, 0, length);
+		return true;
+	}
+
+	if (stored == TEMP_CHUNK_SIZE)
+	{
+		file->read(seek + (offset_t) chunk * TEMP_CHUNK_SIZE + offset, buffer, length);
+		return true;
+	}
+
+	return false;
+}
+
+void TempSpace::FileBlock::readChunk(ULONG chunk, UCHAR* buffer)
+{
+	const ULONG stored = (chunk < chunkLengths.getCount()) ? chunkLengths[chunk] : 0;
+	const ULONG length = stored & ~LZ_CHUNK;
+	const offset_t position = seek + (offset_t) chunk * TEMP_CHUNK_SIZE;
+
+	if (!length)
+	{
+		// never written
+		memset(buffer, 0, TEMP_CHUNK_SIZE);
+	}
+	else if (length == TEMP_CHUNK_SIZE)
+	{
+		file->read(position, buffer, length);
+	}
+	else
+	{
+		UCHAR* const packed = packBuffer.getBuffer(length, false);
+		file->read(position, packed, length);
+
+		if (Compressor::unpack(length, packed, TEMP_CHUNK_SIZE, buffer,
+				(stored & LZ_CHUNK) != 0) != buffer + TEMP_CHUNK_SIZE)
+		{
+			BUGCHECK(179);	// msg 179 decompression overran buffer
+		}
+	}
+}
+
+void TempSpace::FileBlock::writeChunk(ULONG chunk, const UCHAR* buffer)
+{
+	fb_assert(size % TEMP_CHUNK_SIZE == 0);
+
+	if (chunk >= chunkLengths.getCount())
+		chunkLengths.grow(chunk + 1);
+
+	const offset_t position = seek + (offset_t) chunk * TEMP_CHUNK_SIZE;
+
+	if (compression)
+	{
+		const Compressor dcc(pool, true, true, true, TEMP_CHUNK_SIZE, buffer);
+
+		if (dcc.isPacked())
+		{
+			const ULONG length = dcc.getPackedLength();
+			fb_assert(length < TEMP_CHUNK_SIZE);
+
+			UCHAR* const packed = packBuffer.getBuffer(length, false);
+			dcc.pack(buffer, packed);
+			file->write(position, packed, length);
+			chunkLengths[chunk] = dcc.hasReferences() ? (length | LZ_CHUNK) : length;
+			return;
+		}
+	}
+
+	file->write(position, buffer, TEMP_CHUNK_SIZE);
+	chunkLengths[chunk] = TEMP_CHUNK_SIZE;
 }
 
 //
@@ -135,11 +347,11 @@ FB_SIZE_T TempSpace::FileBlock::write(offset_t offset, const void* buffer, FB_SI
 // Constructor
 //
 
-TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic)
-		: pool(p), filePrefix(p, prefix),
+TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic, bool aRandomAccess)
+		: pool(p), dbb(GET_DBB()), owner(getPoolOwner(p)), filePrefix(p, prefix),
 		  logicalSize(0), physicalSize(0), localCacheUsage(0),
 		  head(NULL), tail(NULL), tempFiles(p),
-		  initialBuffer(p), initiallyDynamic(dynamic),
+		  initialBuffer(p), initiallyDynamic(dynamic), randomAccess(aRandomAccess),
 		  freeSegments(p)
 {
 	if (!tempDirs)
@@ -150,11 +362,17 @@ TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic)
 			MemoryPool& def_pool = *getDefaultMemoryPool();
 			tempDirs = FB_NEW_POOL(def_pool) TempDirectoryList(def_pool);
 			minBlockSize = Config::getTempBlockSize();
+			compression = Config::getTempCompression();
+
+			// File blocks are read and written by whole chunks,
+			// so every block must consist of whole chunks only
 
 			if (minBlockSize < MIN_TEMP_BLOCK_SIZE)
 				minBlockSize = MIN_TEMP_BLOCK_SIZE;
 			else
-				minBlockSize = FB_ALIGN(minBlockSize, MIN_TEMP_BLOCK_SIZE);
+				minBlockSize = FB_ALIGN(minBlockSize, TEMP_CHUNK_SIZE);
+
+			fb_assert(minBlockSize % TEMP_CHUNK_SIZE == 0);
 		}
 	}
 }
@@ -175,13 +393,20 @@ TempSpace::~TempSpace()
 	}
 
 	if (localCacheUsage)
-	{
-		Database* const dbb = GET_DBB();
 		dbb->decTempCacheUsage(localCacheUsage);
-	}
+
+	if (owner)
+		owner->req_temp_cache_usage -= localCacheUsage;
 
 	while (tempFiles.getCount())
-		delete tempFiles.pop();
+	{
+		TempFile* const file = tempFiles.pop();
+
+		if (owner)
+			owner->req_temp_file_usage -= file->getSize();
+
+		delete file;
+	}
 }
 
 //
@@ -315,9 +540,9 @@ void TempSpace::extend(FB_SIZE_T size)
 		Block* block = NULL;
 
 		{	// scope
-			TempCacheLimitGuard guard(GET_DBB());
+			TempCacheLimitGuard guard(dbb);
 
-			if (guard.reserve(size))
+			if (checkOwnerLimit(size) && guard.reserve(size))
 			{
 				try
 				{
@@ -325,6 +550,16 @@ void TempSpace::extend(FB_SIZE_T size)
 					block = FB_NEW_POOL(pool) MemoryBlock(FB_NEW_POOL(pool) UCHAR[size], tail, size);
 					localCacheUsage += size;
 					guard.commit();
+
+					if (owner)
+					{
+						// Parallel sort workers may extend their spaces concurrently
+						const FB_UINT64 usage = owner->req_temp_cache_usage += size;
+						FB_UINT64 peak = owner->req_temp_cache_peak;
+
+						while (peak < usage && !owner->req_temp_cache_peak.compare_exchange_weak(peak, usage))
+							; // no-op
+					}
 				}
 				catch (const BadAlloc&)
 				{
@@ -341,13 +576,16 @@ void TempSpace::extend(FB_SIZE_T size)
 			// allocate block in the temp file
 			TempFile* const file = setupFile(size);
 			fb_assert(file);
+
+			if (owner)
+				owner->req_temp_file_usage += size;
 			if (tail && tail->sameFile(file))
 			{
 				fb_assert(!initialSize);
 				tail->size += size;
 				return;
 			}
-			block = FB_NEW_POOL(pool) FileBlock(file, tail, size);
+			block = FB_NEW_POOL(pool) FileBlock(pool, file, tail, size, compression && !randomAccess);
 		}
 
 		// preserve the initial contents, if any
@@ -406,6 +644,21 @@ TempSpace::Block* TempSpace::findBlock(offset_t& offset) const
 	return block;
 }
 
+//
+// TempSpace::checkOwnerLimit
+//
+// Checks whether the owner request may cache yet another block in memory
+//
+
+bool TempSpace::checkOwnerLimit(FB_SIZE_T size) const
+{
+	if (!owner)
+		return true;
+
+	const FB_UINT64 limit = dbb->dbb_config->getStatementTempCacheLimit();
+	return !limit || owner->req_temp_cache_usage + size <= limit;
+}
+
 //
 // TempSpace::setupFile
 //
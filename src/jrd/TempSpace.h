@@ -31,10 +31,17 @@
 #include "../common/classes/init.h"
 #include "../common/classes/tree.h"
 
+namespace Jrd
+{
+	class Database;
+	class Request;
+}
+
 class TempSpace : public Firebird::File
 {
 public:
-	TempSpace(MemoryPool& pool, const Firebird::PathName& prefix, bool dynamic = true);
+	TempSpace(MemoryPool& pool, const Firebird::PathName& prefix, bool dynamic = true,
+			  bool randomAccess = false);
 	virtual ~TempSpace();
 
 	FB_SIZE_T read(offset_t offset, void* buffer, FB_SIZE_T length);
@@ -140,11 +147,16 @@ private:
 		}
 	};
 
+public:
+	// File data is accessed in chunks, so that small reads and writes are coalesced
+	// in memory. Chunks may also be compressed, then only their packed length is
+	// transferred to the file, the file layout stays the same.
 	class FileBlock : public Block
 	{
 	public:
-		FileBlock(Firebird::TempFile* f, Block* tail, size_t length)
-			: Block(tail, length), file(f)
+		FileBlock(MemoryPool& p, Firebird::File* f, Block* tail, size_t length, bool compressed)
+			: Block(tail, length), pool(p), file(f), compression(compressed),
+			  chunkBuffer(p), packBuffer(p), chunkLengths(p)
 		{
 			fb_assert(file);
 
@@ -169,12 +181,40 @@ private:
 		}
 
 	private:
-		Firebird::TempFile* file;
+		static const ULONG NO_CHUNK = MAX_ULONG;
+		static const ULONG LZ_CHUNK = 0x80000000;	// chunk length flag, the chunk is LZ-style encoded
+		static const unsigned CACHED_CHUNKS = 4;
+
+		struct CachedChunk
+		{
+			ULONG chunk = NO_CHUNK;
+			FB_UINT64 lastUse = 0;
+			bool dirty = false;
+		};
+
+		CachedChunk* findChunk(ULONG chunk);
+		CachedChunk* getChunk(ULONG chunk);
+		UCHAR* getData(const CachedChunk* cached);
+		void readChunk(ULONG chunk, UCHAR* buffer);
+		bool readPart(ULONG chunk, FB_SIZE_T offset, UCHAR* buffer, FB_SIZE_T length);
+		void writeChunk(ULONG chunk, const UCHAR* buffer);
+
+		MemoryPool& pool;
+		Firebird::File* file;
 		offset_t seek;
+		bool compression;
+
+		Firebird::Array<UCHAR> chunkBuffer;		// cached chunks contents
+		Firebird::Array<UCHAR> packBuffer;		// compressed chunk image
+		Firebird::Array<ULONG> chunkLengths;	// stored length (and flags) of every chunk, zero if never written
+		CachedChunk cachedChunks[CACHED_CHUNKS];	// LRU cache of the partially accessed chunks
+		FB_UINT64 useCounter = 0;
 	};
 
+private:
 	Block* findBlock(offset_t& offset) const;
 	Firebird::TempFile* setupFile(FB_SIZE_T size);
+	bool checkOwnerLimit(FB_SIZE_T size) const;
 
 	UCHAR* findMemory(offset_t& begin, offset_t end, size_t size) const;
 
@@ -199,6 +239,8 @@ private:
 	};
 
 	MemoryPool& pool;
+	Jrd::Database* const dbb;		// database which temp cache usage is accounted
+	Jrd::Request* const owner;		// request which memory and disk usage is accounted
 	Firebird::PathName filePrefix;
 	offset_t logicalSize;
 	offset_t physicalSize;
@@ -208,6 +250,7 @@ private:
 	Firebird::Array<Firebird::TempFile*> tempFiles;
 	Firebird::Array<UCHAR> initialBuffer;
 	bool initiallyDynamic;
+	bool randomAccess;				// data is read back in random order, don't compress it
 
 	typedef Firebird::BePlusTree<Segment, offset_t, MemoryPool, Segment> FreeSegmentTree;
 	FreeSegmentTree freeSegments;
@@ -215,6 +258,7 @@ private:
 	static Firebird::GlobalPtr<Firebird::Mutex> initMutex;
 	static Firebird::TempDirectoryList* tempDirs;
 	static FB_SIZE_T minBlockSize;
+	static bool compression;
 };
 
 #endif // JRD_TEMP_SPACE_H
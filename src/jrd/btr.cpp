@@ -32,6 +32,7 @@
 #include "../common/TimeZoneUtil.h"
 #include "../common/classes/vector.h"
 #include "../common/classes/VaryStr.h"
+#include "../common/classes/ClumpletWriter.h"
 #include <stdio.h>
 #include "../jrd/jrd.h"
 #include "../jrd/ods.h"
@@ -219,6 +220,7 @@ static INT64_KEY make_int64_key(SINT64, SSHORT);
 static void print_int64_key(SINT64, SSHORT, INT64_KEY);
 #endif
 static string print_key(thread_db*, jrd_rel*, index_desc*, Record*);
+static void read_ahead_sibling(thread_db*, const WIN*, const btree_page*);
 static contents remove_node(thread_db*, index_insertion*, WIN*);
 static contents remove_leaf_node(thread_db*, index_insertion*, WIN*);
 static bool scan(thread_db*, UCHAR*, RecordBitmap**, RecordBitmap*, index_desc*,
@@ -702,6 +704,107 @@ idx_e IndexKey::compose(Record* record)
 }
 
 
+// BulkIndexKeys class
+
+void BulkIndexKeys::add(jrd_rel* relation, USHORT indexId, const temporary_key* key,
+	RecordNumber number)
+{
+	fb_assert(!key->key_next);
+
+	Entry entry;
+	entry.relation = relation;
+	entry.number = number.getValue();
+	entry.offset = m_keys.getCount();
+	entry.length = key->key_length;
+	entry.nulls = key->key_nulls;
+	entry.indexId = indexId;
+	entry.flags = key->key_flags;
+
+	m_keys.add(key->key_data, key->key_length);
+	m_entries.add(entry);
+}
+
+void BulkIndexKeys::flush(thread_db* tdbb, jrd_tra* transaction)
+{
+	if (m_entries.isEmpty())
+		return;
+
+	// Order the keys the same way they are placed in the b-tree:
+	// by key value and then by record number
+
+	const UCHAR* const keys = m_keys.begin();
+
+	std::sort(m_entries.begin(), m_entries.end(),
+		[keys](const Entry& e1, const Entry& e2)
+		{
+			if (e1.relation->rel_id != e2.relation->rel_id)
+				return e1.relation->rel_id < e2.relation->rel_id;
+
+			if (e1.indexId != e2.indexId)
+				return e1.indexId < e2.indexId;
+
+			const int cmp = memcmp(keys + e1.offset, keys + e2.offset, MIN(e1.length, e2.length));
+			if (cmp)
+				return cmp < 0;
+
+			if (e1.length != e2.length)
+				return e1.length < e2.length;
+
+			return e1.number < e2.number;
+		});
+
+	index_desc idx;
+	temporary_key key;
+
+	index_insertion insertion;
+	insertion.iib_descriptor = &idx;
+	insertion.iib_transaction = transaction;
+	insertion.iib_key = &key;
+
+	const Entry* group = nullptr;
+	bool found = false;
+
+	for (const auto& entry : m_entries)
+	{
+		jrd_rel* const relation = entry.relation;
+		RelationPages* const relPages = relation->getPages(tdbb);
+
+		if (!group || group->relation != relation || group->indexId != entry.indexId)
+		{
+			group = &entry;
+			found = BTR_lookup(tdbb, relation, entry.indexId, &idx, relPages);
+		}
+
+		if (!found)
+			continue;
+
+		key.key_length = entry.length;
+		key.key_nulls = entry.nulls;
+		key.key_flags = entry.flags;
+		memcpy(key.key_data, keys + entry.offset, entry.length);
+
+		insertion.iib_relation = relation;
+		insertion.iib_number = RecordNumber(entry.number);
+		insertion.iib_duplicates = NULL;
+		insertion.iib_btr_level = 0;
+
+		// The top of the index may have moved after a split, re-read it
+
+		WIN window(relPages->rel_pg_space_id, -1);
+		const index_root_page* const root = fetch_root(tdbb, &window, relation, relPages);
+		if (!root)
+			continue;
+
+		idx.idx_root = root->irt_rpt[entry.indexId].getRoot();
+
+		BTR_insert(tdbb, &window, &insertion);
+	}
+
+	m_entries.clear();
+	m_keys.clear();
+}
+
+
 // IndexScanListIterator class
 
 IndexScanListIterator::IndexScanListIterator(thread_db* tdbb, const IndexRetrieval* retrieval)
@@ -798,6 +901,333 @@ void IndexScanListIterator::makeKeys(thread_db* tdbb, temporary_key* lower, temp
 }
 
 
+// IndexHistogram class
+
+namespace
+{
+	const UCHAR HISTOGRAM_VERSION = 1;
+
+	// Clumplet tags of the stored histogram
+	const UCHAR hst_keys = 1;
+	const UCHAR hst_values = 2;
+	const UCHAR hst_nulls = 3;
+	const UCHAR hst_step = 4;
+	const UCHAR hst_boundary = 5;
+	const UCHAR hst_frequent_count = 6;
+	const UCHAR hst_frequent_key = 7;
+}
+
+void IndexHistogram::Key::assign(const UCHAR* keyData, USHORT keyLength)
+{
+	length = MIN(keyLength, MAX_KEY_LENGTH);
+	memcpy(data, keyData, length);
+}
+
+int IndexHistogram::Key::compare(const temporary_key* key) const
+{
+	const int result = memcmp(data, key->key_data, MIN(length, key->key_length));
+
+	if (result)
+		return result;
+
+	// Keys which are longer than the stored (truncated) one are indistinguishable
+	if (length == MAX_KEY_LENGTH && key->key_length > MAX_KEY_LENGTH)
+		return 0;
+
+	return (int) length - (int) key->key_length;
+}
+
+void IndexHistogram::clear()
+{
+	keyCount = valueCount = nullCount = 0;
+	step = 1;
+	boundaries.clear();
+	frequent.clear();
+	runCount = 0;
+}
+
+void IndexHistogram::add(const UCHAR* keyData, USHORT keyLength, bool newValue)
+{
+	// Keys are expected to come in the index order, so the duplicates of
+	// the leading value are adjacent and every boundary is not less than
+	// the preceding one
+
+	++keyCount;
+
+	if (!keyLength)
+		++nullCount;
+
+	if (newValue || !runCount)
+	{
+		addFrequent();
+		runKey.assign(keyData, keyLength);
+		runCount = 0;
+		++valueCount;
+	}
+
+	++runCount;
+
+	if (keyCount % step == 0)
+	{
+		Key boundary;
+		boundary.assign(keyData, keyLength);
+		boundaries.add(boundary);
+
+		// Too many buckets, merge them pairwise
+
+		if (boundaries.getCount() == 2 * MAX_BOUNDARIES)
+		{
+			for (unsigned i = 0; i < MAX_BOUNDARIES; i++)
+				boundaries[i] = boundaries[2 * i + 1];
+
+			boundaries.shrink(MAX_BOUNDARIES);
+			step *= 2;
+		}
+	}
+}
+
+void IndexHistogram::addFrequent()
+{
+	if (!runCount || !runKey.length)
+		return;
+
+	if (frequent.getCount() < MAX_FREQUENT)
+	{
+		Frequent item;
+		item.key = runKey;
+		item.count = runCount;
+		frequent.add(item);
+		return;
+	}
+
+	FB_SIZE_T rarest = 0;
+
+	for (FB_SIZE_T i = 1; i < frequent.getCount(); i++)
+	{
+		if (frequent[i].count < frequent[rarest].count)
+			rarest = i;
+	}
+
+	if (runCount > frequent[rarest].count)
+	{
+		frequent[rarest].key = runKey;
+		frequent[rarest].count = runCount;
+	}
+}
+
+void IndexHistogram::finish()
+{
+	addFrequent();
+	runCount = 0;
+
+	// Values which are not more common than the average one
+	// don't tell anything the plain selectivity doesn't
+
+	const FB_UINT64 values = valueCount - (nullCount ? 1 : 0);
+
+	if (!values)
+	{
+		frequent.clear();
+		return;
+	}
+
+	const double average = (double) (keyCount - nullCount) / values;
+
+	for (FB_SIZE_T i = frequent.getCount(); i--;)
+	{
+		if (frequent[i].count <= average)
+			frequent.remove(i);
+	}
+}
+
+double IndexHistogram::getEqualSelectivity(const temporary_key* key) const
+{
+/**************************************
+ *
+ * Functional description
+ *	Estimate the fraction of keys equal to the given one.
+ *	Zero is returned if nothing is known about the value.
+ *
+ **************************************/
+	if (isEmpty() || !key->key_length)
+		return 0;
+
+	for (const auto& item : frequent)
+	{
+		if (!item.key.compare(key))
+			return (double) item.count / keyCount;
+	}
+
+	// Assume the uniform distribution of the remaining values
+
+	FB_UINT64 restKeys = keyCount - nullCount;
+	FB_UINT64 restValues = valueCount - (nullCount ? 1 : 0);
+
+	for (const auto& item : frequent)
+	{
+		restKeys -= MIN(item.count, restKeys);
+
+		if (restValues)
+			--restValues;
+	}
+
+	if (!restKeys || !restValues)
+		return 1.0 / keyCount;
+
+	return (double) restKeys / restValues / keyCount;
+}
+
+double IndexHistogram::getPosition(const temporary_key* key) const
+{
+/**************************************
+ *
+ * Functional description
+ *	Estimate the number of keys less than the given one.
+ *
+ **************************************/
+
+	// Find the first bucket whose last key is not less than the given one
+
+	FB_SIZE_T low = 0, high = boundaries.getCount();
+
+	while (low < high)
+	{
+		const FB_SIZE_T middle = (low + high) / 2;
+
+		if (boundaries[middle].compare(key) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	const double first = (double) (low * step);
+	const double last = (low < boundaries.getCount()) ? (double) ((low + 1) * step) : (double) keyCount;
+
+	return (first + last) / 2;
+}
+
+double IndexHistogram::getRangeSelectivity(const temporary_key* lower,
+										   const temporary_key* upper) const
+{
+/**************************************
+ *
+ * Functional description
+ *	Estimate the fraction of keys between the given ones,
+ *	missing bound means the range is open at that side.
+ *	Zero is returned if nothing is known about the keys.
+ *
+ **************************************/
+	if (isEmpty())
+		return 0;
+
+	const double first = lower ? getPosition(lower) : (double) nullCount;
+	double last = (double) keyCount;
+
+	if (upper)
+		last = getPosition(upper) + getEqualSelectivity(upper) * keyCount;
+
+	if (last <= first)
+		return 1.0 / keyCount;
+
+	return MIN((last - first) / keyCount, 1.0);
+}
+
+void IndexHistogram::store(UCharBuffer& buffer) const
+{
+	ClumpletWriter writer(ClumpletReader::WideTagged, MAX_ULONG, HISTOGRAM_VERSION);
+
+	writer.insertBigInt(hst_keys, keyCount);
+	writer.insertBigInt(hst_values, valueCount);
+	writer.insertBigInt(hst_nulls, nullCount);
+	writer.insertBigInt(hst_step, step);
+
+	for (const auto& boundary : boundaries)
+		writer.insertBytes(hst_boundary, boundary.data, boundary.length);
+
+	for (const auto& item : frequent)
+	{
+		writer.insertBigInt(hst_frequent_count, item.count);
+		writer.insertBytes(hst_frequent_key, item.key.data, item.key.length);
+	}
+
+	buffer.assign(writer.getBuffer(), writer.getBufferLength());
+}
+
+bool IndexHistogram::load(const UCHAR* buffer, ULONG length)
+{
+	clear();
+
+	try
+	{
+		ClumpletReader reader(ClumpletReader::WideTagged, buffer, length);
+
+		if (reader.getBufferTag() != HISTOGRAM_VERSION)
+			return false;
+
+		FB_UINT64 count = 0;
+
+		for (reader.rewind(); !reader.isEof(); reader.moveNext())
+		{
+			Key key;
+
+			switch (reader.getClumpTag())
+			{
+				case hst_keys:
+					keyCount = reader.getBigInt();
+					break;
+
+				case hst_values:
+					valueCount = reader.getBigInt();
+					break;
+
+				case hst_nulls:
+					nullCount = reader.getBigInt();
+					break;
+
+				case hst_step:
+					step = reader.getBigInt();
+					break;
+
+				case hst_boundary:
+					key.assign(reader.getBytes(), reader.getClumpLength());
+					boundaries.add(key);
+					break;
+
+				case hst_frequent_count:
+					count = reader.getBigInt();
+					break;
+
+				case hst_frequent_key:
+				{
+					Frequent item;
+					item.key.assign(reader.getBytes(), reader.getClumpLength());
+					item.count = count;
+					frequent.add(item);
+					break;
+				}
+
+				default:
+					// Unknown tags are skipped
+					break;
+			}
+		}
+	}
+	catch (const Exception&)
+	{
+		clear();
+		return false;
+	}
+
+	if (!step || nullCount > keyCount || valueCount > keyCount)
+	{
+		clear();
+		return false;
+	}
+
+	return !isEmpty();
+}
+
+
 void BTR_all(thread_db* tdbb, jrd_rel* relation, IndexDescList& idxList, RelationPages* relPages)
 {
 /**************************************
@@ -1208,6 +1638,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 						skipLowerKey, *lower, forceInclFlag))
 			{
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+				read_ahead_sibling(tdbb, &window, page);
 				pointer = page->btr_nodes + page->btr_jump_size;
 				prefix = 0;
 			}
@@ -1260,6 +1691,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 				}
 
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+				read_ahead_sibling(tdbb, &window, page);
 				endPointer = (UCHAR*) page + page->btr_length;
 				pointer = page->btr_nodes + page->btr_jump_size;
 				pointer = node.readNode(pointer, true);
@@ -2009,6 +2441,80 @@ idx_e BTR_make_key(thread_db* tdbb,
 }
 
 
+bool BTR_make_literal_key(thread_db* tdbb, const index_desc* idx, const dsc* desc,
+						  SSHORT scale, temporary_key* key)
+{
+/**************************************
+ *
+ *	B T R _ m a k e _ l i t e r a l _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Construct the key of the leading index segment for a known value.
+ *	It's used by the optimizer to look up the value in the index
+ *	histogram, so errors are not reported but just make it fail.
+ *
+ **************************************/
+	fb_assert(!(idx->idx_flags & idx_descending));
+
+	const auto dbb = tdbb->getDatabase();
+	const USHORT maxKeyLength = dbb->getMaxIndexKeyLength();
+	const USHORT keyType = (idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT;
+
+	temporary_key temp;
+	temp.key_flags = key_empty;
+	temp.key_length = 0;
+
+	try
+	{
+		compress(tdbb, desc, scale, &temp, idx->idx_rpt[0].idx_itype, false, keyType, nullptr);
+	}
+	catch (const Exception&)
+	{
+		fb_utils::init_status(tdbb->tdbb_status_vector);
+		return false;
+	}
+
+	key->key_flags = 0;
+	key->key_nulls = 0;
+
+	if (idx->idx_count == 1)
+	{
+		key->key_length = temp.key_length;
+		memcpy(key->key_data, temp.key_data, temp.key_length);
+		return true;
+	}
+
+	// Stuff the segment number the same way BTR_make_key does
+
+	UCHAR* p = key->key_data;
+	const UCHAR* q = temp.key_data;
+	SSHORT stuff_count = 0;
+
+	for (USHORT l = temp.key_length; l; --l, --stuff_count)
+	{
+		if (stuff_count == 0)
+		{
+			*p++ = idx->idx_count;
+			stuff_count = STUFF_COUNT;
+		}
+
+		*p++ = *q++;
+
+		if (p - key->key_data >= maxKeyLength)
+			return false;
+	}
+
+	for (; stuff_count; --stuff_count)
+		*p++ = 0;
+
+	key->key_length = p - key->key_data;
+
+	return (key->key_length < maxKeyLength);
+}
+
+
 void BTR_make_null_key(thread_db* tdbb, const index_desc* idx, temporary_key* key)
 {
 /**************************************
@@ -2363,7 +2869,8 @@ void BTR_reserve_slot(thread_db* tdbb, IndexCreation& creation)
 }
 
 
-void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
+void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity,
+					 IndexHistogram* histogram)
 {
 /**************************************
  *
@@ -2377,6 +2884,8 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
  *	without visiting data pages. Thus the
  *	effects of uncommitted transactions
  *	will be included in the calculation.
+ *	If requested, collect the distribution
+ *	of the leading segment values as well.
  *
  **************************************/
 
@@ -2398,6 +2907,15 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 	const bool descending = (root->irt_rpt[id].irt_flags & irt_descending);
 	const ULONG segments = root->irt_rpt[id].irt_keys;
 
+	if (histogram)
+	{
+		histogram->clear();
+
+		// Complemented keys of descending indices are not supported by the histogram
+		if (descending)
+			histogram = nullptr;
+	}
+
 	window.win_flags = WIN_large_scan;
 	window.win_scans = 1;
 	btree_page* bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, page, LCK_read, pag_index);
@@ -2444,6 +2962,7 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 			++nodes;
 			l = node.length + node.prefix;
+			bool leadingDup = false;
 
 			if (segments > 1 && !firstNode)
 			{
@@ -2518,6 +3037,8 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 				for (ULONG i = count + 1; i <= segments; i++)
 					duplicatesList[segments - i]++;
+
+				leadingDup = ((ULONG) count < segments);
 			}
 
 			// figure out if this is a duplicate
@@ -2530,12 +3051,35 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 			if (dup && !firstNode)
 				++duplicates;
 
+			if (segments == 1)
+				leadingDup = (dup && !firstNode);
+
 			if (firstNode)
 				firstNode = false;
 
 			// keep the key value current for comparison with the next key
 			key.key_length = l;
 			memcpy(key.key_data + node.prefix, node.data, node.length);
+
+			if (histogram)
+			{
+				// Leading segment of the compound key lasts while its number
+				// is stuffed before every STUFF_COUNT bytes
+
+				USHORT leadingLength = key.key_length;
+
+				if (segments > 1)
+				{
+					leadingLength = 0;
+
+					while (leadingLength < key.key_length && key.key_data[leadingLength] == segments)
+						leadingLength += STUFF_COUNT + 1;
+
+					leadingLength = MIN(leadingLength, key.key_length);
+				}
+
+				histogram->add(key.key_data, leadingLength, !leadingDup);
+			}
 			pointer = node.readNode(pointer, true);
 		}
 
@@ -2548,6 +3092,9 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 	CCH_RELEASE_TAIL(tdbb, &window);
 
+	if (histogram)
+		histogram->finish();
+
 	// calculate the selectivity
 	selectivity.grow(segments);
 	if (segments > 1)
@@ -6500,6 +7047,25 @@ string print_key(thread_db* tdbb, jrd_rel* relation, index_desc* idx, Record* re
 }
 
 
+static void read_ahead_sibling(thread_db* tdbb, const WIN* window, const btree_page* page)
+{
+/**************************************
+ *
+ *	r e a d _ a h e a d _ s i b l i n g
+ *
+ **************************************
+ *
+ * Functional description
+ *	A range scan has moved to the next leaf page, so it's likely
+ *	to continue to the page after it. Let the OS start reading
+ *	that page while the current one is being processed.
+ *
+ **************************************/
+	if (page->btr_sibling)
+		CCH_read_ahead(tdbb, window->win_page.getPageSpaceID(), &page->btr_sibling, 1);
+}
+
+
 static contents remove_node(thread_db* tdbb, index_insertion* insertion, WIN* window)
 {
 /**************************************
@@ -244,6 +244,67 @@ const int irb_force_upper	= irb_exclude_upper;
 
 typedef Firebird::HalfStaticArray<float, 4> SelectivityList;
 
+// Distribution of the leading index segment. It's collected while walking
+// the leaf level (SET STATISTICS) and kept in RDB$INDICES.RDB$HISTOGRAM.
+// Keys are stored in their binary index form, so the optimizer compares
+// them with the keys made for the literal lookup values.
+
+class IndexHistogram
+{
+public:
+	static const unsigned MAX_BOUNDARIES = 32;	// number of equi-depth buckets is [MAX, 2 * MAX)
+	static const unsigned MAX_FREQUENT = 16;	// size of the most common values list
+	static const USHORT MAX_KEY_LENGTH = 64;	// longer keys are truncated
+
+	struct Key
+	{
+		USHORT length;
+		UCHAR data[MAX_KEY_LENGTH];
+
+		void assign(const UCHAR* keyData, USHORT keyLength);
+		int compare(const temporary_key* key) const;
+	};
+
+	struct Frequent
+	{
+		Key key;
+		FB_UINT64 count;
+	};
+
+	explicit IndexHistogram(MemoryPool& pool)
+		: boundaries(pool), frequent(pool)
+	{}
+
+	bool isEmpty() const
+	{
+		return !keyCount;
+	}
+
+	void clear();
+	void add(const UCHAR* keyData, USHORT keyLength, bool newValue);
+	void finish();
+
+	double getEqualSelectivity(const temporary_key* key) const;
+	double getRangeSelectivity(const temporary_key* lower, const temporary_key* upper) const;
+
+	void store(Firebird::UCharBuffer& buffer) const;
+	bool load(const UCHAR* buffer, ULONG length);
+
+	FB_UINT64 keyCount = 0;		// number of keys
+	FB_UINT64 valueCount = 0;	// number of distinct leading values
+	FB_UINT64 nullCount = 0;	// number of keys with empty (NULL) leading value
+	FB_UINT64 step = 1;			// keys per equi-depth bucket
+	Firebird::Array<Key> boundaries;		// last key of every bucket
+	Firebird::Array<Frequent> frequent;		// most common values
+
+private:
+	void addFrequent();
+	double getPosition(const temporary_key* key) const;
+
+	Key runKey;
+	FB_UINT64 runCount = 0;
+};
+
 class BtrPageGCLock : public Lock
 {
 	// This class assumes that the static part of the lock key (Lock::lck_key)
@@ -528,6 +589,58 @@ private:
 	USHORT m_segno = MAX_USHORT;
 };
 
+// Keys of records stored by a bulk insert. Instead of walking the b-tree down
+// to a random leaf for every record, the keys are collected and inserted into
+// the indices in key order, so the same leaf pages are hit one after another.
+
+class BulkIndexKeys
+{
+public:
+	static const ULONG MAX_BUFFER = 16 * 1024 * 1024;	// flush when exceeded
+
+	explicit BulkIndexKeys(MemoryPool& pool)
+		: m_entries(pool), m_keys(pool)
+	{}
+
+	void add(jrd_rel* relation, USHORT indexId, const temporary_key* key, RecordNumber number);
+	void flush(thread_db* tdbb, jrd_tra* transaction);
+
+	FB_SIZE_T getCount() const
+	{
+		return m_entries.getCount();
+	}
+
+	bool isFull() const
+	{
+		return m_keys.getCount() + m_entries.getCount() * sizeof(Entry) >= MAX_BUFFER;
+	}
+
+	// Forget keys of records stored after the given point, they were undone
+	void truncate(FB_SIZE_T count)
+	{
+		if (count < m_entries.getCount())
+		{
+			m_keys.shrink(m_entries[count].offset);
+			m_entries.shrink(count);
+		}
+	}
+
+private:
+	struct Entry
+	{
+		jrd_rel* relation;
+		SINT64 number;
+		ULONG offset;		// key data in m_keys
+		USHORT length;
+		USHORT nulls;
+		USHORT indexId;
+		UCHAR flags;
+	};
+
+	Firebird::Array<Entry> m_entries;
+	Firebird::Array<UCHAR> m_keys;
+};
+
 } //namespace Jrd
 
 #endif // JRD_BTR_H
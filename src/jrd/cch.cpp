@@ -62,6 +62,7 @@
 #include "../common/classes/MsgPrint.h"
 #include "../jrd/CryptoManager.h"
 #include "../common/utils_proto.h"
+#include "../common/os/os_utils.h"
 #include "../jrd/PageToBufferMap.h"
 
 // Use lock-free lists in hash table implementation
@@ -137,10 +138,11 @@ static void check_precedence(thread_db*, WIN*, PageNumber);
 static void clear_precedence(thread_db*, BufferDesc*);
 static void down_grade(thread_db*, BufferDesc*, int high = 0);
 static bool expand_buffers(thread_db*, ULONG);
-static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int);
+static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int, bool useOnce = false);
 static int get_related(BufferDesc*, PagesArray&, int, const ULONG);
 static ULONG get_prec_walk_mark(BufferControl*);
 static LockState lock_buffer(thread_db*, BufferDesc*, const SSHORT, const SCHAR);
+static void memory_advise(Database*, BufferControl*, UCHAR*, size_t);
 static ULONG memory_init(thread_db*, BufferControl*, ULONG);
 static void page_validation_error(thread_db*, win*, SSHORT);
 static void purgePrecedence(BufferControl*, BufferDesc*);
@@ -190,9 +192,39 @@ static inline void removeDirty(BufferControl* bcb, BufferDesc* bdb)
 static void flushDirty(thread_db* tdbb, SLONG transaction_mask, const bool sys_only);
 static void flushAll(thread_db* tdbb, USHORT flush_flag);
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
+static void flushFiles(thread_db* tdbb);
+static bool backgroundFlush(thread_db* tdbb, BufferControl* bcb);
+static bool backgroundSync(thread_db* tdbb);
 
 static void recentlyUsed(BufferDesc* bdb);
 static void requeueRecentlyUsed(BufferControl* bcb);
+static void moveToHot(BufferControl* bcb, BufferDesc* bdb);
+static void moveToCold(BufferControl* bcb, BufferDesc* bdb, bool tail);
+static void removeFromLRU(BufferControl* bcb, BufferDesc* bdb);
+
+static inline void touchBuffer(thread_db* tdbb, BufferDesc* bdb, bool useOnce)
+{
+	// Account the cache hit against the LRU que the buffer belongs to
+	// and, unless told otherwise, make it the most recently used one
+
+	const bool hot = (bdb->bdb_flags & BDB_hot);
+
+	tdbb->bumpStats(hot ? RuntimeStatistics::PAGE_HOT_HITS : RuntimeStatistics::PAGE_COLD_HITS);
+
+	if (useOnce)
+		return;
+
+	// There is no point to requeue a buffer which is still among the most
+	// recently used quarter of the hot que, it can't be preempted soon.
+	// This keeps hits on the working set away from the shared LRU chain.
+
+	const BufferControl* const bcb = bdb->bdb_bcb;
+
+	if (hot && bcb->bcb_lru_clock - bdb->bdb_lru_stamp < bcb->getHotLimit() / 4)
+		return;
+
+	recentlyUsed(bdb);
+}
 
 
 const ULONG MIN_BUFFER_SEGMENT = 65536;
@@ -201,6 +233,17 @@ const ULONG MIN_BUFFER_SEGMENT = 65536;
 
 #define BLOCK(fld_ptr, type, fld) (type*)((SCHAR*) fld_ptr - offsetof(type, fld))
 
+// Background flush of dirty pages by the cache writer, see backgroundFlush()
+
+const ULONG BG_FLUSH_MIN_RATE		= 8;	// pages written per writer cycle
+const ULONG BG_FLUSH_MAX_RATE		= 256;
+const ULONG BG_FLUSH_SCAN_SHARE		= 64;	// whole cache is scanned in that many cycles
+const ULONG BG_FLUSH_DIRTY_PERCENT	= 5;	// desired share of dirty buffers
+const int BG_FLUSH_MAX_DELAY		= 100;	// ms between writer cycles at the minimal rate
+const int BG_FLUSH_MIN_DELAY		= 10;	// ms between writer cycles at the maximal rate
+const int BG_SYNC_DELAY				= 1;	// seconds between checks of unflushed writes
+const int BG_IDLE_DELAY				= 10;	// seconds to wait when nothing is left to do
+
 const int PRE_SEARCH_LIMIT	= 256;
 const int PRE_EXISTS		= -1;
 const int PRE_UNKNOWN		= -2;
@@ -250,6 +293,7 @@ public:
 	BCBHashTable(MemoryPool& pool, ULONG count) :
 		m_pool(pool),
 		m_count(0),
+		m_shift(0),
 		m_chains(nullptr)
 	{
 		resize(count);
@@ -274,11 +318,16 @@ public:
 private:
 	ULONG hash(const PageNumber& pageno) const
 	{
-		return pageno.getPageNum() % m_count;
+		// Multiplicative hashing: cheaper than division and spreads
+		// the same page numbers of different page spaces apart
+
+		const ULONG value = pageno.getPageNum() ^ ((ULONG) pageno.getPageSpaceID() << 24);
+		return (ULONG) ((value * 0x9E3779B1u) >> m_shift);
 	}
 
 	MemoryPool& m_pool;
-	ULONG m_count;
+	ULONG m_count;		// number of chains, power of 2
+	ULONG m_shift;		// 32 - log2(m_count)
 	chain_type* m_chains;
 };
 
@@ -355,8 +404,7 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 		if (bdb->bdb_flags & BDB_lru_chained)
 			requeueRecentlyUsed(bcb);
 
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+		moveToCold(bcb, bdb, true);
 	}
 
 	bdb->release(tdbb, true);
@@ -753,7 +801,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	fb_assert((bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) == 0);
 	fb_assert(bdb->bdb_page == window->win_page);
 
-	bdb->bdb_flags &= BDB_lru_chained;	// yes, clear all except BDB_lru_chained
+	bdb->bdb_flags &= BDB_lru_flags;	// yes, clear all except LRU state
 	bdb->bdb_flags |= (BDB_writer | BDB_faked);
 	bdb->bdb_scan_count = 0;
 
@@ -870,7 +918,8 @@ LockState CCH_fetch_lock(thread_db* tdbb, WIN* window, int lock_type, int wait,
 	// Look for the page in the cache.
 
 	BufferDesc* bdb = get_buffer(tdbb, window->win_page,
-		((lock_type >= LCK_write) ? SYNC_EXCLUSIVE : SYNC_SHARED), wait);
+		((lock_type >= LCK_write) ? SYNC_EXCLUSIVE : SYNC_SHARED), wait,
+		(window->win_flags & (WIN_large_scan | WIN_use_once)));
 
 	if (wait != 1 && bdb == 0)
 		return lsLatchTimeout; // latch timeout
@@ -1103,7 +1152,7 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 	{
 		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
 		requeueRecentlyUsed(bcb);
-		QUE_DELETE(bdb->bdb_in_use);
+		removeFromLRU(bcb, bdb);
 	}
 
 	// remove from hash table and put into empty list
@@ -1271,21 +1320,7 @@ void CCH_flush(thread_db* tdbb, USHORT flush_flag, TraNumber tra_number)
 	}
 
 	if (doFlush)
-	{
-		PIO_flush(tdbb, main_file);
-
-		for (Shadow* shadow = dbb->dbb_shadow; shadow; shadow = shadow->sdw_next)
-			PIO_flush(tdbb, shadow->sdw_file);
-
-		BackupManager* bm = dbb->dbb_backup_manager;
-		if (bm && !bm->isShutDown())
-		{
-			BackupManager::StateReadGuard stateGuard(tdbb);
-			const int backup_state = bm->getState();
-			if (backup_state == Ods::hdr_nbak_stalled || backup_state == Ods::hdr_nbak_merge)
-				bm->flushDifference(tdbb);
-		}
-	}
+		flushFiles(tdbb);
 
 	// take the opportunity when we know there are no pages
 	// in cache to check that the shadow(s) have not been
@@ -1605,6 +1640,7 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
 	QUE_INIT(bcb->bcb_in_use);
+	QUE_INIT(bcb->bcb_cold);
 	QUE_INIT(bcb->bcb_dirty);
 	bcb->bcb_dirty_count = 0;
 	QUE_INIT(bcb->bcb_empty);
@@ -1845,6 +1881,55 @@ void CCH_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 }
 
 
+void CCH_read_ahead(thread_db* tdbb, USHORT pageSpaceID, const ULONG* pages, USHORT count)
+{
+/**************************************
+ *
+ *	C C H _ r e a d _ a h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Hint the I/O layer about pages that are going to be fetched
+ *	soon. Pages that are already in the cache are skipped, the
+ *	rest are handed to the OS in physical order to be read
+ *	asynchronously. The buffer cache itself is not touched.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	if (!count || !dbb->dbb_config->getReadAheadPages())
+		return;
+
+	SortedArray<ULONG, InlineStorage<ULONG, 64> > list(*tdbb->getDefaultPool());
+
+	{	// scope
+#ifndef HASH_USE_CDS_LIST
+		Sync bcbSync(&bcb->bcb_syncObject, "CCH_read_ahead");
+		bcbSync.lock(SYNC_SHARED);
+#endif
+
+		for (USHORT i = 0; i < count; i++)
+		{
+			if (pages[i] && !list.exist(pages[i]) &&
+				!bcb->bcb_hashTable->find(PageNumber(pageSpaceID, pages[i])))
+			{
+				list.add(pages[i]);
+			}
+		}
+	}
+
+	if (list.hasData())
+	{
+		PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(pageSpaceID);
+
+		if (pageSpace && pageSpace->file)
+			PIO_prefetch(tdbb, pageSpace->file, list.begin(), list.getCount());
+	}
+}
+
 #ifdef CACHE_READER
 void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
 {
@@ -2104,7 +2189,7 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 			bdb->bdb_ast_flags &= ~BDB_blocking;
 		}
 
-		// Make buffer the least-recently-used by queueing it to the LRU tail
+		// Make buffer the least-recently-used by queueing it to the cold LRU tail
 
 		if (release_tail)
 		{
@@ -2125,8 +2210,7 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 						requeueRecentlyUsed(bcb);
 					}
 
-					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+					moveToCold(bcb, bdb, true);
 				}
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
@@ -2860,6 +2944,187 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 }
 
 
+// Make writes done so far durable: flush OS cache of database file,
+// shadows and nbackup difference file.
+static void flushFiles(thread_db* tdbb)
+{
+	Database* const dbb = tdbb->getDatabase();
+
+	PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+	PIO_flush(tdbb, pageSpace->file);
+
+	for (Shadow* shadow = dbb->dbb_shadow; shadow; shadow = shadow->sdw_next)
+		PIO_flush(tdbb, shadow->sdw_file);
+
+	BackupManager* bm = dbb->dbb_backup_manager;
+	if (bm && !bm->isShutDown())
+	{
+		BackupManager::StateReadGuard stateGuard(tdbb);
+		const int backup_state = bm->getState();
+		if (backup_state == Ods::hdr_nbak_stalled || backup_state == Ods::hdr_nbak_merge)
+			bm->flushDifference(tdbb);
+	}
+}
+
+
+// Called by the cache writer when it has nothing else to do. Scan next part
+// of the cache and write some of the dirty pages found there, in page number
+// order. The number of pages written per call adapts to the share of dirty
+// buffers: it grows while dirty pages accumulate faster than they are written
+// and decays when the cache is mostly clean. Pages in use are skipped,
+// precedence is respected by write_buffer(). Returns true if dirty pages
+// were seen, so the writer should come back soon.
+static bool backgroundFlush(thread_db* tdbb, BufferControl* bcb)
+{
+	struct FlushCandidate
+	{
+		BufferDesc* bdb;
+		PageNumber page;
+
+		bool operator>(const FlushCandidate& other) const
+		{
+			return page > other.page;
+		}
+	};
+
+	SortedArray<FlushCandidate, InlineStorage<FlushCandidate, BG_FLUSH_MAX_RATE> >
+		candidates(*tdbb->getDefaultPool());
+
+	ULONG scanned = 0, dirty = 0;
+
+	{	// scope
+		Sync bcbSync(&bcb->bcb_syncObject, FB_FUNCTION);
+		bcbSync.lock(SYNC_SHARED);
+
+		const ULONG count = bcb->bcb_count;
+		if (!count)
+			return false;
+
+		const ULONG window = MIN(count, MAX(count / BG_FLUSH_SCAN_SHARE, BG_FLUSH_MAX_RATE));
+
+		if (bcb->bcb_flush_hand >= count)
+			bcb->bcb_flush_hand = 0;
+
+		// Locate the block containing the scan position
+
+		FB_SIZE_T n = 0;
+		ULONG offset = bcb->bcb_flush_hand;
+
+		while (offset >= bcb->bcb_bdbBlocks[n].m_count)
+			offset -= bcb->bcb_bdbBlocks[n++].m_count;
+
+		while (scanned < window)
+		{
+			const BufferControl::BDBBlock& blk = bcb->bcb_bdbBlocks[n];
+			BufferDesc* const bdb = &blk.m_bdbs[offset];
+
+			scanned++;
+
+			if ((bdb->bdb_flags & BDB_db_dirty) && !(bdb->bdb_flags & BDB_marked))
+			{
+				dirty++;
+
+				if (!bdb->bdb_use_count && candidates.getCount() < bcb->bcb_flush_rate)
+				{
+					FlushCandidate item;
+					item.bdb = bdb;
+					item.page = bdb->bdb_page;
+					candidates.add(item);
+				}
+			}
+
+			if (++offset >= blk.m_count)
+			{
+				offset = 0;
+				if (++n >= bcb->bcb_bdbBlocks.getCount())
+					n = 0;
+			}
+		}
+
+		bcb->bcb_flush_hand = (bcb->bcb_flush_hand + scanned) % count;
+	}
+
+	// Adapt the flush rate to the share of dirty buffers seen
+
+	if (dirty * 100 > scanned * BG_FLUSH_DIRTY_PERCENT)
+		bcb->bcb_flush_rate = MIN(bcb->bcb_flush_rate * 2, BG_FLUSH_MAX_RATE);
+	else if (dirty * 200 < scanned * BG_FLUSH_DIRTY_PERCENT)
+		bcb->bcb_flush_rate = MAX(bcb->bcb_flush_rate / 2, BG_FLUSH_MIN_RATE);
+
+	FbStatusVector* const status = tdbb->tdbb_status_vector;
+
+	for (const FlushCandidate* item = candidates.begin(); item < candidates.end(); item++)
+	{
+		BufferDesc* const bdb = item->bdb;
+
+		// Don't wait for the page, it's being used - try next time
+
+		if (bdb->bdb_use_count || !bdb->addRefConditional(tdbb, SYNC_SHARED))
+			continue;
+
+		bool written = true;
+
+		if (bdb->bdb_page == item->page && (bdb->bdb_flags & BDB_db_dirty))
+			written = write_buffer(tdbb, bdb, item->page, true, status, true);
+
+		bdb->release(tdbb, !(bdb->bdb_flags & BDB_dirty));
+
+		if (!written)
+		{
+			iscDbLogStatus(tdbb->getDatabase()->dbb_filename.c_str(), status);
+			fb_utils::init_status(status);
+			break;
+		}
+	}
+
+	return (dirty != 0);
+}
+
+
+// Called by the cache writer when it has nothing else to do. When forced
+// writes are off and MaxUnflushedWrites / MaxUnflushedWriteTime are in effect,
+// flush OS cache after half of the limits is reached. Thus commits rarely have
+// to wait for flush of all writes accumulated since the last one. Returns true
+// if some writes are left unflushed, so the time limit should be checked again.
+static bool backgroundSync(thread_db* tdbb)
+{
+	Database* const dbb = tdbb->getDatabase();
+
+	const int max_unflushed_writes = dbb->dbb_config->getMaxUnflushedWrites();
+	const time_t max_unflushed_write_time = dbb->dbb_config->getMaxUnflushedWriteTime();
+
+	if (max_unflushed_writes < 0 && max_unflushed_write_time < 0)
+		return false;
+
+	PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+	if ((pageSpace->file->fil_flags & FIL_force_write) || (dbb->dbb_flags & DBB_creating))
+		return false;
+
+	{	// scope
+		SyncLockGuard guard(&dbb->dbb_flush_count_mutex, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+		if (!dbb->unflushed_writes)
+			return false;
+
+		const time_t now = time(0);
+
+		const bool max_num = (max_unflushed_writes >= 0) &&
+			(dbb->unflushed_writes >= max_unflushed_writes / 2);
+		const bool max_time = (max_unflushed_write_time >= 0) &&
+			(now - dbb->last_flushed_write > max_unflushed_write_time / 2);
+
+		if (!max_num && !max_time)
+			return (max_unflushed_write_time >= 0);
+
+		dbb->unflushed_writes = 0;
+		dbb->last_flushed_write = now;
+	}
+
+	flushFiles(tdbb);
+	return false;
+}
+
+
 #ifdef CACHE_READER
 void BufferControl::cache_reader(BufferControl* bcb)
 {
@@ -3056,6 +3321,7 @@ void BufferControl::cache_writer(BufferControl* bcb)
 
 			bcb->bcb_flags |= BCB_cache_writer;
 			bcb->bcb_flags &= ~BCB_writer_start;
+			bcb->bcb_flush_rate = BG_FLUSH_MIN_RATE;
 
 			// Notify our creator that we have started
 			bcb->bcb_writer_init.release();
@@ -3111,9 +3377,23 @@ void BufferControl::cache_writer(BufferControl* bcb)
 #endif
 				else
 				{
+					// Nothing urgent - trickle dirty pages to disk in spare time
+					// to avoid bursts of writes when cache is flushed at once.
+					// While dirty pages remain, come back after a short delay
+					// which gets shorter as the flush rate grows.
+					const bool dirty = backgroundFlush(tdbb, bcb);
+					const bool unflushed = backgroundSync(tdbb);
+
 					bcb->bcb_flags &= ~BCB_writer_active;
 					EngineCheckout cout(tdbb, FB_FUNCTION);
-					bcb->bcb_writer_sem.tryEnter(10);
+
+					if (dirty)
+					{
+						const int delay = BG_FLUSH_MAX_DELAY * BG_FLUSH_MIN_RATE / bcb->bcb_flush_rate;
+						bcb->bcb_writer_sem.tryEnter(0, MAX(delay, BG_FLUSH_MIN_DELAY));
+					}
+					else
+						bcb->bcb_writer_sem.tryEnter(unflushed ? BG_SYNC_DELAY : BG_IDLE_DELAY);
 				}
 			}
 		}
@@ -3622,29 +3902,34 @@ static BufferDesc* get_dirty_buffer(thread_db* tdbb)
 	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
 	lruSync.lock(SYNC_SHARED);
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
-	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+	// Buffers are preempted from the cold que first, so look there first
 
-		if (bdb->bdb_flags & BDB_lru_chained)
+	que* const lruQues[] = {&bcb->bcb_cold, &bcb->bcb_in_use};
+
+	for (que* const lru : lruQues)
+	{
+		for (QUE que_inst = lru->que_backward;
+			 que_inst != lru && walk && chained; que_inst = que_inst->que_backward)
 		{
-			if (!--chained)
-				break;
-			continue;
-		}
+			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-		if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
-			continue;
+			if (bdb->bdb_flags & BDB_lru_chained)
+			{
+				--chained;
+				continue;
+			}
 
-		if (bdb->bdb_flags & BDB_db_dirty)
-		{
-			//tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES); shouldn't it be here?
-			return bdb;
-		}
+			if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
+				continue;
 
-		if (!--walk)
-			break;
+			if (bdb->bdb_flags & BDB_db_dirty)
+			{
+				//tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES); shouldn't it be here?
+				return bdb;
+			}
+
+			--walk;
+		}
 	}
 
 	if (!chained)
@@ -3681,46 +3966,55 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 	else
 		lruSync.lock(SYNC_SHARED);
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use;
-		 que_inst = que_inst->que_backward)
-	{
-		bdb = nullptr;
+	// get the oldest buffer as the least recently used -- note
+	// that since there are no empty buffers both queues cannot be empty
 
-		// get the oldest buffer as the least recently used -- note
-		// that since there are no empty buffers this queue cannot be empty
+	if (!QUE_NOT_EMPTY(bcb->bcb_cold) && !QUE_NOT_EMPTY(bcb->bcb_in_use))
+		BUGCHECK(213);	// msg 213 insufficient cache size
 
-		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
-			BUGCHECK(213);	// msg 213 insufficient cache size
+	// Pages referenced just once are preempted first. Hot pages are
+	// preempted only if there is nothing to reuse in the cold que.
 
-		BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
+	que* const lruQues[] = {&bcb->bcb_cold, &bcb->bcb_in_use};
 
-		if (oldest->bdb_flags & BDB_lru_chained)
-			continue;
+	for (que* const lru : lruQues)
+	{
+		for (QUE que_inst = lru->que_backward;
+			 que_inst != lru;
+			 que_inst = que_inst->que_backward)
+		{
+			BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-		if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
-			continue;
+			if (oldest->bdb_flags & BDB_lru_chained)
+				continue;
 
-		/*if (!writeable(oldest))
-		{
-			oldest->release(tdbb, true);
-			continue;
-		}*/
+			if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
+				continue;
 
-		bdb = oldest;
-		if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
-			break;
+			/*if (!writeable(oldest))
+			{
+				oldest->release(tdbb, true);
+				continue;
+			}*/
 
-		if (!(bcb->bcb_flags & BCB_cache_writer))
-			break;
+			bdb = oldest;
+			if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
+				break;
 
-		bcb->bcb_flags |= BCB_free_pending;
-		if (!(bcb->bcb_flags & BCB_writer_active))
-			bcb->bcb_writer_sem.release();
+			if (!(bcb->bcb_flags & BCB_cache_writer))
+				break;
 
-		bdb->release(tdbb, true);
-		bdb = nullptr;
-		--walk;
+			bcb->bcb_flags |= BCB_free_pending;
+			if (!(bcb->bcb_flags & BCB_writer_active))
+				bcb->bcb_writer_sem.release();
+
+			bdb->release(tdbb, true);
+			bdb = nullptr;
+			--walk;
+		}
+
+		if (bdb)
+			break;
 	}
 
 	lruSync.unlock();
@@ -3771,7 +4065,8 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 }
 
 
-static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType syncType, int wait)
+static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType syncType, int wait,
+	bool useOnce)
 {
 /**************************************
  *
@@ -3792,6 +4087,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
  *			0 => If the lock can't be acquired immediately,
  *				give up and return 0;
  *			<negative number> => Latch timeout interval in seconds.
+ *	useOnce:	page is not going to be reused soon, don't move it
+ *				into the hot LRU que.
  *
  * return
  *	BufferDesc pointer if successful.
@@ -3812,7 +4109,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			{
 				if (bdb->bdb_page == page)
 				{
-					recentlyUsed(bdb);
+					touchBuffer(tdbb, bdb, useOnce);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					return bdb;
 				}
@@ -3855,7 +4152,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				// ensure the found page buffer is still for the same page after latch
 				if (bdb->bdb_page == page)
 				{
-					recentlyUsed(bdb);
+					touchBuffer(tdbb, bdb, useOnce);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3895,7 +4192,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				else if (bdb->bdb_page == page)
 				{
 					bdb->downgrade(syncType);
-					recentlyUsed(bdb);
+					touchBuffer(tdbb, bdb, useOnce);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3919,7 +4216,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (!bdb2)
 				{
 					bdb->bdb_page = page;
-					bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
+					bdb->bdb_flags &= BDB_lru_flags; // yes, clear all except LRU state
 					bdb->bdb_flags |= BDB_read_pending;
 					bdb->bdb_scan_count = 0;
 					if (bdb->bdb_lock)
@@ -3929,16 +4226,16 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bcbSync.unlock();
 #endif
 
-					if (!(bdb->bdb_flags & BDB_lru_chained))
+					// Page just read goes to the cold que, it should be
+					// referenced once more to be moved into the hot one
+
+					Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
+					if (!(bdb->bdb_flags & BDB_lru_chained) && syncLRU.lockConditional(SYNC_EXCLUSIVE))
+						moveToCold(bcb, bdb, false);
+					else
 					{
-						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
-						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
-						{
-							QUE_DELETE(bdb->bdb_in_use);
-							QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
-						}
-						else
-							recentlyUsed(bdb);
+						bdb->bdb_flags |= BDB_lru_new;
+						recentlyUsed(bdb);
 					}
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					cacheBuffer(att, bdb);
@@ -3957,7 +4254,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bdb2->release(tdbb, true);
 					continue;
 				}
-				recentlyUsed(bdb2);
+				touchBuffer(tdbb, bdb2, useOnce);
 				tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 				cacheBuffer(att, bdb2);
 			}
@@ -4215,6 +4512,70 @@ static LockState lock_buffer(thread_db* tdbb, BufferDesc* bdb, const SSHORT wait
 }
 
 
+static void memory_advise(Database* dbb, BufferControl* bcb, UCHAR* memory, size_t length)
+{
+/**************************************
+ *
+ *	m e m o r y _ a d v i s e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Ask the OS to place page buffers memory according to
+ *	the DbCacheHugePages and DbCacheNumaPolicy settings.
+ *	The outcome is shown in MON$DATABASE.
+ *
+ **************************************/
+	const Config* const config = dbb->dbb_config;
+
+	if (config->getDbCacheHugePages() && os_utils::adviseHugePages(memory, length))
+		bcb->bcb_flags |= BCB_huge_pages;
+
+	string policy(config->getDbCacheNumaPolicy());
+	policy.alltrim();
+	policy.lower();
+
+	if (policy.isEmpty())
+		return;
+
+	FB_UINT64 nodeMask = 0;
+	const bool interleave = (policy == "interleave");
+
+	if (interleave)
+		nodeMask = MAX_UINT64;
+	else
+	{
+		string node;
+
+		while (node.getWord(policy, ","))
+		{
+			node.alltrim();
+
+			const ULONG number = (ULONG) atol(node.c_str());
+
+			if (node.isEmpty() || node.find_first_not_of("0123456789") != string::npos ||
+				number >= 64)
+			{
+				nodeMask = 0;
+				break;
+			}
+
+			nodeMask |= FB_CONST64(1) << number;
+		}
+
+		if (!nodeMask)
+		{
+			gds__log("Database: %s\n\tInvalid DbCacheNumaPolicy value \"%s\" is ignored",
+				dbb->dbb_filename.c_str(), config->getDbCacheNumaPolicy());
+			return;
+		}
+	}
+
+	if (os_utils::bindMemory(memory, length, nodeMask, interleave))
+		bcb->bcb_flags |= (interleave ? BCB_numa_interleave : BCB_numa_bind);
+}
+
+
 static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 {
 /**************************************
@@ -4299,6 +4660,9 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 			memory = FB_ALIGN(memory, page_size);
 
 			fb_assert(memory_end >= memory + page_size * to_alloc);
+
+			// Page buffers are not touched yet, it's time to give placement hints
+			memory_advise(dbb, bcb, memory, page_size * to_alloc);
 		}
 
 		tail = ::new(tail) BufferDesc(bcb);
@@ -5146,17 +5510,84 @@ void requeueRecentlyUsed(BufferControl* bcb)
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+
+		// Just read page starts in the cold que, any other reference
+		// makes the buffer hot
+
+		if (bdb->bdb_flags & BDB_lru_new)
+			moveToCold(bcb, bdb, false);
+		else
+			moveToHot(bcb, bdb);
 
 		bdb->bdb_lru_chain = NULL;
-		bdb->bdb_flags &= ~BDB_lru_chained;
+		bdb->bdb_flags &= ~(BDB_lru_chained | BDB_lru_new);
 	}
 
 	chain = bcb->bcb_lru_chain;
 }
 
 
+void moveToHot(BufferControl* bcb, BufferDesc* bdb)
+{
+	// Caller must hold bcb_syncLRU exclusively
+
+	QUE_DELETE(bdb->bdb_in_use);
+	QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+	bdb->bdb_lru_stamp = ++bcb->bcb_lru_clock;
+
+	if (!(bdb->bdb_flags & BDB_hot))
+	{
+		bdb->bdb_flags |= BDB_hot;
+		bcb->bcb_hot_count++;
+	}
+
+	// Don't let the hot que to occupy the whole cache, demote
+	// its least recently used buffers into the cold que head
+
+	const ULONG hotLimit = bcb->getHotLimit();
+
+	while (bcb->bcb_hot_count > hotLimit)
+	{
+		BufferDesc* const oldest = BLOCK(bcb->bcb_in_use.que_backward, BufferDesc, bdb_in_use);
+		moveToCold(bcb, oldest, false);
+	}
+}
+
+
+void moveToCold(BufferControl* bcb, BufferDesc* bdb, bool tail)
+{
+	// Caller must hold bcb_syncLRU exclusively
+
+	QUE_DELETE(bdb->bdb_in_use);
+
+	if (tail)
+		QUE_APPEND(bcb->bcb_cold, bdb->bdb_in_use);
+	else
+		QUE_INSERT(bcb->bcb_cold, bdb->bdb_in_use);
+
+	if (bdb->bdb_flags & BDB_hot)
+	{
+		bdb->bdb_flags &= ~BDB_hot;
+		bcb->bcb_hot_count--;
+	}
+}
+
+
+void removeFromLRU(BufferControl* bcb, BufferDesc* bdb)
+{
+	// Caller must hold bcb_syncLRU exclusively
+
+	QUE_DELETE(bdb->bdb_in_use);
+	QUE_INIT(bdb->bdb_in_use);
+
+	if (bdb->bdb_flags & BDB_hot)
+	{
+		bdb->bdb_flags &= ~BDB_hot;
+		bcb->bcb_hot_count--;
+	}
+}
+
+
 BufferControl* BufferControl::create(Database* dbb)
 {
 	MemoryPool* const pool = dbb->createPool();
@@ -5303,8 +5734,17 @@ void BCBHashTable::resize(ULONG count)
 	const ULONG old_count = m_count;
 	chain_type* const old_chains = m_chains;
 
+	// Round number of chains up to the power of 2, see hash()
+
+	ULONG shift = 31;
+	while (shift > 1 && (1u << (32 - shift)) < count)
+		shift--;
+
+	count = 1u << (32 - shift);
+
 	chain_type* new_chains = FB_NEW_POOL(m_pool) chain_type[count];
 	m_count = count;
+	m_shift = shift;
 	m_chains = new_chains;
 
 #ifndef HASH_USE_CDS_LIST
@@ -73,6 +73,11 @@ const ULONG MAX_PAGE_BUFFERS = 131072;
 const ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
+// Share of the page buffers (in percent) that may be held by the hot LRU que.
+// The rest is left for the cold que where newly read pages are placed.
+
+const ULONG HOT_QUEUE_PERCENT = 75;
+
 // BufferControl -- Buffer control block -- one per system
 
 class BufferControl : public pool_alloc<type_bcb>
@@ -86,6 +91,7 @@ class BufferControl : public pool_alloc<type_bcb>
 	{
 		bcb_database = NULL;
 		QUE_INIT(bcb_in_use);
+		QUE_INIT(bcb_cold);
 		QUE_INIT(bcb_pending);
 		QUE_INIT(bcb_empty);
 		QUE_INIT(bcb_dirty);
@@ -95,6 +101,10 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_free_minimum = 0;
 		bcb_count = 0;
 		bcb_inuse = 0;
+		bcb_hot_count = 0;
+		bcb_lru_clock = 0;
+		bcb_flush_hand = 0;
+		bcb_flush_rate = 0;
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
@@ -109,19 +119,26 @@ public:
 	static BufferControl* create(Database* dbb);
 	static void destroy(BufferControl*);
 
+	ULONG getHotLimit() const
+	{
+		return (ULONG) ((FB_UINT64) bcb_count * HOT_QUEUE_PERCENT / 100);
+	}
+
 	Database*	bcb_database;
 
 	Firebird::MemoryPool* bcb_bufferpool;
 	Firebird::MemoryStats bcb_memory_stats;
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
-	que			bcb_in_use;			// Que of buffers in use, main LRU que
+	que			bcb_in_use;			// Que of buffers referenced more than once, hot LRU que
+	que			bcb_cold;			// Que of buffers referenced once, cold LRU que
 	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
 	que			bcb_empty;			// Que of empty buffers
 
-	// Recently used buffer put there without locking common LRU que (bcb_in_use).
-	// When bcb_syncLRU is locked this chain is merged into bcb_in_use. See also
-	// requeueRecentlyUsed() and recentlyUsed()
+	// Recently used buffer put there without locking common LRU ques.
+	// When bcb_syncLRU is locked this chain is merged into bcb_in_use
+	// (or into bcb_cold for just read pages). See also requeueRecentlyUsed()
+	// and recentlyUsed()
 	std::atomic<BufferDesc*>	bcb_lru_chain;
 
 	que			bcb_dirty;			// que of dirty buffers
@@ -132,6 +149,10 @@ public:
 	SSHORT		bcb_free_minimum;	// Threshold to activate cache writer
 	ULONG		bcb_count;			// Number of buffers allocated
 	ULONG		bcb_inuse;			// Number of buffers in use
+	ULONG		bcb_hot_count;		// Number of buffers in hot LRU que
+	ULONG		bcb_lru_clock;		// Number of moves into hot LRU que head
+	ULONG		bcb_flush_hand;		// Next buffer to be checked by cache writer background flush
+	ULONG		bcb_flush_rate;		// Max number of pages written per background flush cycle
 	ULONG		bcb_prec_walk_mark;	// mark value used in precedence graph walk
 	ULONG		bcb_page_size;		// Database page size in bytes
 	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
@@ -184,6 +205,9 @@ const int BCB_reader_active	= 32;	// cache reader not blocked on event
 #endif
 const int BCB_free_pending	= 64;	// request cache writer to free pages
 const int BCB_exclusive		= 128;	// there is only BCB in whole system
+const int BCB_huge_pages	= 256;	// page buffers are advised to use huge pages
+const int BCB_numa_interleave	= 512;	// page buffers are interleaved over NUMA nodes
+const int BCB_numa_bind		= 1024;	// page buffers are bound to NUMA nodes
 
 
 // BufferDesc -- Buffer descriptor block
@@ -213,6 +237,7 @@ public:
 		bdb_scan_count = 0;
 		bdb_difference_page = 0;
 		bdb_prec_walk_mark = 0;
+		bdb_lru_stamp = 0;
 	}
 
 	bool addRef(thread_db* tdbb, Firebird::SyncType syncType, int wait = 1);
@@ -242,7 +267,7 @@ public:
 	Firebird::SyncObject	bdb_syncPage;
 	Lock*		bdb_lock;				// Lock block for buffer
 	que			bdb_que;				// Either mod que in hash table or bcb_empty que if never used
-	que			bdb_in_use;				// queue of buffers in use
+	que			bdb_in_use;				// queue of buffers in use, either hot or cold one
 	que			bdb_dirty;				// dirty pages LRU queue
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
 	Ods::pag*	bdb_buffer;				// Actual buffer
@@ -267,6 +292,7 @@ public:
 	Firebird::AtomicCounter	bdb_scan_count;		// concurrent sequential scans
 	ULONG       bdb_difference_page;			// Number of page in difference file, NBAK
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
+	ULONG		bdb_lru_stamp;					// bcb_lru_clock when moved into hot LRU que head
 };
 
 // bdb_flags
@@ -291,6 +317,10 @@ const int BDB_prefetch			= 0x4000;	// page has been prefetched but not yet refer
 const int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 const int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
 const int BDB_nbak_state_lock	= 0x20000;	// nbak state lock should be released after buffer is written
+const int BDB_hot				= 0x40000;	// buffer is in hot LRU que
+const int BDB_lru_new			= 0x80000;	// buffer is in pending LRU chain after page read, requeue it as cold
+
+const int BDB_lru_flags = BDB_lru_chained | BDB_hot | BDB_lru_new;
 
 // bdb_ast_flags
 
@@ -955,6 +955,7 @@ static void activate_request(thread_db* tdbb, Request* request, jrd_tra* transac
 		rpb.rpb_runtime_flags = 0;
 
 	request->req_profiler_ticks = 0;
+	request->req_temp_cache_peak = request->req_temp_cache_usage.load();
 
 	// Store request start time for timestamp work
 	request->validateTimeStamp();
@@ -77,6 +77,7 @@ static bool cmpRecordKeys(thread_db*, Record*, jrd_rel*, index_desc*, Record*, j
 static bool duplicate_key(const UCHAR*, const UCHAR*, void*);
 static PageNumber get_root_page(thread_db*, jrd_rel*);
 static int index_block_flush(void*);
+static bool canDeferKey(const Request*, const jrd_rel*, const index_desc*);
 static idx_e insert_key(thread_db*, jrd_rel*, Record*, jrd_tra*, WIN *, index_insertion*, IndexErrorContext&);
 static void release_index_block(thread_db*, IndexBlock*);
 static void signal_index_deletion(thread_db*, jrd_rel*, USHORT);
@@ -1485,7 +1486,8 @@ void IDX_modify_flag_uk_modified(thread_db* tdbb,
 }
 
 
-void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
+void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity,
+					IndexHistogram* histogram)
 {
 /**************************************
  *
@@ -1495,17 +1497,17 @@ void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityLi
  *
  * Functional description
  *	Scan index pages recomputing
- *	selectivity.
+ *	selectivity and histogram.
  *
  **************************************/
 
 	SET_TDBB(tdbb);
 
-	BTR_selectivity(tdbb, relation, id, selectivity);
+	BTR_selectivity(tdbb, relation, id, selectivity, histogram);
 }
 
 
-void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
+void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction, BulkIndexKeys* bulkKeys)
 {
 /**************************************
  *
@@ -1517,10 +1519,15 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
  *	Update the various indices after a STORE operation.  If a duplicate
  *	index is violated, return the index number.  If successful, return
  *	-1.
+ *	If bulk keys are passed, keys of the non-unique indices which are
+ *	not used by the current request are collected there to be inserted
+ *	later in key order.
  *
  **************************************/
 	SET_TDBB(tdbb);
 
+	const Request* const request = bulkKeys ? tdbb->getRequest() : nullptr;
+
 	index_desc idx;
 	idx.idx_id = idx_invalid;
 
@@ -1565,6 +1572,12 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 
 		expression.reset();
 
+		if (request && !key->key_next && canDeferKey(request, rpb->rpb_relation, &idx))
+		{
+			bulkKeys->add(rpb->rpb_relation, idx.idx_id, key, rpb->rpb_number);
+			continue;
+		}
+
 		insertion.iib_key = key;
 
 		if ( (error_code = insert_key(tdbb, rpb->rpb_relation, rpb->rpb_record, transaction,
@@ -2072,6 +2085,46 @@ static int index_block_flush(void* ast_object)
 }
 
 
+static bool canDeferKey(const Request* request, const jrd_rel* relation, const index_desc* idx)
+{
+/**************************************
+ *
+ *	c a n D e f e r K e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether insertion of the key may be postponed. Unique and
+ *	foreign keys must be checked immediately. The key also must not be
+ *	looked for by the request itself, otherwise it would miss the
+ *	records stored before.
+ *
+ **************************************/
+	if (idx->idx_flags & (idx_unique | idx_primary | idx_foreign))
+		return false;
+
+	for (const auto& resource : request->getStatement()->resources)
+	{
+		switch (resource.rsc_type)
+		{
+			case Resource::rsc_procedure:
+			case Resource::rsc_function:
+				return false;
+
+			case Resource::rsc_index:
+				if (resource.rsc_rel == relation && resource.rsc_id == idx->idx_id)
+					return false;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return true;
+}
+
+
 static idx_e insert_key(thread_db* tdbb,
 						jrd_rel* relation,
 						Record* record,
@@ -2157,6 +2210,10 @@ static void release_index_block(thread_db* tdbb, IndexBlock* index_block)
 	}
 	index_block->idb_condition = nullptr;
 
+	delete index_block->idb_histogram;
+	index_block->idb_histogram = nullptr;
+	index_block->idb_histogram_selectivity = 0;
+
 	LCK_release(tdbb, index_block->idb_lock);
 }
 
@@ -888,6 +888,10 @@ void INF_database_info(thread_db* tdbb,
 			break;
 
 		case fb_info_protocol_version:
+		case fb_info_wire_snd_bytes:
+		case fb_info_wire_rcv_bytes:
+		case fb_info_wire_snd_raw_bytes:
+		case fb_info_wire_rcv_raw_bytes:
 			length = INF_convert(0, buffer);
 			break;
 
@@ -185,6 +185,8 @@ enum irq_type_t
 	irq_proc_param_dep,		// check procedure parameter dependency
 	irq_func_param_dep,		// check function parameter dependency
 	irq_l_pub_tab_state,	// lookup publication state for a table
+	irq_m_index_hist,		// modify index histogram
+	irq_l_index_hist,		// lookup index histogram
 
 	irq_MAX
 };
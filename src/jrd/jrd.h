@@ -121,6 +121,7 @@ class jrd_rel;
 class ExternalFile;
 class ViewContext;
 class IndexBlock;
+class IndexHistogram;
 class IndexLock;
 class ArrayField;
 struct sort_context;
@@ -307,6 +308,8 @@ public:
 	BoolExprNode* idb_condition;			// node tree for index condition
 	Statement* idb_condition_statement;		// statement for index condition evaluation
 	Lock*		idb_lock;					// lock to synchronize changes to index
+	IndexHistogram* idb_histogram;			// distribution of the leading segment
+	float		idb_histogram_selectivity;	// index selectivity the histogram was loaded for
 	USHORT		idb_id;
 };
 
@@ -365,6 +368,7 @@ const USHORT WIN_large_scan			= 1;	// large sequential scan
 const USHORT WIN_secondary			= 2;	// secondary stream
 const USHORT WIN_garbage_collector	= 4;	// garbage collector's window
 const USHORT WIN_garbage_collect	= 8;	// scan left a page for garbage collector
+const USHORT WIN_use_once			= 16;	// pages are not going to be reused, don't make them hot
 
 
 #ifdef USE_ITIMER
@@ -41,6 +41,7 @@ namespace Jrd
 	class Database;
 	struct bid;
 	struct index_desc;
+	class IndexHistogram;
 	class jrd_fld;
 	class Shadow;
 	class DeferredWork;
@@ -110,6 +111,7 @@ void		MET_lookup_index(Jrd::thread_db*, Jrd::MetaName&, const Jrd::MetaName&, US
 void		MET_lookup_index_condition(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::index_desc*);
 void		MET_lookup_index_expression(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::index_desc*);
 bool		MET_lookup_index_expr_cond_blr(Jrd::thread_db* tdbb, const Jrd::MetaName& index_name, Jrd::bid& expr_blob_id, Jrd::bid& cond_blob_id);
+const Jrd::IndexHistogram*	MET_lookup_index_histogram(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::index_desc*);
 SLONG		MET_lookup_index_name(Jrd::thread_db*, const Jrd::MetaName&, SLONG*, Jrd::IndexStatus* status);
 bool		MET_lookup_partner(Jrd::thread_db*, Jrd::jrd_rel*, struct Jrd::index_desc*, const TEXT*);
 Jrd::jrd_prc*	MET_lookup_procedure(Jrd::thread_db*, const Jrd::QualifiedName&, bool);
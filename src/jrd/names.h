@@ -305,11 +305,14 @@ NAME("MON$EXPLAINED_PLAN", nam_mon_expl_plan)
 NAME("MON$FORCED_WRITES", nam_mon_forced_writes)
 NAME("MON$FRAGMENT_READS", nam_mon_fragment_reads)
 NAME("MON$GARBAGE_COLLECTION", nam_mon_gc)
+NAME("MON$GC_BACKLOG", nam_mon_gc_backlog)
+NAME("MON$GC_PROCESSED", nam_mon_gc_processed)
 NAME("MON$IO_STATS", nam_mon_io_stats)
 NAME("MON$ISOLATION_MODE", nam_mon_iso_mode)
 NAME("MON$LOCK_TIMEOUT", nam_mon_lock_timeout)
 NAME("MON$MAX_MEMORY_USED", nam_mon_max_used)
 NAME("MON$MAX_MEMORY_ALLOCATED", nam_mon_max_alloc)
+NAME("MON$MAX_TEMP_CACHE_USED", nam_mon_max_temp_cache)
 NAME("MON$MEMORY_USAGE", nam_mon_mem_usage)
 NAME("MON$MEMORY_USED", nam_mon_mem_used)
 NAME("MON$MEMORY_ALLOCATED", nam_mon_mem_alloc)
@@ -328,7 +331,10 @@ NAME("MON$OWNER", nam_mon_owner)
 NAME("MON$SEC_DATABASE", nam_mon_secdb)
 NAME("MON$PACKAGE_NAME", nam_mon_pkg_name)
 NAME("MON$PAGE_BUFFERS", nam_mon_page_bufs)
+NAME("MON$PAGE_BUFFERS_MEMORY", nam_mon_page_bufs_memory)
+NAME("MON$PAGE_COLD_HITS", nam_mon_page_cold_hits)
 NAME("MON$PAGE_FETCHES", nam_mon_page_fetches)
+NAME("MON$PAGE_HOT_HITS", nam_mon_page_hot_hits)
 NAME("MON$PAGE_MARKS", nam_mon_page_marks)
 NAME("MON$PAGE_READS", nam_mon_page_reads)
 NAME("MON$PAGE_WRITES", nam_mon_page_writes)
@@ -366,11 +372,15 @@ NAME("MON$STAT_GROUP", nam_mon_stat_group)
 NAME("MON$STAT_ID", nam_mon_stat_id)
 NAME("MON$STATE", nam_mon_state)
 NAME("MON$STATEMENTS", nam_mon_statements)
+NAME("MON$STATEMENT_CACHE_HITS", nam_mon_stmt_cache_hits)
+NAME("MON$STATEMENT_CACHE_MISSES", nam_mon_stmt_cache_misses)
 NAME("MON$STATEMENT_ID", nam_mon_stmt_id)
 NAME("MON$SWEEP_INTERVAL", nam_mon_sweep_int)
 NAME("MON$SYSTEM_FLAG", nam_mon_sys_flag)
 NAME("MON$TABLE_NAME", nam_mon_tab_name)
 NAME("MON$TABLE_STATS", nam_mon_tab_stats)
+NAME("MON$TEMP_CACHE_USED", nam_mon_temp_cache)
+NAME("MON$TEMP_FILE_USED", nam_mon_temp_file)
 NAME("MON$TIMESTAMP", nam_mon_timestamp)
 NAME("MON$TOP_TRANSACTION", nam_mon_top)
 NAME("MON$TRANSACTIONS", nam_mon_transactions)
@@ -473,3 +483,5 @@ NAME("RDB$VARBINARY_MAX", nam_varbinary_max)
 NAME("RDB$INTEGER", nam_integer)
 
 NAME("MON$PARALLEL_WORKERS", nam_par_workers)
+
+NAME("RDB$HISTOGRAM", nam_histogram)
@@ -125,7 +125,8 @@ const USHORT ODS_CURRENT12		= 0;
 const USHORT ODS_CURRENT13_0	= 0;	// Firebird 4.0 features
 const USHORT ODS_CURRENT13_1	= 1;	// Firebird 5.0 features
 const USHORT ODS_CURRENT13_2	= 2;	// Firebird 6.0 features
-const USHORT ODS_CURRENT13		= 2;
+const USHORT ODS_CURRENT13_3	= 3;	// Firebird 6.0 features: index histograms, LZ records, new MON$ fields
+const USHORT ODS_CURRENT13		= 3;
 
 // useful ODS macros. These are currently used to flag the version of the
 // system triggers and system indices in ini.e
@@ -148,6 +149,7 @@ const USHORT ODS_12_0		= ENCODE_ODS(ODS_VERSION12, 0);
 const USHORT ODS_13_0		= ENCODE_ODS(ODS_VERSION13, 0);
 const USHORT ODS_13_1		= ENCODE_ODS(ODS_VERSION13, 1);
 const USHORT ODS_13_2		= ENCODE_ODS(ODS_VERSION13, 2);
+const USHORT ODS_13_3		= ENCODE_ODS(ODS_VERSION13, 3);
 
 const USHORT ODS_FIREBIRD_FLAG = 0x8000;
 
@@ -175,7 +177,7 @@ const USHORT ODS_RELEASED = ODS_CURRENT13_0;	// The lowest stable minor version
 const USHORT ODS_CURRENT = ODS_CURRENT13;		// The highest defined minor version
 												// number for this ODS_VERSION!
 
-const USHORT ODS_CURRENT_VERSION = ODS_13_2;	// Current ODS version in use which includes
+const USHORT ODS_CURRENT_VERSION = ODS_13_3;	// Current ODS version in use which includes
 												// both major and minor ODS versions!
 
 
@@ -839,6 +841,7 @@ const USHORT rhd_gc_active		= 256;		// garbage collecting dead record version
 const USHORT rhd_uk_modified	= 512;		// record key field values are changed
 const USHORT rhd_long_tranum	= 1024;		// transaction number is 64-bit
 const USHORT rhd_not_packed		= 2048;		// record (or delta) is stored "as is"
+const USHORT rhd_lz_packed		= 4096;		// record (or delta) is LZ-style encoded, ODS 13.3+
 
 
 // This (not exact) copy of class DSC is used to store descriptors on disk.
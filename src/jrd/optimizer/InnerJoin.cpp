@@ -230,7 +230,7 @@ void InnerJoin::estimateCost(unsigned position,
 			// probing + copying cost
 			cardinality * (COST_FACTOR_HASHING + currentCardinality * COST_FACTOR_MEMCOPY);
 
-		if (hashCost <= loopCost && hashCardinality <= HashJoin::maxCapacity())
+		if (hashCardinality <= HashJoin::maxCapacity(tdbb))
 		{
 			auto& equiMatches = joinedStreams[position].equiMatches;
 			fb_assert(!equiMatches.hasData());
@@ -262,9 +262,27 @@ void InnerJoin::estimateCost(unsigned position,
 				}
 			}
 
-			// Adjust the actual cost value, if hash joining is both possible and preferrable
 			if (equiMatches.hasData())
-				cost = hashCost;
+			{
+				// Adjust the actual cost value, if hash joining is preferrable
+				if (hashCost <= loopCost)
+				{
+					joinedStreams[position].hashJoin = true;
+					cost = hashCost;
+				}
+
+				// The join method may be chosen at runtime based on the real cardinality.
+				// Skip it if the hashed stream is expected to be bigger than the prior one,
+				// then a hash join with the sides swapped should be preferred anyway.
+
+				const auto probeCost = COST_FACTOR_HASHING + currentCardinality * COST_FACTOR_MEMCOPY;
+
+				if (!optimizer->favorFirstRows() && (position > 1 || hashCardinality <= cardinality))
+				{
+					joinedStreams[position].switchCardinality =
+						getSwitchCardinality(cardinality, currentCost, hashCost, probeCost);
+				}
+			}
 		}
 	}
 
@@ -272,6 +290,27 @@ void InnerJoin::estimateCost(unsigned position,
 }
 
 
+//
+// Both join costs grow linearly with the prior streams cardinality, so find
+// the point where they're equal. Zero is returned if the hash join is never
+// cheaper or if the point is too far away to be worth waiting for at runtime.
+//
+
+double InnerJoin::getSwitchCardinality(double cardinality, double rowLoopCost,
+									   double hashCost, double rowProbeCost)
+{
+	if (rowLoopCost <= rowProbeCost)
+		return 0;
+
+	const auto switchCardinality = (hashCost - cardinality * rowProbeCost) / (rowLoopCost - rowProbeCost);
+
+	if (switchCardinality > MINIMUM_CARDINALITY && switchCardinality <= MAXIMUM_ADAPTIVE_CARDINALITY)
+		return switchCardinality;
+
+	return 0;
+}
+
+
 //
 // Find the best order out of the streams. First return a stream if it can't use
 // an index based on a previous stream and it can't be used by another stream.
@@ -504,7 +543,7 @@ River* InnerJoin::formRiver()
 
 	RecordSource* rsb;
 	StreamList streams;
-	HalfStaticArray<RecordSource*, OPT_STATIC_ITEMS> rsbs;
+	RecordSourceList rsbs;
 	HalfStaticArray<BoolExprNode*, OPT_STATIC_ITEMS> equiMatches;
 
 	for (const auto& stream : bestStreams)
@@ -520,7 +559,17 @@ River* InnerJoin::formRiver()
 		//    - existing sort was not utilized using an index
 
 		if (rsbs.hasData() && // this is not the first stream
-			stream.equiMatches.hasData() &&
+			stream.switchCardinality > 0)
+		{
+			// The estimated costs of the nested loop join and hash join are close enough
+			// to let the real prior streams cardinality decide between them at runtime
+			rsb = formAdaptiveJoin(stream, streams, rsbs, sortUtilized);
+
+			// Clear priorly processed rsb's, as they're already incorporated into an adaptive join
+			rsbs.clear();
+		}
+		else if (rsbs.hasData() && // this is not the first stream
+			stream.hashJoin &&
 			(!optimizer->favorFirstRows() || !sortUtilized))
 		{
 			fb_assert(streams.hasData());
@@ -577,9 +626,10 @@ River* InnerJoin::formRiver()
 				std::swap(keys[0], keys[1]);
 			}
 
-			// Create a hash join
+			// Create a hash join. If the sort was utilized, the prior streams
+			// are the leader and their order must be preserved.
 			rsb = FB_NEW_POOL(getPool())
-				HashJoin(tdbb, csb, 2, hashJoinRsbs, keys.begin(), stream.selectivity);
+				HashJoin(tdbb, csb, 2, hashJoinRsbs, keys.begin(), stream.selectivity, sortUtilized);
 
 			// Clear priorly processed rsb's, as they're already incorporated into a hash join
 			rsbs.clear();
@@ -617,6 +667,120 @@ River* InnerJoin::formRiver()
 }
 
 
+//
+// Join the stream to the priorly processed ones using both nested loop and hash joining,
+// the join method is chosen at runtime based on the prior streams cardinality
+//
+
+RecordSource* InnerJoin::formAdaptiveJoin(const JoinedStreamInfo& stream,
+										  const StreamList& priorStreams,
+										  const RecordSourceList& priorRsbs,
+										  bool orderedPrior)
+{
+	fb_assert(priorStreams.hasData() && priorRsbs.hasData());
+	fb_assert(stream.equiMatches.hasData());
+
+	// Both retrievals consume conjuncts, so remember their original state
+	HalfStaticArray<unsigned, OPT_STATIC_ITEMS> orgFlags;
+	for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter)
+		orgFlags.add(iter.getFlags());
+
+	// Create an independent retrieval for the hash join
+	RecordSource* hashRsb;
+	{
+		StreamStateHolder stateHolder(csb, priorStreams);
+		stateHolder.deactivate();
+
+		hashRsb = optimizer->generateRetrieval(stream.number, nullptr, false, false);
+	}
+
+	// Create a dependent retrieval for the nested loop join,
+	// starting with the same conjuncts state
+
+	HalfStaticArray<unsigned, OPT_STATIC_ITEMS> hashFlags;
+	FB_SIZE_T pos = 0;
+	for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter, ++pos)
+	{
+		hashFlags.add(iter.getFlags());
+		iter.setFlags(orgFlags[pos]);
+	}
+
+	const auto loopRsb = optimizer->generateRetrieval(stream.number, nullptr, false, false);
+
+	// Compose the conjuncts consumed by the nested loop retrieval but not by
+	// the hash one, they must be rechecked after hash joining. Finally,
+	// mark the conjuncts consumed by either retrieval as used.
+
+	HalfStaticArray<unsigned, OPT_STATIC_ITEMS> loopFlags;
+	pos = 0;
+	for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter, ++pos)
+	{
+		loopFlags.add(iter.getFlags());
+		iter.setFlags(hashFlags[pos]);
+
+		FB_SIZE_T matchPos;
+		if (stream.equiMatches.find(*iter, matchPos))
+			iter |= Optimizer::CONJUNCT_JOINED;
+	}
+
+	BoolExprNode* hashBoolean;
+	{
+		StreamList streams;
+		streams.assign(priorStreams);
+		streams.add(stream.number);
+
+		StreamStateHolder globalHolder(csb);
+		globalHolder.deactivate();
+
+		StreamStateHolder localHolder(csb, streams);
+		localHolder.activate(csb);
+
+		auto iter = optimizer->getConjuncts();
+		hashBoolean = optimizer->composeBoolean(iter);
+	}
+
+	pos = 0;
+	for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter, ++pos)
+		iter |= loopFlags[pos];
+
+	// Prepare the equivalence keys for hash-joining
+
+	HalfStaticArray<NestValueArray*, OPT_STATIC_ITEMS> keys;
+
+	keys.add(FB_NEW_POOL(getPool()) NestValueArray(getPool()));
+	keys.add(FB_NEW_POOL(getPool()) NestValueArray(getPool()));
+
+	for (const auto match : stream.equiMatches)
+	{
+		NestConst<ValueExprNode> node1;
+		NestConst<ValueExprNode> node2;
+
+		if (!optimizer->getEquiJoinKeys(match, &node1, &node2))
+			fb_assert(false);
+
+		if (!node2->containsStream(stream.number))
+		{
+			fb_assert(node1->containsStream(stream.number));
+
+			// Swap the sides
+			std::swap(node1, node2);
+		}
+
+		keys[0]->add(node1);
+		keys[1]->add(node2);
+	}
+
+	// Create a nested loop join from the priorly processed streams
+	const auto priorRsb = (priorRsbs.getCount() == 1) ? priorRsbs[0] :
+		FB_NEW_POOL(getPool()) NestedLoopJoin(csb, priorRsbs.getCount(), priorRsbs.begin());
+
+	const auto threshold = (FB_UINT64) stream.switchCardinality + 1;
+
+	return FB_NEW_POOL(getPool()) AdaptiveJoin(tdbb, csb, priorRsb, loopRsb, hashRsb,
+		keys.begin(), hashBoolean, stream.selectivity, threshold, orderedPrior);
+}
+
+
 //
 // Check if the testStream can use a index when the baseStream is active. If so
 // then we create a indexRelationship and fill it with the needed information.
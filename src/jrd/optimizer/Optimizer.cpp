@@ -1013,6 +1013,17 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 		sort = nullptr;
 	}
 
+	// If the grouping sort was not replaced by the index navigation, it may be
+	// evaluated by hashing. Flag the fact to the calling routine.
+
+	if (rse->flags & RseNode::FLAG_HASH_GROUPING)
+	{
+		if (sort && HashAggregatedStream::isWorthwhile(tdbb, csb, sort->expressions, rsb->getCardinality()))
+			sort = nullptr;
+		else
+			rse->flags &= ~RseNode::FLAG_HASH_GROUPING;
+	}
+
 	// Check index usage in all the base streams to ensure
 	// that any user-specified access plan is followed
 
@@ -1763,6 +1774,7 @@ void Optimizer::checkSorts()
 			{
 				setDirection(project, group);
 				project = rse->rse_projection = nullptr;
+				aggregate->orderedGroups = true;
 			}
 		}
 
@@ -1793,6 +1805,7 @@ void Optimizer::checkSorts()
 				setDirection(sort, group);
 				setPosition(sort, group, map);
 				sort = rse->rse_sorted = nullptr;
+				aggregate->orderedGroups = true;
 			}
 		}
 	}
@@ -2440,7 +2453,7 @@ bool Optimizer::generateEquiJoin(RiverList& orgRivers)
 			keys.back()->add(eq_class[position]);
 	}
 
-	const bool hashOverflow = (maxCardinality2 > HashJoin::maxCapacity());
+	const bool hashOverflow = (maxCardinality2 > HashJoin::maxCapacity(tdbb));
 
 	// If any of to-be-hashed rivers is too large to be hashed efficiently,
 	// then prefer a merge join instead of a hash join.
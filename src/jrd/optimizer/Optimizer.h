@@ -64,6 +64,10 @@ const double MINIMUM_CARDINALITY = 1.0;
 const double THRESHOLD_CARDINALITY = 5.0;
 const double DEFAULT_CARDINALITY = 1000.0;
 
+// Maximum number of outer records to be buffered by an adaptive join
+// while deciding between the nested loop and hash join methods
+const double MAXIMUM_ADAPTIVE_CARDINALITY = 100000.0;
+
 // Default depth of an index tree (including one leaf page),
 // also representing the minimal cost of the index scan.
 // We assume that the root page would be always cached,
@@ -299,6 +303,11 @@ public:
 			return iter->flags;
 		}
 
+		void setFlags(unsigned flags)
+		{
+			iter->flags = flags;
+		}
+
 		void rewind()
 		{
 			iter = begin;
@@ -695,6 +704,8 @@ protected:
 	InversionNode* composeInversion(InversionNode* node1, InversionNode* node2,
 		InversionNode::Type node_type) const;
 	const Firebird::string& getAlias();
+	double getHistogramSelectivity(const IndexScratch* indexScratch,
+		const IndexScratchSegment& segment) const;
 	void getInversionCandidates(InversionCandidateList& inversions,
 		IndexScratchList& indexScratches, unsigned scope) const;
 	InversionNode* makeIndexScanNode(IndexScratch* indexScratch) const;
@@ -851,14 +862,19 @@ class InnerJoin : private Firebird::PermanentStorage
 			number = num;
 			selectivity = 0.0;
 			equiMatches.clear();
+			hashJoin = false;
+			switchCardinality = 0.0;
 		}
 
 		StreamType number;			// stream in position of join order
 		double selectivity = 0.0;	// position selectivity
 		Firebird::Vector<BoolExprNode*, MAX_EQUI_MATCHES> equiMatches;
+		bool hashJoin = false;				// hash join is estimated to be cheaper
+		double switchCardinality = 0.0;		// outer cardinality where join costs are equal
 	};
 
 	typedef Firebird::HalfStaticArray<JoinedStreamInfo, OPT_STATIC_ITEMS> JoinedStreamList;
+	typedef Firebird::HalfStaticArray<RecordSource*, OPT_STATIC_ITEMS> RecordSourceList;
 
 public:
 	InnerJoin(thread_db* tdbb, Optimizer* opt,
@@ -874,9 +890,14 @@ public:
 	bool findJoinOrder();
 	River* formRiver();
 
+	static double getSwitchCardinality(double cardinality, double rowLoopCost,
+		double hashCost, double rowProbeCost);
+
 protected:
 	void calculateStreamInfo();
 	void estimateCost(unsigned position, const StreamInfo* stream, double& cost, double& cardinality);
+	RecordSource* formAdaptiveJoin(const JoinedStreamInfo& stream,
+		const StreamList& priorStreams, const RecordSourceList& priorRsbs, bool orderedPrior);
 	void findBestOrder(unsigned position, StreamInfo* stream,
 		IndexedRelationships& processList, double cost, double cardinality);
 	void getIndexedRelationships(StreamInfo* testStream);
@@ -822,6 +822,69 @@ bool Retrieval::checkIndexExpression(const index_desc* idx, ValueExprNode* node)
 		node->containsStream(stream, true);
 }
 
+double Retrieval::getHistogramSelectivity(const IndexScratch* indexScratch,
+										  const IndexScratchSegment& segment) const
+{
+	// Histogram describes the leading segment of ascending indices only,
+	// and it's useful for literal values known at compile time
+
+	const auto idx = indexScratch->index;
+
+	if (idx->idx_flags & idx_descending)
+		return 0;
+
+	const auto lowerLiteral = nodeAs<LiteralNode>(segment.lowerValue);
+	const auto upperLiteral = nodeAs<LiteralNode>(segment.upperValue);
+
+	switch (segment.scanType)
+	{
+		case segmentScanEqual:
+		case segmentScanEquivalent:
+		case segmentScanGreater:
+			if (!lowerLiteral)
+				return 0;
+			break;
+
+		case segmentScanLess:
+			if (!upperLiteral)
+				return 0;
+			break;
+
+		case segmentScanBetween:
+			if (!lowerLiteral || !upperLiteral)
+				return 0;
+			break;
+
+		default:
+			return 0;
+	}
+
+	const auto histogram = MET_lookup_index_histogram(tdbb, relation, idx);
+
+	if (!histogram)
+		return 0;
+
+	temporary_key lower, upper;
+
+	if (lowerLiteral &&
+		!BTR_make_literal_key(tdbb, idx, &lowerLiteral->litDesc, segment.scale, &lower))
+	{
+		return 0;
+	}
+
+	if (upperLiteral &&
+		!BTR_make_literal_key(tdbb, idx, &upperLiteral->litDesc, segment.scale, &upper))
+	{
+		return 0;
+	}
+
+	if (segment.scanType == segmentScanEqual || segment.scanType == segmentScanEquivalent)
+		return histogram->getEqualSelectivity(&lower);
+
+	return histogram->getRangeSelectivity(lowerLiteral ? &lower : nullptr,
+		upperLiteral ? &upper : nullptr);
+}
+
 void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 									   IndexScratchList& fromIndexScratches,
 									   unsigned scope) const
@@ -853,6 +916,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 			bool unique = false;
 			unsigned listCount = 0;
 			auto maxSelectivity = scratch.selectivity;
+			double skew = 0, rangeSelectivity = 0;
 
 			for (unsigned j = 0; j < scratch.segments.getCount(); j++)
 			{
@@ -887,7 +951,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 					}
 				}
 
-				auto selectivity = idx->idx_rpt[j].idx_selectivity;
+				double selectivity = idx->idx_rpt[j].idx_selectivity;
 				const auto useDefaultSelectivity = (selectivity <= 0);
 
 				// When the index selectivity is zero then the statement is prepared
@@ -895,6 +959,31 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				// match to represent 1/10 of the maximum selectivity.
 				if (useDefaultSelectivity)
 					selectivity = MAX(scratch.selectivity * DEFAULT_SELECTIVITY, minSelectivity);
+				else if (!scratch.usePartialKey)
+				{
+					// The histogram refines the average selectivity of the leading
+					// segment for a known lookup value. Its deviation from the average
+					// is assumed to hold for the longer prefixes of the compound key.
+
+					if (!j)
+					{
+						const double estimated = getHistogramSelectivity(&scratch, segment);
+
+						if (estimated > 0)
+						{
+							if (segment.scanType == segmentScanEqual ||
+								segment.scanType == segmentScanEquivalent)
+							{
+								skew = estimated / selectivity;
+								selectivity = MAX(estimated, minSelectivity);
+							}
+							else
+								rangeSelectivity = MAX(estimated, minSelectivity);
+						}
+					}
+					else if (skew > 0)
+						selectivity = MIN(selectivity * skew, scratch.selectivity);
+				}
 
 				if (segment.scanType == segmentScanList)
 				{
@@ -996,11 +1085,20 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 								break;
 						}
 
-						// Adjust the compound selectivity using the reduce factor.
-						// It should be better than the previous segment but worse
-						// than a full match.
-						const double diffSelectivity = scratch.selectivity - selectivity;
-						selectivity += (diffSelectivity * factor);
+						if (rangeSelectivity > 0)
+						{
+							// Range of the leading segment is estimated by the histogram
+							selectivity = MIN(rangeSelectivity, scratch.selectivity);
+						}
+						else
+						{
+							// Adjust the compound selectivity using the reduce factor.
+							// It should be better than the previous segment but worse
+							// than a full match.
+							const double diffSelectivity = scratch.selectivity - selectivity;
+							selectivity += (diffSelectivity * factor);
+						}
+
 						fb_assert(selectivity <= scratch.selectivity);
 						scratch.selectivity = selectivity;
 
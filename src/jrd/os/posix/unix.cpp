@@ -837,6 +837,58 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+void PIO_prefetch(thread_db* tdbb, jrd_file* file, const ULONG* pages, USHORT count)
+{
+/**************************************
+ *
+ *	P I O _ p r e f e t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Advise the kernel that the given pages (sorted ascending)
+ *	are going to be read soon, so it can start reading them
+ *	asynchronously. Runs of adjacent pages are advised at once.
+ *	Errors are ignored - this is only a hint.
+ *
+ **************************************/
+#ifdef POSIX_FADV_WILLNEED
+	Database* const dbb = tdbb->getDatabase();
+	const FB_UINT64 size = dbb->dbb_page_size;
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+	for (USHORT i = 0; i < count; )
+	{
+		const ULONG first = pages[i];
+
+		while (file && first > file->fil_max_page)
+			file = file->fil_next;
+
+		if (!file)
+			break;
+
+		if (first < file->fil_min_page || file->fil_desc == -1 || (file->fil_flags & FIL_no_fs_cache))
+		{
+			i++;
+			continue;
+		}
+
+		ULONG last = first;
+
+		while (++i < count && pages[i] == last + 1 && pages[i] <= file->fil_max_page)
+			last++;
+
+		const FB_UINT64 offset = (FB_UINT64) (first - file->fil_min_page + file->fil_fudge) * size;
+		const FB_UINT64 length = (FB_UINT64) (last - first + 1) * size;
+
+		if (offset == (FB_UINT64) LSEEK_OFFSET_CAST offset)
+			os_utils::posix_fadvise(file->fil_desc, offset, length, POSIX_FADV_WILLNEED);
+	}
+#endif
+}
+
+
 bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -610,6 +610,22 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+void PIO_prefetch(thread_db* tdbb, jrd_file* file, const ULONG* pages, USHORT count)
+{
+/**************************************
+ *
+ *	P I O _ p r e f e t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Advise the OS that the given pages are going to be read soon.
+ *	Not implemented on Windows - the cache manager detects
+ *	sequential access on its own.
+ *
+ **************************************/
+}
+
 #ifdef SUPERSERVER_V2
 bool PIO_read_ahead(thread_db*	tdbb,
 				   SLONG	start_page,
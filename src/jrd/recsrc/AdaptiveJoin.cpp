@@ -0,0 +1,337 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/RecordBuffer.h"
+#include "../jrd/optimizer/Optimizer.h"
+
+#include "RecordSource.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+// ---------------------------------------------------
+// Data access: nested loop or hash join chosen at runtime
+// ---------------------------------------------------
+
+// Outer stream as seen by both join alternatives. It returns the records
+// buffered while choosing the join method first and then continues reading
+// the real outer stream. Opening and closing is done by the adaptive join itself.
+
+class AdaptiveJoin::OuterStream : public RecordSource
+{
+public:
+	OuterStream(CompilerScratch* csb, const AdaptiveJoin* join)
+		: RecordSource(csb),
+		  m_join(join)
+	{
+		m_impure = csb->allocImpure<Impure>();
+		m_cardinality = join->m_outer->getCardinality();
+	}
+
+	void close(thread_db* /*tdbb*/) const override
+	{
+	}
+
+	bool refetchRecord(thread_db* tdbb) const override
+	{
+		return m_join->m_outer->refetchRecord(tdbb);
+	}
+
+	WriteLockResult lockRecord(thread_db* tdbb) const override
+	{
+		return m_join->m_outer->lockRecord(tdbb);
+	}
+
+	void getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const override
+	{
+		m_join->m_outer->getLegacyPlan(tdbb, plan, level);
+	}
+
+	void markRecursive() override
+	{
+	}
+
+	void invalidateRecords(Request* /*request*/) const override
+	{
+	}
+
+	void findUsedStreams(StreamList& streams, bool expandAll) const override
+	{
+		m_join->m_outer->findUsedStreams(streams, expandAll);
+	}
+
+	void nullRecords(thread_db* /*tdbb*/) const override
+	{
+	}
+
+protected:
+	void internalGetPlan(thread_db* /*tdbb*/, PlanEntry& planEntry, unsigned /*level*/, bool /*recurse*/) const override
+	{
+		planEntry.className = "AdaptiveJoin::OuterStream";
+
+		planEntry.lines.add().text = "Adaptive Join Outer Stream";
+		printOptInfo(planEntry.lines);
+	}
+
+	void internalOpen(thread_db* tdbb) const override
+	{
+		Request* const request = tdbb->getRequest();
+		Impure* const impure = request->getImpure<Impure>(m_impure);
+
+		impure->irsb_flags = irsb_open;
+	}
+
+	bool internalGetRecord(thread_db* tdbb) const override
+	{
+		return m_join->fetchOuter(tdbb);
+	}
+
+private:
+	const AdaptiveJoin* const m_join;
+};
+
+
+AdaptiveJoin::AdaptiveJoin(thread_db* tdbb, CompilerScratch* csb, RecordSource* outer,
+						   RecordSource* loopInner, RecordSource* hashInner,
+						   NestValueArray* const* keys, BoolExprNode* hashBoolean,
+						   double selectivity, FB_UINT64 threshold, bool orderedOuter)
+	: RecordSource(csb),
+	  m_outer(outer),
+	  m_threshold(threshold)
+{
+	fb_assert(m_outer && loopInner && hashInner && keys);
+	fb_assert(m_threshold);
+
+	m_impure = csb->allocImpure<Impure>();
+
+	// This buffer is never opened, it's used only to save and restore
+	// the outer records while they're being counted
+	m_outerBuffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, m_outer);
+
+	RecordSource* const loopArgs[] =
+		{FB_NEW_POOL(csb->csb_pool) OuterStream(csb, this), loopInner};
+	m_loopJoin = FB_NEW_POOL(csb->csb_pool) NestedLoopJoin(csb, 2, loopArgs);
+
+	RecordSource* const hashArgs[] =
+		{FB_NEW_POOL(csb->csb_pool) OuterStream(csb, this), hashInner};
+	m_hashJoin = FB_NEW_POOL(csb->csb_pool)
+		HashJoin(tdbb, csb, 2, hashArgs, keys, selectivity, orderedOuter);
+
+	// The hash join matches the equality keys only, so the other booleans used
+	// by the nested loop inner retrieval must be rechecked. Their selectivity
+	// is already accounted in the join selectivity.
+	if (hashBoolean)
+	{
+		m_hashJoin = FB_NEW_POOL(csb->csb_pool)
+			FilteredStream(csb, m_hashJoin, hashBoolean, MAXIMUM_SELECTIVITY);
+	}
+
+	m_cardinality = (m_outer->getCardinality() < m_threshold) ?
+		m_loopJoin->getCardinality() : m_hashJoin->getCardinality();
+}
+
+void AdaptiveJoin::internalOpen(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	impure->irsb_flags = irsb_open | irsb_mustread;
+	impure->irsb_next = nullptr;
+
+	m_outer->open(tdbb);
+
+	delete impure->irsb_buffer;
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	impure->irsb_buffer = FB_NEW_POOL(pool) RecordBuffer(pool, m_outerBuffer->getFormat());
+	impure->irsb_position = 0;
+
+	// Buffer the outer records until the threshold is reached. If the outer stream
+	// is exhausted before that, the nested loop join is cheaper, otherwise hash it.
+
+	Record* const record = impure->irsb_buffer->getTempRecord();
+
+	while (impure->irsb_buffer->getCount() < m_threshold)
+	{
+		if (!m_outer->getRecord(tdbb))
+		{
+			impure->irsb_flags &= ~irsb_mustread;
+			break;
+		}
+
+		m_outerBuffer->saveRecord(tdbb, record);
+		impure->irsb_buffer->store(record);
+	}
+
+	impure->irsb_next = (impure->irsb_flags & irsb_mustread) ? m_hashJoin : m_loopJoin;
+	impure->irsb_next->open(tdbb);
+}
+
+void AdaptiveJoin::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+
+	invalidateRecords(request);
+
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		impure->irsb_flags &= ~irsb_open;
+
+		delete impure->irsb_buffer;
+		impure->irsb_buffer = nullptr;
+
+		if (impure->irsb_next)
+			impure->irsb_next->close(tdbb);
+
+		m_outer->close(tdbb);
+	}
+}
+
+bool AdaptiveJoin::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+		return false;
+
+	return impure->irsb_next->getRecord(tdbb);
+}
+
+bool AdaptiveJoin::refetchRecord(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+		return false;
+
+	return impure->irsb_next->refetchRecord(tdbb);
+}
+
+WriteLockResult AdaptiveJoin::lockRecord(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+		return WriteLockResult::CONFLICTED;
+
+	return impure->irsb_next->lockRecord(tdbb);
+}
+
+void AdaptiveJoin::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	// Report the join method expected to be chosen
+	const auto join = (m_outer->getCardinality() < m_threshold) ? m_loopJoin : m_hashJoin;
+	join->getLegacyPlan(tdbb, plan, level);
+}
+
+void AdaptiveJoin::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "AdaptiveJoin";
+
+	string extras;
+	extras.printf(" (nested loop below %" UQUADFORMAT " outer records, hash join otherwise)",
+		m_threshold);
+
+	planEntry.lines.add().text = "Adaptive Join (inner)" + extras;
+	printOptInfo(planEntry.lines);
+
+	if (recurse)
+	{
+		++level;
+		m_outer->getPlan(tdbb, planEntry.children.add(), level, recurse);
+		m_loopJoin->getPlan(tdbb, planEntry.children.add(), level, recurse);
+		m_hashJoin->getPlan(tdbb, planEntry.children.add(), level, recurse);
+	}
+}
+
+void AdaptiveJoin::markRecursive()
+{
+	m_outer->markRecursive();
+	m_loopJoin->markRecursive();
+	m_hashJoin->markRecursive();
+}
+
+void AdaptiveJoin::findUsedStreams(StreamList& streams, bool expandAll) const
+{
+	// Both alternatives include the outer stream and the same inner stream
+	m_loopJoin->findUsedStreams(streams, expandAll);
+}
+
+void AdaptiveJoin::invalidateRecords(Request* request) const
+{
+	m_outer->invalidateRecords(request);
+	m_loopJoin->invalidateRecords(request);
+	m_hashJoin->invalidateRecords(request);
+}
+
+void AdaptiveJoin::nullRecords(thread_db* tdbb) const
+{
+	m_outer->nullRecords(tdbb);
+	m_loopJoin->nullRecords(tdbb);
+	m_hashJoin->nullRecords(tdbb);
+}
+
+bool AdaptiveJoin::fetchOuter(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+		return false;
+
+	// Return the buffered records first
+
+	if (impure->irsb_buffer)
+	{
+		Record* const record = impure->irsb_buffer->getTempRecord();
+
+		if (impure->irsb_buffer->fetch(impure->irsb_position, record))
+		{
+			impure->irsb_position++;
+			m_outerBuffer->restoreRecord(tdbb, record);
+			return true;
+		}
+
+		delete impure->irsb_buffer;
+		impure->irsb_buffer = nullptr;
+	}
+
+	// Then continue reading the outer stream, unless it's already exhausted
+
+	if (!(impure->irsb_flags & irsb_mustread))
+		return false;
+
+	if (!m_outer->getRecord(tdbb))
+	{
+		impure->irsb_flags &= ~irsb_mustread;
+		return false;
+	}
+
+	return true;
+}
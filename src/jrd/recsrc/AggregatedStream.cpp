@@ -20,6 +20,7 @@
 #include "firebird.h"
 #include "../jrd/jrd.h"
 #include "../dsql/Nodes.h"
+#include "../dsql/AggNodes.h"
 #include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
@@ -254,6 +255,23 @@ bool BaseAggWinStream<ThisType, NextType>::aggPass(thread_db* tdbb, Request* req
 	return ret;
 }
 
+// Remove the current record from the aggregates. Returns false if some of them
+// cannot be reverted, so the aggregation should be restarted.
+template <typename ThisType, typename NextType>
+bool BaseAggWinStream<ThisType, NextType>::aggRetract(thread_db* tdbb, Request* request,
+	const NestValueArray& sourceList) const
+{
+	for (const auto& source : sourceList)
+	{
+		const AggNode* aggNode = nodeAs<AggNode>(source);
+
+		if (aggNode && !aggNode->aggRetract(tdbb, request))
+			return false;
+	}
+
+	return true;
+}
+
 template <typename ThisType, typename NextType>
 void BaseAggWinStream<ThisType, NextType>::aggExecute(thread_db* tdbb, Request* request,
 	const NestValueArray& sourceList, const NestValueArray& targetList) const
@@ -363,16 +381,29 @@ bool BaseAggWinStream<ThisType, NextType>::getNextRecord(thread_db* tdbb, Reques
 		return m_next->getRecord(tdbb);
 }
 
-// Export the template for WindowedStream::WindowStream.
+// Export the templates for WindowedStream::WindowStream and HashAggregatedStream.
 template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedStream>;
+template class Jrd::BaseAggWinStream<HashAggregatedStream, RecordSource>;
 
 // ------------------------------
 
 AggregatedStream::AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
 			const NestValueArray* group, MapNode* map, RecordSource* next)
-	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next),
+	  m_countOnly(!group)
 {
 	fb_assert(map);
+
+	// A single group consisting of COUNT(*) only may be evaluated by the
+	// underlying stream without fetching its records one by one
+
+	for (const auto& source : map->sourceList)
+	{
+		const auto countNode = nodeAs<CountAggNode>(source);
+
+		if (!countNode || countNode->arg || countNode->distinct)
+			m_countOnly = false;
+	}
 }
 
 void AggregatedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
@@ -408,7 +439,7 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
-	if (!evaluateGroup(tdbb))
+	if (!(m_countOnly && countRecords(tdbb)) && !evaluateGroup(tdbb))
 	{
 		rpb->rpb_number.setValid(false);
 		return false;
@@ -417,3 +448,30 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 	rpb->rpb_number.setValid(true);
 	return true;
 }
+
+// Evaluate the COUNT(*) group using the record counter of the underlying stream.
+// Returns false if the stream cannot count its records, so they should be aggregated as usual.
+bool AggregatedStream::countRecords(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	if (impure->state != STATE_GROUPING)
+		return false;
+
+	FB_UINT64 count = 0;
+
+	if (!m_next->countRecords(tdbb, count))
+		return false;
+
+	impure->state = STATE_EOF;
+
+	aggInit(tdbb, request, m_groupMap);
+
+	for (const auto& source : m_groupMap->sourceList)
+		nodeAs<CountAggNode>(source)->aggPassCount(request, count);
+
+	aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+	return true;
+}
@@ -113,7 +113,9 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				rpb->rpb_number.setValid(true);
-				return true;
+
+				if (checkBloomFilter(tdbb))
+					return true;
 			}
 		} while (bitmap->getNext());
 	}
@@ -160,8 +160,6 @@ bool BufferedStream::internalGetRecord(thread_db* tdbb) const
 	if (!(impure->irsb_flags & irsb_open))
 		return false;
 
-	dsc from, to;
-
 	Record* const buffer_record = impure->irsb_buffer->getTempRecord();
 
 	if (impure->irsb_flags & irsb_mustread)
@@ -175,49 +173,7 @@ bool BufferedStream::internalGetRecord(thread_db* tdbb) const
 			return false;
 		}
 
-		buffer_record->nullify();
-
-		// Assign the fields to the record to be stored
-		for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
-		{
-			const FieldMap& map = m_map[i];
-
-			record_param* const rpb = &request->req_rpb[map.map_stream];
-			Record* const record = rpb->rpb_record;
-
-			if (map.map_type == FieldMap::REGULAR_FIELD)
-			{
-				if (!EVL_field(rpb->rpb_relation, record, map.map_id, &from))
-					continue;
-			}
-
-			buffer_record->clearNull(i);
-
-			if (!EVL_field(rpb->rpb_relation, buffer_record, (USHORT) i, &to))
-				fb_assert(false);
-
-			switch (map.map_type)
-			{
-			case FieldMap::REGULAR_FIELD:
-				MOV_move(tdbb, &from, &to);
-				break;
-
-			case FieldMap::TRANSACTION_ID:
-				*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
-				break;
-
-			case FieldMap::DBKEY_NUMBER:
-				*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
-				break;
-
-			case FieldMap::DBKEY_VALID:
-				*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
-				break;
-
-			default:
-				fb_assert(false);
-			}
-		}
+		saveRecord(tdbb, buffer_record);
 
 		// Put the record into the buffer
 		impure->irsb_buffer->store(buffer_record);
@@ -228,76 +184,7 @@ bool BufferedStream::internalGetRecord(thread_db* tdbb) const
 		if (!impure->irsb_buffer->fetch(impure->irsb_position, buffer_record))
 			return false;
 
-		StreamType stream = INVALID_STREAM;
-
-		// Assign fields back to their original streams
-		for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
-		{
-			const FieldMap& map = m_map[i];
-
-			record_param* const rpb = &request->req_rpb[map.map_stream];
-			jrd_rel* const relation = rpb->rpb_relation;
-
-			rpb->rpb_runtime_flags &= ~RPB_CLEAR_FLAGS;
-
-			if (relation &&
-				!relation->rel_file &&
-				!relation->rel_view_rse &&
-				!relation->isVirtual())
-			{
-				rpb->rpb_runtime_flags |= RPB_refetch;
-			}
-
-			if (map.map_stream != stream)
-			{
-				stream = map.map_stream;
-
-				// See SortedStream::mapData() for explanations why we need
-				// to upgrade the record format
-
-				if (relation && !rpb->rpb_number.isValid())
-					VIO_record(tdbb, rpb, MET_current(tdbb, relation), tdbb->getDefaultPool());
-			}
-
-			const bool isNull = !EVL_field(relation, buffer_record, (USHORT) i, &from);
-
-			if (map.map_type == FieldMap::REGULAR_FIELD)
-			{
-				Record* const record = rpb->rpb_record;
-				record->reset();
-
-				if (isNull)
-					record->setNull(map.map_id);
-				else
-				{
-					EVL_field(relation, record, map.map_id, &to);
-					MOV_move(tdbb, &from, &to);
-					record->clearNull(map.map_id);
-				}
-
-				continue;
-			}
-
-			fb_assert(!isNull);
-
-			switch (map.map_type)
-			{
-			case FieldMap::TRANSACTION_ID:
-				rpb->rpb_transaction_nr = *reinterpret_cast<SINT64*>(from.dsc_address);
-				break;
-
-			case FieldMap::DBKEY_NUMBER:
-				rpb->rpb_number.setValue(*reinterpret_cast<SINT64*>(from.dsc_address));
-				break;
-
-			case FieldMap::DBKEY_VALID:
-				rpb->rpb_number.setValid(*from.dsc_address != 0);
-				break;
-
-			default:
-				fb_assert(false);
-			}
-		}
+		restoreRecord(tdbb, buffer_record);
 	}
 
 	impure->irsb_position++;
@@ -386,3 +273,132 @@ FB_UINT64 BufferedStream::getCount(thread_db* tdbb) const
 
 	return impure->irsb_buffer ? impure->irsb_buffer->getCount() : 0;
 }
+
+void BufferedStream::saveRecord(thread_db* tdbb, Record* buffer_record) const
+{
+	Request* const request = tdbb->getRequest();
+
+	dsc from, to;
+
+	buffer_record->nullify();
+
+	// Assign the fields to the record to be stored
+	for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
+	{
+		const FieldMap& map = m_map[i];
+
+		record_param* const rpb = &request->req_rpb[map.map_stream];
+		Record* const record = rpb->rpb_record;
+
+		if (map.map_type == FieldMap::REGULAR_FIELD)
+		{
+			if (!EVL_field(rpb->rpb_relation, record, map.map_id, &from))
+				continue;
+		}
+
+		buffer_record->clearNull(i);
+
+		if (!EVL_field(rpb->rpb_relation, buffer_record, (USHORT) i, &to))
+			fb_assert(false);
+
+		switch (map.map_type)
+		{
+		case FieldMap::REGULAR_FIELD:
+			MOV_move(tdbb, &from, &to);
+			break;
+
+		case FieldMap::TRANSACTION_ID:
+			*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
+			break;
+
+		case FieldMap::DBKEY_NUMBER:
+			*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
+			break;
+
+		case FieldMap::DBKEY_VALID:
+			*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
+			break;
+
+		default:
+			fb_assert(false);
+		}
+	}
+}
+
+void BufferedStream::restoreRecord(thread_db* tdbb, Record* buffer_record) const
+{
+	Request* const request = tdbb->getRequest();
+
+	dsc from, to;
+
+	StreamType stream = INVALID_STREAM;
+
+	// Assign fields back to their original streams
+	for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
+	{
+		const FieldMap& map = m_map[i];
+
+		record_param* const rpb = &request->req_rpb[map.map_stream];
+		jrd_rel* const relation = rpb->rpb_relation;
+
+		rpb->rpb_runtime_flags &= ~RPB_CLEAR_FLAGS;
+
+		if (relation &&
+			!relation->rel_file &&
+			!relation->rel_view_rse &&
+			!relation->isVirtual())
+		{
+			rpb->rpb_runtime_flags |= RPB_refetch;
+		}
+
+		if (map.map_stream != stream)
+		{
+			stream = map.map_stream;
+
+			// See SortedStream::mapData() for explanations why we need
+			// to upgrade the record format
+
+			if (relation && !rpb->rpb_number.isValid())
+				VIO_record(tdbb, rpb, MET_current(tdbb, relation), tdbb->getDefaultPool());
+		}
+
+		const bool isNull = !EVL_field(relation, buffer_record, (USHORT) i, &from);
+
+		if (map.map_type == FieldMap::REGULAR_FIELD)
+		{
+			Record* const record = rpb->rpb_record;
+			record->reset();
+
+			if (isNull)
+				record->setNull(map.map_id);
+			else
+			{
+				EVL_field(relation, record, map.map_id, &to);
+				MOV_move(tdbb, &from, &to);
+				record->clearNull(map.map_id);
+			}
+
+			continue;
+		}
+
+		fb_assert(!isNull);
+
+		switch (map.map_type)
+		{
+		case FieldMap::TRANSACTION_ID:
+			rpb->rpb_transaction_nr = *reinterpret_cast<SINT64*>(from.dsc_address);
+			break;
+
+		case FieldMap::DBKEY_NUMBER:
+			rpb->rpb_number.setValue(*reinterpret_cast<SINT64*>(from.dsc_address));
+			break;
+
+		case FieldMap::DBKEY_VALID:
+			rpb->rpb_number.setValid(*from.dsc_address != 0);
+			break;
+
+		default:
+			fb_assert(false);
+		}
+	}
+}
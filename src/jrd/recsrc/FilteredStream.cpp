@@ -94,13 +94,16 @@ bool FilteredStream::internalGetRecord(thread_db* tdbb) const
 	if (!(impure->irsb_flags & irsb_open))
 		return false;
 
-	if (!evaluateBoolean(tdbb))
+	while (evaluateBoolean(tdbb))
 	{
-		invalidateRecords(request);
-		return false;
+		// ANY/ALL results do not represent the fetched records, never filter them
+
+		if (!m_bloomFilter || m_anyBoolean || m_bloomFilter->checkBloomFilter(tdbb))
+			return true;
 	}
 
-	return true;
+	invalidateRecords(request);
+	return false;
 }
 
 bool FilteredStream::refetchRecord(thread_db* tdbb) const
@@ -136,6 +139,25 @@ void FilteredStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsi
 		m_next->getPlan(tdbb, planEntry.children.add(), ++level, recurse);
 }
 
+bool FilteredStream::pushBloomFilter(const HashJoin* join, StreamType stream)
+{
+	// Checking the filter evaluates the join keys, so do it here after the boolean
+	// passes rather than in the table scan. Otherwise the keys could be evaluated
+	// (and raise errors) for the records the boolean rejects.
+
+	if (m_bloomFilter)
+		return false;
+
+	StreamList streams;
+	m_next->findUsedStreams(streams);
+
+	if (!streams.exist(stream))
+		return false;
+
+	m_bloomFilter = join;
+	return true;
+}
+
 void FilteredStream::markRecursive()
 {
 	m_next->markRecursive();
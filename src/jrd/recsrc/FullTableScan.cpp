@@ -20,18 +20,325 @@
 #include "firebird.h"
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
+#include "../jrd/tra.h"
+#include "../jrd/cch_proto.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
+#include "../jrd/met_proto.h"
+#include "../jrd/tra_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
 #include "../jrd/Attachment.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
+#include "../common/classes/ClumpletWriter.h"
 
 #include "RecordSource.h"
 
 using namespace Firebird;
 using namespace Jrd;
 
+namespace
+{
+	// Counts records of the relation in parallel, every worker scans its own
+	// pointer pages using a separate attachment and a transaction sharing the
+	// snapshot of the caller.
+
+	class ParallelCountTask : public Task
+	{
+	public:
+		ParallelCountTask(thread_db* tdbb, MemoryPool* pool, jrd_rel* relation,
+				CommitNumber snapshot, ULONG countPP, bool largeScan)
+			: Task(),
+			  m_pool(pool),
+			  m_dbb(tdbb->getDatabase()),
+			  m_relId(relation->rel_id),
+			  m_relName(relation->rel_name),
+			  m_snapshot(snapshot),
+			  m_largeScan(largeScan),
+			  m_items(*m_pool),
+			  m_stop(false),
+			  m_countPP(countPP),
+			  m_nextPP(0)
+		{
+			const int workers = tdbb->getAttachment()->att_parallel_workers;
+
+			for (int i = 0; i < workers; i++)
+				m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+		}
+
+		virtual ~ParallelCountTask()
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				delete *p;
+		}
+
+		class Item : public Task::WorkItem
+		{
+		public:
+			Item(ParallelCountTask* task) : Task::WorkItem(task),
+				m_inuse(false),
+				m_tra(NULL),
+				m_ppSequence(0),
+				m_count(0)
+			{}
+
+			virtual ~Item()
+			{
+				if (!m_attStable)
+					return;
+
+				Attachment* att = NULL;
+				{
+					AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+					att = m_attStable->getHandle();
+					if (!att)
+						return;
+					fb_assert(att->att_use_count > 0);
+				}
+
+				FbLocalStatus status;
+				if (m_tra)
+				{
+					BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+					TRA_commit(tdbb, m_tra, false);
+				}
+				WorkerAttachment::releaseAttachment(&status, m_attStable);
+			}
+
+			ParallelCountTask* getTask() const
+			{
+				return reinterpret_cast<ParallelCountTask*> (m_task);
+			}
+
+			bool init(thread_db* tdbb)
+			{
+				FbStatusVector* status = tdbb->tdbb_status_vector;
+
+				Attachment* att = NULL;
+
+				if (!m_attStable.hasData())
+					m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+				if (m_attStable)
+					att = m_attStable->getHandle();
+
+				if (!att)
+				{
+					Arg::Gds(isc_bad_db_handle).copyTo(status);
+					return false;
+				}
+
+				tdbb->setDatabase(att->att_database);
+				tdbb->setAttachment(att);
+
+				if (!m_tra)
+				{
+					// Records must be seen exactly as the caller sees them
+
+					ClumpletWriter tpb(ClumpletReader::Tpb, 64, isc_tpb_version3);
+					tpb.insertTag(isc_tpb_concurrency);
+					tpb.insertTag(isc_tpb_read);
+					tpb.insertBigInt(isc_tpb_at_snapshot_number, getTask()->m_snapshot);
+
+					try
+					{
+						WorkerContextHolder holder(tdbb, FB_FUNCTION);
+						m_tra = TRA_start(tdbb, tpb.getBufferLength(), tpb.getBuffer());
+						DPM_scan_pages(tdbb);
+					}
+					catch (const Exception& ex)
+					{
+						ex.stuffException(tdbb->tdbb_status_vector);
+						return false;
+					}
+				}
+
+				tdbb->setTransaction(m_tra);
+
+				return true;
+			}
+
+			bool m_inuse;
+			RefPtr<StableAttachmentPart> m_attStable;
+			jrd_tra* m_tra;
+
+			ULONG m_ppSequence;		// pointer page to work on
+			FB_UINT64 m_count;		// records counted by this item
+		};
+
+		bool handler(WorkItem& _item);
+		bool getWorkItem(WorkItem** pItem);
+
+		bool getResult(IStatus* status)
+		{
+			if (status)
+			{
+				status->init();
+				status->setErrors(m_status.getErrors());
+			}
+
+			return m_status.isSuccess();
+		}
+
+		int getMaxWorkers()
+		{
+			return MIN(m_items.getCount(), m_countPP);
+		}
+
+		FB_UINT64 getCount() const
+		{
+			FB_UINT64 count = 0;
+
+			for (const Item* const* p = m_items.begin(); p < m_items.end(); p++)
+				count += (*p)->m_count;
+
+			return count;
+		}
+
+	private:
+		void setError(IStatus* status, bool stopTask)
+		{
+			const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+			if (!copyStatus && (!stopTask || m_stop))
+				return;
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			if (m_status.isSuccess() && copyStatus)
+				m_status.save(status);
+			if (stopTask)
+				m_stop = true;
+		}
+
+		MemoryPool* m_pool;
+		Database* m_dbb;
+		const USHORT m_relId;
+		const MetaName m_relName;
+		const CommitNumber m_snapshot;
+		const bool m_largeScan;
+
+		Mutex m_mutex;
+		HalfStaticArray<Item*, 8> m_items;
+		StatusHolder m_status;
+
+		volatile bool m_stop;
+		const ULONG m_countPP;
+		ULONG m_nextPP;
+	};
+
+	bool ParallelCountTask::handler(WorkItem& _item)
+	{
+		Item* item = reinterpret_cast<Item*>(&_item);
+
+		ThreadContextHolder tdbb(NULL);
+
+		if (!item->init(tdbb))
+		{
+			setError(tdbb->tdbb_status_vector, true);
+			return false;
+		}
+
+		WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+		record_param rpb;
+		jrd_rel* relation = NULL;
+
+		try
+		{
+			Database* const dbb = tdbb->getDatabase();
+
+			relation = MET_lookup_relation_id(tdbb, m_relId, false);
+
+			if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
+				ERR_post(Arg::Gds(isc_relnotdef) << Arg::Str(m_relName));
+
+			if (!(relation->rel_flags & REL_scanned))
+				MET_scan_relation(tdbb, relation);
+
+			rpb.rpb_relation = relation;
+			rpb.rpb_record = NULL;
+			rpb.rpb_stream_flags = RPB_s_no_data;
+			rpb.getWindow(tdbb).win_flags = 0;
+
+			if (m_largeScan)
+			{
+				rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+				rpb.rpb_org_scans = relation->rel_scan_count++;
+			}
+
+			rpb.rpb_number.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_ppSequence);
+			rpb.rpb_number.decrement();
+
+			RecordNumber lastRecNo;
+			lastRecNo.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_ppSequence + 1);
+			lastRecNo.decrement();
+
+			while (!m_stop &&
+				VIO_next_record(tdbb, &rpb, item->m_tra, NULL, DPM_next_pointer_page, &lastRecNo))
+			{
+				CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+				item->m_count++;
+
+				JRD_reschedule(tdbb);
+			}
+
+			delete rpb.rpb_record;
+
+			if (m_largeScan && relation->rel_scan_count)
+				--relation->rel_scan_count;
+
+			return !m_stop;
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+
+			delete rpb.rpb_record;
+
+			if (relation && m_largeScan && relation->rel_scan_count)
+				--relation->rel_scan_count;
+		}
+
+		setError(tdbb->tdbb_status_vector, true);
+		return false;
+	}
+
+	bool ParallelCountTask::getWorkItem(WorkItem** pItem)
+	{
+		Item* item = reinterpret_cast<Item*> (*pItem);
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_stop)
+			return false;
+
+		if (item == NULL)
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			{
+				if (!(*p)->m_inuse)
+				{
+					(*p)->m_inuse = true;
+					*pItem = item = *p;
+					break;
+				}
+			}
+		}
+
+		if (!item)
+			return false;
+
+		item->m_inuse = (m_nextPP < m_countPP);
+
+		if (item->m_inuse)
+			item->m_ppSequence = m_nextPP++;
+
+		return item->m_inuse;
+	}
+} // anonymous namespace
+
 // -------------------------------------------
 // Data access: sequential complete table scan
 // -------------------------------------------
@@ -76,12 +383,16 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 		// A database backup treats everything as a large scan
 		// because the cumulative effect of scanning all relations
 		// is equal to that of a single large relation.
+		//
+		// Pages of such a scan are not going to be reused after the
+		// last record is fetched, so don't let them evict hot pages.
+		// A relation fitting into the cache is scanned as usual.
 
 		BufferControl* const bcb = dbb->dbb_bcb;
 
 		if (attachment->isGbak() || DPM_data_pages(tdbb, m_relation) > bcb->bcb_count)
 		{
-			rpb->getWindow(tdbb).win_flags = WIN_large_scan;
+			rpb->getWindow(tdbb).win_flags = WIN_large_scan | WIN_use_once;
 			rpb->rpb_org_scans = m_relation->rel_scan_count++;
 		}
 	}
@@ -148,16 +459,93 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 
 	const RecordNumber* upper = impure->irsb_upper.isValid() ? &impure->irsb_upper : nullptr;
 
-	if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
+	while (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
 	{
 		rpb->rpb_number.setValid(true);
-		return true;
+
+		if (checkBloomFilter(tdbb))
+			return true;
 	}
 
 	rpb->rpb_number.setValid(false);
 	return false;
 }
 
+bool FullTableScan::countRecords(thread_db* tdbb, FB_UINT64& count) const
+{
+	Database* const dbb = tdbb->getDatabase();
+	Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+	jrd_tra* const transaction = request->req_transaction;
+
+	if (!(impure->irsb_flags & irsb_open) || m_dbkeyRanges.hasData() || m_bloomFilter)
+		return false;
+
+	if (attachment->att_parallel_workers <= 1)
+		return false;
+
+	// Worker attachments can see neither private pages of temporary tables
+	// nor changes made by our own transaction
+
+	if (m_relation->isTemporary() || m_relation->isVirtual() ||
+		(transaction->tra_flags & (TRA_system | TRA_write)))
+	{
+		return false;
+	}
+
+	// Find the snapshot the records are visible in. Read committed transactions
+	// without read consistency have no stable snapshot to share.
+
+	CommitNumber snapshot = 0;
+
+	if (!(transaction->tra_flags & TRA_read_committed))
+		snapshot = transaction->tra_snapshot_number;
+	else if (transaction->tra_flags & TRA_read_consistency)
+	{
+		const Request* const owner = request->req_snapshot.m_owner;
+
+		if (owner && !(owner->req_flags & req_update_conflict))
+			snapshot = owner->req_snapshot.m_number;
+	}
+
+	if (!snapshot)
+		return false;
+
+	const ULONG countPP = DPM_pointer_pages(tdbb, m_relation);
+
+	if (countPP < 2)
+		return false;
+
+	record_param* const rpb = &request->req_rpb[m_stream];
+	const bool largeScan = (rpb->getWindow(tdbb).win_flags & WIN_large_scan);
+
+	Coordinator coord(dbb->dbb_permanent);
+	ParallelCountTask task(tdbb, dbb->dbb_permanent, m_relation, snapshot, countPP, largeScan);
+
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		FbLocalStatus local_status;
+		local_status->init();
+
+		coord.runSync(&task);
+
+		if (!task.getResult(&local_status))
+			local_status.raise();
+	}
+
+	count = task.getCount();
+
+	rpb->rpb_number.setValid(false);
+	impure->irsb_flags &= ~irsb_open;
+
+	if (largeScan && m_relation->rel_scan_count)
+		m_relation->rel_scan_count--;
+
+	return true;
+}
+
 void FullTableScan::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	if (!level)
@@ -0,0 +1,627 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/Aligner.h"
+#include "../common/classes/Hash.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/intl.h"
+#include "../dsql/Nodes.h"
+#include "../dsql/AggNodes.h"
+#include "../dsql/ExprNodes.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/intl_proto.h"
+#include "../jrd/RecordBuffer.h"
+#include "../jrd/optimizer/Optimizer.h"
+
+#include "RecordSource.h"
+#include "HashGroupTable.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+// --------------------------------
+// Data access: hashed aggregation
+// --------------------------------
+
+// Longer group keys are aggregated using the sort
+static const ULONG MAX_GROUP_KEY_LENGTH = 4096;
+
+// Approximate memory taken by the aggregate states of a group
+static const ULONG GROUP_STATE_SIZE = 4 * sizeof(impure_value_ex);
+
+namespace
+{
+	// Mix the bits of the key hash, as it's not guaranteed to be distributed
+	// uniformly. Lower bits are used for the slot, upper bits for the partition.
+	inline ULONG mixHash(ULONG hash)
+	{
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6B;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35;
+		hash ^= hash >> 16;
+
+		return hash;
+	}
+
+	// Length of the binary comparable representation of the group key value
+	ULONG getKeyLength(thread_db* tdbb, const dsc& desc)
+	{
+		USHORT keyLength = desc.isText() ? desc.getStringLength() : desc.dsc_length;
+
+		if (IS_INTL_DATA(&desc))
+			keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), keyLength);
+		else if (desc.isTime())
+			keyLength = sizeof(ISC_TIME);
+		else if (desc.isTimeStamp())
+			keyLength = sizeof(ISC_TIMESTAMP);
+		else if (desc.dsc_dtype == dtype_dec64)
+			keyLength = Decimal64::getKeyLength();
+		else if (desc.dsc_dtype == dtype_dec128)
+			keyLength = Decimal128::getKeyLength();
+
+		return keyLength;
+	}
+
+	// Estimate the number of distinct values of the group key using the statistics
+	// of an index having it as the leading segment. Zero means nothing is known.
+	double getDistinctValues(CompilerScratch* csb, const ValueExprNode* node)
+	{
+		const auto fieldNode = nodeAs<FieldNode>(node);
+
+		if (!fieldNode)
+			return 0;
+
+		const auto tail = &csb->csb_rpt[fieldNode->fieldStream];
+
+		if (!tail->csb_relation || !tail->csb_idx)
+			return 0;
+
+		double result = 0;
+
+		for (const auto& idx : *tail->csb_idx)
+		{
+			if ((idx.idx_flags & (idx_expression | idx_condition)) ||
+				idx.idx_rpt[0].idx_field != fieldNode->fieldId)
+			{
+				continue;
+			}
+
+			const double selectivity = idx.idx_rpt[0].idx_selectivity;
+
+			if (selectivity > 0)
+				result = MAX(result, 1 / selectivity);
+		}
+
+		return result;
+	}
+
+	// Copy the aggregate state, adjusting its descriptor if it points inside the state itself
+	inline void copyState(const impure_value_ex* from, impure_value_ex* to)
+	{
+		memcpy(static_cast<void*>(to), from, sizeof(impure_value_ex));
+
+		const UCHAR* const misc = reinterpret_cast<const UCHAR*>(&from->vlu_misc);
+		const UCHAR* const address = from->vlu_desc.dsc_address;
+
+		if (address >= misc && address < misc + sizeof(from->vlu_misc))
+			to->vlu_desc.dsc_address = reinterpret_cast<UCHAR*>(&to->vlu_misc) + (address - misc);
+	}
+}
+
+
+// Records of the groups that did not fit the memory limit are stored in partitions
+// backed by the temporary space. Partitions are aggregated one by one after the groups
+// kept in memory are returned, and may be split further if they're still too large.
+
+class HashAggregatedStream::PartitionStack : public PermanentStorage
+{
+public:
+	struct Partition
+	{
+		RecordBuffer* buffer;
+		ULONG level;
+	};
+
+	explicit PartitionStack(MemoryPool& pool)
+		: PermanentStorage(pool), m_partitions(pool)
+	{}
+
+	~PartitionStack()
+	{
+		for (const auto& partition : m_partitions)
+			delete partition.buffer;
+	}
+
+	RecordBuffer* add(const Format* format, ULONG level)
+	{
+		Partition partition;
+		partition.buffer = FB_NEW_POOL(getPool()) RecordBuffer(getPool(), format);
+		partition.level = level;
+
+		m_partitions.add(partition);
+		return partition.buffer;
+	}
+
+	// The caller takes the ownership of the partition buffer
+	bool pop(Partition& partition)
+	{
+		if (m_partitions.isEmpty())
+			return false;
+
+		partition = m_partitions.pop();
+		return true;
+	}
+
+private:
+	Array<Partition> m_partitions;
+};
+
+
+HashAggregatedStream::HashAggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, false, next),
+	  m_aggNodes(csb->csb_pool),
+	  m_valueItems(csb->csb_pool),
+	  m_keyLength(0)
+{
+	fb_assert(group && map);
+
+	for (FB_SIZE_T i = 0; i < map->sourceList.getCount(); i++)
+	{
+		const auto aggNode = nodeAs<AggNode>(map->sourceList[i]);
+
+		if (aggNode)
+			m_aggNodes.add(aggNode);
+		else
+			m_valueItems.add(i);
+	}
+
+	// Every key value is prefixed with the NULL marker byte
+
+	m_keyLengths = FB_NEW_POOL(csb->csb_pool) ULONG[group->getCount()];
+
+	for (FB_SIZE_T i = 0; i < group->getCount(); i++)
+	{
+		dsc desc;
+		(*group)[i]->getDesc(tdbb, csb, &desc);
+
+		m_keyLengths[i] = getKeyLength(tdbb, desc);
+		m_keyLength += 1 + m_keyLengths[i];
+	}
+
+	// This buffer is never opened, it's used only to save and restore
+	// the input records if the groups do not fit the memory limit
+	m_buffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, next);
+}
+
+// Check whether the aggregation may be evaluated by hashing
+bool HashAggregatedStream::isSupported(thread_db* tdbb, CompilerScratch* csb,
+	NestValueArray& group, const MapNode* map)
+{
+	if (group.isEmpty())
+		return false;
+
+	// Only the aggregates keeping their whole state inside the impure value
+	// can be evaluated per group, the others require the sorted input
+
+	for (const auto& source : map->sourceList)
+	{
+		const auto aggNode = nodeAs<AggNode>(source);
+
+		if (!aggNode)
+			continue;
+
+		if (aggNode->distinct || aggNode->indexed)
+			return false;
+
+		if (!nodeIs<CountAggNode>(aggNode) && !nodeIs<SumAggNode>(aggNode) &&
+			!nodeIs<AvgAggNode>(aggNode) && !nodeIs<MaxMinAggNode>(aggNode))
+		{
+			return false;
+		}
+	}
+
+	ULONG keyLength = 0;
+
+	for (auto& node : group)
+	{
+		dsc desc;
+		node->getDesc(tdbb, csb, &desc);
+
+		if (desc.isBlob() || desc.dsc_dtype == dtype_array)
+			return false;
+
+		keyLength += 1 + getKeyLength(tdbb, desc);
+	}
+
+	return keyLength <= MAX_GROUP_KEY_LENGTH;
+}
+
+// Check whether the expected groups fit the memory limit, otherwise
+// sorting the input is cheaper than partitioning it repeatedly.
+// The number of groups is estimated using the index statistics of the group keys,
+// if some key has no statistics then the sort is used as before.
+bool HashAggregatedStream::isWorthwhile(thread_db* tdbb, CompilerScratch* csb,
+	NestValueArray& group, double cardinality)
+{
+	const FB_UINT64 memoryLimit = tdbb->getDatabase()->dbb_config->getHashAggregateMemoryLimit();
+
+	if (!memoryLimit)
+		return false;
+
+	// Assume the keys to be independent, this overestimates the groups rather than
+	// underestimates them
+
+	double groupCount = 1;
+
+	for (const auto node : group)
+	{
+		const double values = getDistinctValues(csb, node);
+
+		if (!values)
+			return false;
+
+		groupCount *= values;
+	}
+
+	groupCount = MIN(groupCount, cardinality);
+
+	ULONG groupSize = GROUP_STATE_SIZE;
+
+	for (auto& node : group)
+	{
+		dsc desc;
+		node->getDesc(tdbb, csb, &desc);
+
+		groupSize += 1 + getKeyLength(tdbb, desc);
+	}
+
+	return MAX(groupCount, MINIMUM_CARDINALITY) * groupSize <= (double) memoryLimit;
+}
+
+void HashAggregatedStream::internalOpen(thread_db* tdbb) const
+{
+	BaseAggWinStream::internalOpen(tdbb);
+
+	Impure* const impure = getImpure(tdbb->getRequest());
+
+	delete impure->groups;
+	impure->groups = nullptr;
+
+	delete impure->partitions;
+	impure->partitions = nullptr;
+
+	impure->position = 0;
+	impure->inputDone = false;
+}
+
+void HashAggregatedStream::close(thread_db* tdbb) const
+{
+	Impure* const impure = getImpure(tdbb->getRequest());
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		delete impure->groups;
+		impure->groups = nullptr;
+
+		delete impure->partitions;
+		impure->partitions = nullptr;
+	}
+
+	BaseAggWinStream::close(tdbb);
+}
+
+void HashAggregatedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	m_next->getLegacyPlan(tdbb, plan, level);
+}
+
+void HashAggregatedStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "HashAggregatedStream";
+
+	planEntry.lines.add().text = "Hash Aggregate";
+	printOptInfo(planEntry.lines);
+
+	if (recurse)
+	{
+		++level;
+		m_next->getPlan(tdbb, planEntry.children.add(), level, recurse);
+	}
+}
+
+bool HashAggregatedStream::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = getImpure(request);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		// STATE_GROUPING means that the next portion of input (either the underlying
+		// stream or a spilled partition) is to be aggregated, STATE_FETCHED means that
+		// the aggregated groups are being returned
+
+		while (impure->state != STATE_EOF)
+		{
+			if (impure->state == STATE_FETCHED)
+			{
+				if (impure->position < impure->groups->getCount())
+				{
+					outputGroup(tdbb, request, impure, impure->position++);
+
+					rpb->rpb_number.setValid(true);
+					return true;
+				}
+
+				impure->state = STATE_GROUPING;
+			}
+			else if (aggregateInput(tdbb, request, impure))
+			{
+				impure->state = STATE_FETCHED;
+				impure->position = 0;
+			}
+			else
+				impure->state = STATE_EOF;
+		}
+	}
+
+	rpb->rpb_number.setValid(false);
+	return false;
+}
+
+// Build the binary comparable key of the current record's group and return its hash
+ULONG HashAggregatedStream::computeKey(thread_db* tdbb, Request* request, UCHAR* keyBuffer) const
+{
+	memset(keyBuffer, 0, m_keyLength);
+
+	UCHAR* keyPtr = keyBuffer;
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		dsc* const desc = EVL_expr(tdbb, request, (*m_group)[i]);
+		const USHORT keyLength = (USHORT) m_keyLengths[i];
+		UCHAR* const data = keyPtr + 1;
+
+		if (!desc || (request->req_flags & req_null))
+			*keyPtr = 1;
+		else if (desc->isText())
+		{
+			dsc to;
+			to.makeText(keyLength, desc->getTextType(), data);
+
+			if (IS_INTL_DATA(desc))
+			{
+				// Convert the INTL string into the binary comparable form
+				INTL_string_to_key(tdbb, INTL_INDEX_TYPE(desc),
+								   desc, &to, INTL_KEY_UNIQUE);
+			}
+			else
+			{
+				// This call ensures that the padding bytes are appended
+				MOV_move(tdbb, desc, &to);
+			}
+		}
+		else
+		{
+			const auto address = desc->dsc_address;
+
+			if (desc->isDecFloat())
+			{
+				// Values inside our key buffer are not aligned,
+				// so ensure we satisfy our platform's alignment rules
+				OutAligner<ULONG, MAX_DEC_KEY_LONGS> key(data, keyLength);
+
+				if (desc->dsc_dtype == dtype_dec64)
+					((Decimal64*) address)->makeKey(key);
+				else if (desc->dsc_dtype == dtype_dec128)
+					((Decimal128*) address)->makeKey(key);
+				else
+					fb_assert(false);
+			}
+			else if ((desc->dsc_dtype == dtype_real && *(float*) address == 0) ||
+				(desc->dsc_dtype == dtype_double && *(double*) address == 0))
+			{
+				// Positive and negative zeros belong to the same group,
+				// the key buffer is already filled with the positive zero
+			}
+			else
+			{
+				// Note: for date/time with time zone, we copy only the UTC part
+				fb_assert(keyLength <= desc->dsc_length);
+				memcpy(data, address, keyLength);
+			}
+		}
+
+		keyPtr += 1 + keyLength;
+	}
+
+	fb_assert(keyPtr - keyBuffer == m_keyLength);
+
+	return mixHash(InternalHash::hash(m_keyLength, keyBuffer));
+}
+
+// Aggregate the underlying stream when called for the first time,
+// then the spilled partitions one by one. Returns false if nothing is left.
+bool HashAggregatedStream::aggregateInput(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	if (!impure->groups)
+	{
+		auto& pool = *tdbb->getDefaultPool();
+		const FB_UINT64 memoryLimit = tdbb->getDatabase()->dbb_config->getHashAggregateMemoryLimit();
+
+		impure->groups = FB_NEW_POOL(pool) HashGroupTable(pool, m_keyLength,
+			m_aggNodes.getCount(), m_valueItems.getCount(), memoryLimit);
+		impure->partitions = FB_NEW_POOL(pool) PartitionStack(pool);
+	}
+	else
+		impure->groups->clear();
+
+	// Partitions the records are spilled into during this pass
+	RecordBuffer* spill[HashGroupTable::PARTITION_COUNT] = {};
+
+	if (!impure->inputDone)
+	{
+		impure->inputDone = true;
+
+		while (m_next->getRecord(tdbb))
+			aggregateRecord(tdbb, request, impure, 0, spill);
+
+		return true;
+	}
+
+	PartitionStack::Partition partition;
+
+	if (!impure->partitions->pop(partition))
+		return false;
+
+	AutoPtr<RecordBuffer> buffer(partition.buffer);
+	Record* const record = buffer->getTempRecord();
+
+	for (offset_t position = 0; buffer->fetch(position, record); position++)
+	{
+		m_buffer->restoreRecord(tdbb, record);
+		aggregateRecord(tdbb, request, impure, partition.level, spill);
+	}
+
+	return true;
+}
+
+void HashAggregatedStream::aggregateRecord(thread_db* tdbb, Request* request, Impure* impure,
+	ULONG level, RecordBuffer** spill) const
+{
+	HashGroupTable* const groups = impure->groups;
+	const ULONG hash = computeKey(tdbb, request, groups->getKeyBuffer());
+
+	ULONG index;
+
+	if (!groups->find(hash, index))
+	{
+		// When the memory limit is reached, records of the new groups are spilled
+		// into partitions while the groups in memory continue to be aggregated.
+		// So every group is completely aggregated either in memory or inside
+		// a single partition.
+
+		if (level < HashGroupTable::MAX_SPILL_LEVEL && groups->isFull())
+		{
+			const ULONG number = HashGroupTable::getPartition(hash, level);
+
+			if (!spill[number])
+				spill[number] = impure->partitions->add(m_buffer->getFormat(), level + 1);
+
+			RecordBuffer* const target = spill[number];
+			Record* const record = target->getTempRecord();
+			m_buffer->saveRecord(tdbb, record);
+			target->store(record);
+			return;
+		}
+
+		index = groups->add(hash);
+
+		impure_value_ex* const states = groups->getStates(index);
+
+		for (FB_SIZE_T i = 0; i < m_aggNodes.getCount(); i++)
+		{
+			const AggNode* const aggNode = m_aggNodes[i];
+			impure_value_ex* const state = request->getImpure<impure_value_ex>(aggNode->impureOffset);
+
+			// The string is owned by some other group
+			state->vlu_string = nullptr;
+
+			aggNode->aggInit(tdbb, request);
+			copyState(state, &states[i]);
+		}
+
+		// Values of the non-aggregated items are the same for the whole group
+
+		impure_value* const values = groups->getValues(index);
+
+		for (FB_SIZE_T i = 0; i < m_valueItems.getCount(); i++)
+		{
+			const dsc* const desc = EVL_expr(tdbb, request, m_groupMap->sourceList[m_valueItems[i]]);
+
+			if (request->req_flags & req_null)
+				values[i].vlu_desc.dsc_address = nullptr;
+			else
+				EVL_make_value(tdbb, desc, &values[i]);
+		}
+	}
+
+	impure_value_ex* const states = groups->getStates(index);
+
+	for (FB_SIZE_T i = 0; i < m_aggNodes.getCount(); i++)
+	{
+		const AggNode* const aggNode = m_aggNodes[i];
+		impure_value_ex* const state = request->getImpure<impure_value_ex>(aggNode->impureOffset);
+
+		copyState(&states[i], state);
+
+		try
+		{
+			aggNode->aggPass(tdbb, request);
+		}
+		catch (const Exception&)
+		{
+			// The string may be reallocated already
+			copyState(state, &states[i]);
+			throw;
+		}
+
+		copyState(state, &states[i]);
+	}
+}
+
+void HashAggregatedStream::outputGroup(thread_db* tdbb, Request* request, Impure* impure, ULONG index) const
+{
+	HashGroupTable* const groups = impure->groups;
+
+	const impure_value_ex* const states = groups->getStates(index);
+
+	for (FB_SIZE_T i = 0; i < m_aggNodes.getCount(); i++)
+	{
+		const AggNode* const aggNode = m_aggNodes[i];
+		copyState(&states[i], request->getImpure<impure_value_ex>(aggNode->impureOffset));
+	}
+
+	aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+	impure_value* const values = groups->getValues(index);
+
+	for (FB_SIZE_T i = 0; i < m_valueItems.getCount(); i++)
+	{
+		const ValueExprNode* const target = m_groupMap->targetList[m_valueItems[i]];
+		const FieldNode* const field = nodeAs<FieldNode>(target);
+		Record* const record = request->req_rpb[field->fieldStream].rpb_record;
+
+		if (!values[i].vlu_desc.dsc_address)
+			record->setNull(field->fieldId);
+		else
+		{
+			MOV_move(tdbb, &values[i].vlu_desc, EVL_assign_to(tdbb, target));
+			record->clearNull(field->fieldId);
+		}
+	}
+}
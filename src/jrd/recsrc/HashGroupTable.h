@@ -0,0 +1,222 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_HASH_GROUP_TABLE_H
+#define JRD_HASH_GROUP_TABLE_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../jrd/val.h"
+
+namespace Jrd
+{
+	// The group table keeps fixed size entries consisting of the chain header, the aggregate
+	// states, the cached values of the non-aggregated map items and the group key. Entries
+	// are allocated in blocks and never move, the slots are chained via entry numbers.
+	// The aggregate nodes know nothing about the groups, so their states are copied
+	// into the request impure area and back every time a record is aggregated.
+	// Strings referenced by the states and values are owned by the group entries.
+
+	class HashGroupTable : public Firebird::PermanentStorage
+	{
+		static const ULONG END_OF_CHAIN = MAX_ULONG;
+		static const ULONG MIN_SLOT_COUNT = 64;
+		static const ULONG MAX_SLOT_COUNT = 1u << 30;
+
+		// Groups are allocated in blocks of this size, so that they never move in memory
+		static const ULONG GROUP_BLOCK_SIZE = 64 * 1024;
+
+		struct Header
+		{
+			ULONG next;
+			ULONG hash;
+		};
+
+	public:
+		// Groups not fitting the memory limit are spilled into partitions. Every spill level
+		// uses the next PARTITION_BITS of the key hash, starting with the most significant ones.
+		static const ULONG PARTITION_BITS = 4;
+		static const ULONG PARTITION_COUNT = 1u << PARTITION_BITS;
+		static const ULONG MAX_SPILL_LEVEL = 6;
+
+		static ULONG getPartition(ULONG hash, ULONG level)
+		{
+			fb_assert(level < MAX_SPILL_LEVEL);
+
+			const ULONG shift = 32 - PARTITION_BITS * (level + 1);
+			return (hash >> shift) & (PARTITION_COUNT - 1);
+		}
+
+		HashGroupTable(MemoryPool& pool, ULONG keyLength, ULONG stateCount, ULONG valueCount,
+					   FB_UINT64 memoryLimit)
+			: Firebird::PermanentStorage(pool),
+			  m_blocks(pool), m_slots(pool), m_keyBuffer(pool),
+			  m_keyLength(keyLength), m_stateCount(stateCount), m_valueCount(valueCount),
+			  m_memoryLimit(memoryLimit), m_count(0), m_mask(0)
+		{
+			m_statesOffset = FB_ALIGN(sizeof(Header), alignof(impure_value_ex));
+			m_valuesOffset = m_statesOffset + stateCount * sizeof(impure_value_ex);
+			m_keyOffset = m_valuesOffset + valueCount * sizeof(impure_value);
+			m_entrySize = FB_ALIGN(m_keyOffset + keyLength, alignof(impure_value_ex));
+			m_blockEntries = MAX(GROUP_BLOCK_SIZE / m_entrySize, 1);
+
+			m_keyBuffer.getBuffer(keyLength, false);
+			resize(MIN_SLOT_COUNT);
+		}
+
+		~HashGroupTable()
+		{
+			clear();
+
+			for (const auto block : m_blocks)
+				delete[] block;
+		}
+
+		UCHAR* getKeyBuffer()
+		{
+			return m_keyBuffer.begin();
+		}
+
+		ULONG getCount() const
+		{
+			return m_count;
+		}
+
+		bool isFull() const
+		{
+			const FB_UINT64 memoryUsage = (FB_UINT64) m_count * m_entrySize +
+				m_slots.getCount() * sizeof(ULONG);
+
+			return m_memoryLimit && memoryUsage >= m_memoryLimit;
+		}
+
+		// Find the group having the key stored in the key buffer
+		bool find(ULONG hash, ULONG& index) const
+		{
+			for (ULONG i = m_slots[hash & m_mask]; i != END_OF_CHAIN; )
+			{
+				const UCHAR* const entry = getEntry(i);
+				const Header* const header = reinterpret_cast<const Header*>(entry);
+
+				if (header->hash == hash && !memcmp(entry + m_keyOffset, m_keyBuffer.begin(), m_keyLength))
+				{
+					index = i;
+					return true;
+				}
+
+				i = header->next;
+			}
+
+			return false;
+		}
+
+		// Add the new group having the key stored in the key buffer
+		ULONG add(ULONG hash)
+		{
+			const ULONG index = m_count;
+
+			if (index == m_blocks.getCount() * m_blockEntries)
+				m_blocks.add(FB_NEW_POOL(getPool()) UCHAR[m_blockEntries * m_entrySize]);
+
+			UCHAR* const entry = getEntry(index);
+			memset(entry, 0, m_entrySize);
+			memcpy(entry + m_keyOffset, m_keyBuffer.begin(), m_keyLength);
+
+			Header* const header = reinterpret_cast<Header*>(entry);
+			header->hash = hash;
+			header->next = m_slots[hash & m_mask];
+			m_slots[hash & m_mask] = index;
+
+			// Keep the load factor below one
+			if (++m_count > m_slots.getCount() && m_slots.getCount() < MAX_SLOT_COUNT)
+				resize(m_slots.getCount() * 2);
+
+			return index;
+		}
+
+		impure_value_ex* getStates(ULONG index) const
+		{
+			return reinterpret_cast<impure_value_ex*>(getEntry(index) + m_statesOffset);
+		}
+
+		impure_value* getValues(ULONG index) const
+		{
+			return reinterpret_cast<impure_value*>(getEntry(index) + m_valuesOffset);
+		}
+
+		// Release the groups, the blocks are kept for reuse
+		void clear()
+		{
+			for (ULONG i = 0; i < m_count; i++)
+			{
+				const impure_value_ex* const states = getStates(i);
+				for (ULONG j = 0; j < m_stateCount; j++)
+					delete states[j].vlu_string;
+
+				const impure_value* const values = getValues(i);
+				for (ULONG j = 0; j < m_valueCount; j++)
+					delete values[j].vlu_string;
+			}
+
+			m_count = 0;
+			resize(MIN_SLOT_COUNT);
+		}
+
+	private:
+		UCHAR* getEntry(ULONG index) const
+		{
+			return m_blocks[index / m_blockEntries] + (index % m_blockEntries) * m_entrySize;
+		}
+
+		void resize(ULONG slotCount)
+		{
+			ULONG* const slots = m_slots.getBuffer(slotCount, false);
+
+			for (ULONG i = 0; i < slotCount; i++)
+				slots[i] = END_OF_CHAIN;
+
+			m_mask = slotCount - 1;
+
+			for (ULONG i = 0; i < m_count; i++)
+			{
+				Header* const header = reinterpret_cast<Header*>(getEntry(i));
+				header->next = slots[header->hash & m_mask];
+				slots[header->hash & m_mask] = i;
+			}
+		}
+
+		Firebird::Array<UCHAR*> m_blocks;
+		Firebird::Array<ULONG> m_slots;
+		Firebird::UCharBuffer m_keyBuffer;
+		const ULONG m_keyLength;
+		const ULONG m_stateCount;
+		const ULONG m_valueCount;
+		const FB_UINT64 m_memoryLimit;
+		ULONG m_statesOffset;
+		ULONG m_valuesOffset;
+		ULONG m_keyOffset;
+		ULONG m_entrySize;
+		ULONG m_blockEntries;
+		ULONG m_count;
+		ULONG m_mask;
+	};
+} // namespace Jrd
+
+#endif // JRD_HASH_GROUP_TABLE_H
@@ -21,7 +21,9 @@
  */
 
 #include "firebird.h"
+#include <algorithm>
 #include "../common/classes/Aligner.h"
+#include "../common/classes/BloomFilter.h"
 #include "../common/classes/Hash.h"
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
@@ -30,9 +32,11 @@
 #include "../jrd/evl_proto.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/intl_proto.h"
+#include "../jrd/RecordBuffer.h"
 #include "../jrd/optimizer/Optimizer.h"
 
 #include "RecordSource.h"
+#include "HashJoinTable.h"
 
 using namespace Firebird;
 using namespace Jrd;
@@ -41,187 +45,176 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
-static const ULONG HASH_SIZE = 1009;
-static const ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per slot
+// The bloom filter is dropped if it rejects less than 1/N of the first checked rows
+static const ULONG BLOOM_FILTER_SAMPLE = 4096;
+static const ULONG BLOOM_FILTER_MIN_REJECT_RATIO = 10;
 
-unsigned HashJoin::maxCapacity()
+unsigned HashJoin::maxCapacity(thread_db* tdbb)
 {
-	// Binary search across 1000 collisions is computationally similar to
-	// linear search across 10 collisions. We use this number as a rough
-	// estimation of whether the lookup performance is likely to be acceptable.
-	return HASH_SIZE * 1000;
+	// The hash table grows along with the build side, so the lookup cost
+	// does not depend on the number of rows. The limit is rather set by
+	// the memory the hash table takes while being built.
+	return HashJoinTable::getMaxCount(tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit());
 }
 
 
+// The hash table is built per inner stream, see HashJoinTable for the layout
+
 class HashJoin::HashTable : public PermanentStorage
 {
-	class CollisionList
+public:
+	HashTable(MemoryPool& pool, ULONG streamCount)
+		: PermanentStorage(pool), m_streamCount(streamCount)
 	{
-		static const FB_SIZE_T INVALID_ITERATOR = FB_SIZE_T(~0);
-
-		struct Entry
-		{
-			Entry()
-				: hash(0), position(0)
-			{}
-
-			Entry(ULONG h, ULONG pos)
-				: hash(h), position(pos)
-			{}
-
-			static const ULONG generate(const Entry& item)
-			{
-				return item.hash;
-			}
+		m_tables = FB_NEW_POOL(pool) HashJoinTable*[streamCount];
 
-			ULONG hash;
-			ULONG position;
-		};
-
-	public:
-		CollisionList(MemoryPool& pool)
-			: m_collisions(pool, BUCKET_PREALLOCATE_SIZE),
-			  m_iterator(INVALID_ITERATOR)
-		{
-			m_collisions.setSortMode(FB_ARRAY_SORT_MANUAL);
-		}
+		for (ULONG i = 0; i < streamCount; i++)
+			m_tables[i] = FB_NEW_POOL(pool) HashJoinTable(pool);
+	}
 
-		void sort()
-		{
-			m_collisions.sort();
-		}
+	~HashTable()
+	{
+		for (ULONG i = 0; i < m_streamCount; i++)
+			delete m_tables[i];
 
-		void add(ULONG hash, ULONG position)
-		{
-			m_collisions.add(Entry(hash, position));
-		}
+		delete[] m_tables;
+	}
 
-		bool locate(ULONG hash)
-		{
-			if (m_collisions.find(hash, m_iterator))
-				return true;
+	void reserve(ULONG stream, ULONG count)
+	{
+		fb_assert(stream < m_streamCount);
+		m_tables[stream]->reserve(count);
+	}
 
-			m_iterator = INVALID_ITERATOR;
-			return false;
-		}
+	void put(ULONG stream, ULONG hash, ULONG position)
+	{
+		fb_assert(stream < m_streamCount);
+		m_tables[stream]->add(hash, position);
+	}
 
-		bool iterate(ULONG hash, ULONG& position)
+	bool setup(ULONG hash)
+	{
+		for (ULONG i = 0; i < m_streamCount; i++)
 		{
-			if (m_iterator >= m_collisions.getCount())
-				return false;
-
-			const Entry& collision = m_collisions[m_iterator++];
-
-			if (hash != collision.hash)
-			{
-				m_iterator = INVALID_ITERATOR;
+			if (!m_tables[i]->locate(hash))
 				return false;
-			}
-
-			position = collision.position;
-			return true;
 		}
 
-	private:
-		SortedArray<Entry, EmptyStorage<Entry>, ULONG, Entry> m_collisions;
-		FB_SIZE_T m_iterator;
-	};
+		return true;
+	}
 
-public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
-		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
+	void reset(ULONG stream, ULONG hash)
 	{
-		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
-		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
+		fb_assert(stream < m_streamCount);
+		m_tables[stream]->locate(hash);
 	}
 
-	~HashTable()
+	bool iterate(ULONG stream, ULONG hash, ULONG& position)
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-			delete m_collisions[i];
+		fb_assert(stream < m_streamCount);
+		return m_tables[stream]->iterate(hash, position);
+	}
 
-		delete[] m_collisions;
+	void build()
+	{
+		for (ULONG i = 0; i < m_streamCount; i++)
+			m_tables[i]->build();
 	}
 
-	void put(ULONG stream, ULONG hash, ULONG position)
+	ULONG getCount(ULONG stream) const
 	{
-		const ULONG slot = hash % m_tableSize;
+		fb_assert(stream < m_streamCount);
+		return m_tables[stream]->getCount();
+	}
 
+	void fillFilter(ULONG stream, BloomFilter& filter) const
+	{
 		fb_assert(stream < m_streamCount);
-		fb_assert(slot < m_tableSize);
+		m_tables[stream]->fillFilter(filter);
+	}
 
-		CollisionList* collisions = m_collisions[stream * m_tableSize + slot];
+private:
+	const ULONG m_streamCount;
+	HashJoinTable** m_tables;
+};
 
-		if (!collisions)
-		{
-			collisions = FB_NEW_POOL(getPool()) CollisionList(getPool());
-			m_collisions[stream * m_tableSize + slot] = collisions;
-		}
 
-		collisions->add(hash, position);
-	}
+// When the build side does not fit the memory limit, both the leader and inner streams
+// are split into partitions by the key hash (Grace hash join). Every partition keeps
+// its records in separate temporary space backed buffers, partitions are then joined
+// one by one using a hash table that covers only the current partition.
 
-	bool setup(ULONG hash)
+class HashJoin::PartitionSet : public PermanentStorage
+{
+public:
+	PartitionSet(MemoryPool& pool, const BufferedStream* leader,
+				 const Array<SubStream>& args, ULONG partitionCount)
+		: PermanentStorage(pool),
+		  m_streamCount(args.getCount() + 1),
+		  m_partitionCount(partitionCount),
+		  m_buffers(pool)
 	{
-		const ULONG slot = hash % m_tableSize;
+		fb_assert(partitionCount && !(partitionCount & (partitionCount - 1)));
 
-		for (ULONG i = 0; i < m_streamCount; i++)
+		for (ULONG i = 0; i < partitionCount; i++)
 		{
-			CollisionList* const collisions = m_collisions[i * m_tableSize + slot];
+			m_buffers.add(FB_NEW_POOL(pool) RecordBuffer(pool, leader->getFormat()));
 
-			if (!collisions)
-				return false;
-
-			if (!collisions->locate(hash))
-				return false;
+			for (const auto& arg : args)
+				m_buffers.add(FB_NEW_POOL(pool) RecordBuffer(pool, arg.buffer->getFormat()));
 		}
+	}
 
-		m_slot = slot;
-		return true;
+	~PartitionSet()
+	{
+		for (auto buffer : m_buffers)
+			delete buffer;
 	}
 
-	void reset(ULONG stream, ULONG hash)
+	ULONG getCount() const
 	{
-		fb_assert(stream < m_streamCount);
+		return m_partitionCount;
+	}
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		collisions->locate(hash);
+	ULONG getPartition(ULONG hash) const
+	{
+		return HashJoinTable::getPartition(hash, m_partitionCount);
 	}
 
-	bool iterate(ULONG stream, ULONG hash, ULONG& position)
+	RecordBuffer* getLeader(ULONG partition) const
 	{
-		fb_assert(stream < m_streamCount);
+		fb_assert(partition < m_partitionCount);
+		return m_buffers[partition * m_streamCount];
+	}
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		return collisions->iterate(hash, position);
+	RecordBuffer* getInner(ULONG partition, FB_SIZE_T stream) const
+	{
+		fb_assert(partition < m_partitionCount);
+		fb_assert(stream + 1 < m_streamCount);
+		return m_buffers[partition * m_streamCount + stream + 1];
 	}
 
-	void sort()
+	void release(ULONG partition)
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-		{
-			CollisionList* const collisions = m_collisions[i];
+		fb_assert(partition < m_partitionCount);
 
-			if (collisions)
-				collisions->sort();
-		}
+		for (ULONG i = 0; i < m_streamCount; i++)
+			m_buffers[partition * m_streamCount + i]->reset();
 	}
 
 private:
 	const ULONG m_streamCount;
-	const ULONG m_tableSize;
-	CollisionList** m_collisions;
-	ULONG m_slot;
+	const ULONG m_partitionCount;
+	Array<RecordBuffer*> m_buffers;
 };
 
 
 HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 				   RecordSource* const* args, NestValueArray* const* keys,
-				   double selectivity)
+				   double selectivity, bool orderedLeader)
 	: RecordSource(csb),
-	  m_args(csb->csb_pool, count - 1)
+	  m_args(csb->csb_pool, count - 1),
+	  m_orderedLeader(orderedLeader)
 {
 	fb_assert(count >= 2);
 
@@ -300,6 +293,22 @@ HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 		m_args.add(sub);
 	}
 
+	// This buffer is never opened, it's used only to save and restore
+	// the leader records if the join has to be partitioned
+	m_leaderBuffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, m_leader.source);
+
+	// If the leader keys depend on a single stream, then the leader rows may be
+	// checked against the bloom filter built over the first inner stream keys.
+	// Push it down to the table scan, so that rows not having a match are
+	// rejected right after being fetched.
+
+	SortedStreamList keyStreams;
+	for (const auto key : *m_leader.keys)
+		key->collectStreams(keyStreams);
+
+	if (keyStreams.getCount() == 1)
+		m_bloomFilter = m_leader.source->pushBloomFilter(this, keyStreams[0]);
+
 	if (!selectivity)
 	{
 		selectivity = MAXIMUM_SELECTIVITY;
@@ -323,6 +332,14 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	delete[] impure->irsb_leader_buffer;
 	impure->irsb_leader_buffer = nullptr;
 
+	delete impure->irsb_partitions;
+	impure->irsb_partitions = nullptr;
+
+	delete impure->irsb_bloom_filter;
+	impure->irsb_bloom_filter = nullptr;
+	impure->irsb_bloom_checks = impure->irsb_bloom_rejects = 0;
+	impure->irsb_leader_hashed = false;
+
 	m_leader.source->open(tdbb);
 }
 
@@ -343,6 +360,12 @@ void HashJoin::close(thread_db* tdbb) const
 		delete[] impure->irsb_leader_buffer;
 		impure->irsb_leader_buffer = nullptr;
 
+		delete impure->irsb_partitions;
+		impure->irsb_partitions = nullptr;
+
+		delete impure->irsb_bloom_filter;
+		impure->irsb_bloom_filter = nullptr;
+
 		for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
 			m_args[i].buffer->close(tdbb);
 
@@ -366,7 +389,12 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 		{
 			// Fetch the record from the leading stream
 
-			if (!m_leader.source->getRecord(tdbb))
+			if (impure->irsb_partitions)
+			{
+				if (!fetchLeaderRecord(tdbb, impure))
+					return false;
+			}
+			else if (!m_leader.source->getRecord(tdbb))
 				return false;
 
 			// We have something to join with, so ensure the hash table is initialized
@@ -381,6 +409,14 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 
 				UCharBuffer buffer(pool);
 
+				// Partitioning returns the leader records in the partition order,
+				// so it cannot be used if the leader is expected to be ordered
+
+				const FB_UINT64 memoryLimit = m_orderedLeader ? 0 :
+					tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit();
+				FB_UINT64 buildSize = 0;
+				bool partition = false;
+
 				for (FB_SIZE_T i = 0; i < argCount; i++)
 				{
 					// Read and cache the inner streams. While doing that,
@@ -388,23 +424,66 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 
 					m_args[i].buffer->open(tdbb);
 
+					// Pre-size the table using the optimizer's estimation
+
+					const double estimate = m_args[i].source->getCardinality();
+					if (estimate > 0)
+						impure->irsb_hash_table->reserve(i, (ULONG) MIN(estimate, (double) MAX_ULONG));
+
 					ULONG counter = 0;
 					const auto keyBuffer = buffer.getBuffer(m_args[i].totalKeyLength, false);
+					// Every record takes its hash table entry and slot besides the record itself
+
+					const ULONG rowSize = m_args[i].buffer->getFormat()->fmt_length +
+						HashJoinTable::ROW_BUILD_SIZE;
 
 					while (m_args[i].buffer->getRecord(tdbb))
 					{
-						const auto hash = computeHash(tdbb, request, m_args[i], keyBuffer);
-						impure->irsb_hash_table->put(i, hash, counter++);
+						buildSize += rowSize;
+
+						// Once the build side exceeds the limit, just buffer
+						// the remaining records, they will be partitioned later
+
+						if (memoryLimit && buildSize > memoryLimit)
+							partition = true;
+
+						if (!partition)
+						{
+							const auto hash = computeHash(tdbb, request, m_args[i], keyBuffer);
+							impure->irsb_hash_table->put(i, hash, counter++);
+						}
 					}
 				}
 
-				impure->irsb_hash_table->sort();
+				if (partition)
+				{
+					// Split both sides into partitions, including the leader record
+					// we have just fetched, and restart from the first partition
+
+					partitionStreams(tdbb, impure, buildSize);
+					continue;
+				}
+
+				impure->irsb_hash_table->build();
+
+				if (m_bloomFilter)
+				{
+					impure->irsb_bloom_filter =
+						FB_NEW_POOL(pool) BloomFilter(pool, impure->irsb_hash_table->getCount(0));
+					impure->irsb_hash_table->fillFilter(0, *impure->irsb_bloom_filter);
+				}
 			}
 
-			// Compute and hash the comparison keys
+			// Compute and hash the comparison keys, unless it's already done
+			// for this record while checking the bloom filter
+
+			if (!impure->irsb_leader_hashed || impure->irsb_partitions)
+			{
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+			}
 
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+			impure->irsb_leader_hashed = false;
 
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
@@ -511,6 +590,47 @@ void HashJoin::findUsedStreams(StreamList& streams, bool expandAll) const
 		m_args[i].source->findUsedStreams(streams, expandAll);
 }
 
+bool HashJoin::pushBloomFilter(const HashJoin* join, StreamType stream)
+{
+	return m_leader.source->pushBloomFilter(join, stream);
+}
+
+bool HashJoin::checkBloomFilter(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	// The filter becomes available once the inner streams are hashed
+
+	BloomFilter* const filter = impure->irsb_bloom_filter;
+
+	impure->irsb_leader_hashed = false;
+
+	if (!filter)
+		return true;
+
+	// The leader record is fetched right now, so its hash is kept for internalGetRecord()
+
+	impure->irsb_leader_hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+	impure->irsb_leader_hashed = true;
+
+	const bool found = filter->mayContain(impure->irsb_leader_hash);
+
+	if (!found)
+		impure->irsb_bloom_rejects++;
+
+	// Stop filtering if the filter appears to be not selective enough
+
+	if (++impure->irsb_bloom_checks == BLOOM_FILTER_SAMPLE &&
+		impure->irsb_bloom_rejects < BLOOM_FILTER_SAMPLE / BLOOM_FILTER_MIN_REJECT_RATIO)
+	{
+		delete impure->irsb_bloom_filter;
+		impure->irsb_bloom_filter = nullptr;
+	}
+
+	return found;
+}
+
 void HashJoin::invalidateRecords(Request* request) const
 {
 	m_leader.source->invalidateRecords(request);
@@ -610,14 +730,10 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 {
 	HashTable* const hashTable = impure->irsb_hash_table;
 
-	const BufferedStream* const arg = m_args[stream].buffer;
-
 	ULONG position;
 	if (hashTable->iterate(stream, impure->irsb_leader_hash, position))
 	{
-		arg->locate(tdbb, position);
-
-		if (arg->getRecord(tdbb))
+		if (fetchInnerRecord(tdbb, impure, stream, position))
 			return true;
 	}
 
@@ -630,10 +746,185 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 
 		if (hashTable->iterate(stream, impure->irsb_leader_hash, position))
 		{
-			arg->locate(tdbb, position);
-
-			if (arg->getRecord(tdbb))
+			if (fetchInnerRecord(tdbb, impure, stream, position))
 				return true;
 		}
 	}
 }
+
+bool HashJoin::fetchInnerRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream, ULONG position) const
+{
+	const BufferedStream* const arg = m_args[stream].buffer;
+
+	if (impure->irsb_partitions)
+	{
+		RecordBuffer* const buffer = impure->irsb_partitions->getInner(impure->irsb_partition, stream);
+		Record* const record = buffer->getTempRecord();
+
+		if (!buffer->fetch(position, record))
+			return false;
+
+		arg->restoreRecord(tdbb, record);
+		return true;
+	}
+
+	arg->locate(tdbb, position);
+	return arg->getRecord(tdbb);
+}
+
+void HashJoin::partitionStreams(thread_db* tdbb, Impure* impure, FB_UINT64 buildSize) const
+{
+	Request* const request = tdbb->getRequest();
+	auto& pool = *tdbb->getDefaultPool();
+
+	const FB_UINT64 memoryLimit = tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit();
+	fb_assert(memoryLimit);
+
+	const ULONG partitionCount = HashJoinTable::getPartitionCount(buildSize, memoryLimit);
+
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = nullptr;
+
+	PartitionSet* const partitions = impure->irsb_partitions =
+		FB_NEW_POOL(pool) PartitionSet(pool, m_leaderBuffer, m_args, partitionCount);
+
+	UCharBuffer buffer(pool);
+
+	// Distribute the buffered inner streams between partitions
+
+	for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
+	{
+		const BufferedStream* const arg = m_args[i].buffer;
+		const auto keyBuffer = buffer.getBuffer(m_args[i].totalKeyLength, false);
+
+		BloomFilter* filter = nullptr;
+
+		if (m_bloomFilter && i == 0)
+		{
+			filter = impure->irsb_bloom_filter =
+				FB_NEW_POOL(pool) BloomFilter(pool, (FB_SIZE_T) arg->getCount(tdbb));
+		}
+
+		arg->locate(tdbb, 0);
+
+		while (arg->getRecord(tdbb))
+		{
+			const auto hash = computeHash(tdbb, request, m_args[i], keyBuffer);
+
+			if (filter)
+				filter->add(hash);
+
+			RecordBuffer* const target = partitions->getInner(partitions->getPartition(hash), i);
+			Record* const record = target->getTempRecord();
+			arg->saveRecord(tdbb, record);
+			target->store(record);
+		}
+
+		// The whole stream is partitioned now, so release its buffer
+		arg->close(tdbb);
+	}
+
+	// Distribute the leader stream, starting with its current record
+
+	do
+	{
+		const auto hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+
+		RecordBuffer* const target = partitions->getLeader(partitions->getPartition(hash));
+		Record* const record = target->getTempRecord();
+		m_leaderBuffer->saveRecord(tdbb, record);
+		target->store(record);
+	} while (m_leader.source->getRecord(tdbb));
+
+	impure->irsb_partition = 0;
+	impure->irsb_leader_position = 0;
+}
+
+bool HashJoin::loadPartition(thread_db* tdbb, Impure* impure) const
+{
+	Request* const request = tdbb->getRequest();
+	PartitionSet* const partitions = impure->irsb_partitions;
+	const ULONG partition = impure->irsb_partition;
+
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = nullptr;
+
+	// Nothing can be joined if any side of the partition is empty
+
+	if (!partitions->getLeader(partition)->getCount())
+		return false;
+
+	for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
+	{
+		if (!partitions->getInner(partition, i)->getCount())
+			return false;
+	}
+
+	// Partitions are not split any further. If the keys are skewed and a partition
+	// still exceeds the memory limit, it's hashed in memory as a whole.
+
+	auto& pool = *tdbb->getDefaultPool();
+	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, m_args.getCount());
+
+	UCharBuffer buffer(pool);
+
+	for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
+	{
+		RecordBuffer* const source = partitions->getInner(partition, i);
+		Record* const record = source->getTempRecord();
+		const auto keyBuffer = buffer.getBuffer(m_args[i].totalKeyLength, false);
+
+		impure->irsb_hash_table->reserve(i, (ULONG) source->getCount());
+
+		for (ULONG position = 0; source->fetch(position, record); position++)
+		{
+			m_args[i].buffer->restoreRecord(tdbb, record);
+
+			const auto hash = computeHash(tdbb, request, m_args[i], keyBuffer);
+			impure->irsb_hash_table->put(i, hash, position);
+		}
+	}
+
+	impure->irsb_hash_table->build();
+	return true;
+}
+
+bool HashJoin::fetchLeaderRecord(thread_db* tdbb, Impure* impure) const
+{
+	PartitionSet* const partitions = impure->irsb_partitions;
+
+	while (impure->irsb_partition < partitions->getCount())
+	{
+		if (!impure->irsb_hash_table)
+		{
+			// Load the partition, skipping the ones that cannot produce matches
+
+			if (!loadPartition(tdbb, impure))
+			{
+				partitions->release(impure->irsb_partition++);
+				continue;
+			}
+
+			impure->irsb_leader_position = 0;
+		}
+
+		RecordBuffer* const buffer = partitions->getLeader(impure->irsb_partition);
+		Record* const record = buffer->getTempRecord();
+
+		if (buffer->fetch(impure->irsb_leader_position, record))
+		{
+			impure->irsb_leader_position++;
+			m_leaderBuffer->restoreRecord(tdbb, record);
+			return true;
+		}
+
+		// The partition is exhausted, proceed with the next one
+
+		delete impure->irsb_hash_table;
+		impure->irsb_hash_table = nullptr;
+
+		partitions->release(impure->irsb_partition++);
+	}
+
+	return false;
+}
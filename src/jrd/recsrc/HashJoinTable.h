@@ -0,0 +1,260 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_HASH_JOIN_TABLE_H
+#define JRD_HASH_JOIN_TABLE_H
+
+#include <algorithm>
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/BloomFilter.h"
+
+namespace Jrd
+{
+	// The hash table of a single inner stream of the hash join. All (hash, position) entries
+	// are stored in a single contiguous array ordered by slot (and by hash inside a slot),
+	// with a separate array of slot offsets pointing into it. Entries are collected
+	// unordered while the stream is being buffered and the table is laid out once
+	// the final number of rows is known, so its size always matches the build side.
+	// Probing a key touches the slot offset and usually a single cache line of entries.
+
+	class HashJoinTable : public Firebird::PermanentStorage
+	{
+		static const ULONG MIN_TABLE_SIZE = 64;
+		static const ULONG MAX_TABLE_SIZE = 1u << 30;
+		static const ULONG MAX_PREALLOCATE_ENTRIES = 1u << 20;
+
+		// Slots longer than this are binary searched instead of being scanned linearly
+		static const ULONG LINEAR_SEARCH_THRESHOLD = 8;
+
+		// Number of rows hashed when there's no memory limit
+		static const ULONG MAX_UNLIMITED_COUNT = 64 * 1024 * 1024;
+
+		struct Entry
+		{
+			Entry()
+				: hash(0), position(0)
+			{}
+
+			Entry(ULONG h, ULONG pos)
+				: hash(h), position(pos)
+			{}
+
+			ULONG hash;
+			ULONG position;
+		};
+
+	public:
+		// Memory taken by every row while the table is being built: its entry is stored
+		// twice (unordered and ordered), and the table size is rounded up to a power
+		// of two, so up to two slot offsets and two fill cursors are allocated per row
+		static const ULONG ROW_BUILD_SIZE = 2 * sizeof(Entry) + 4 * sizeof(ULONG);
+
+		// Maximum number of partitions the oversized build side may be split into
+		static const ULONG MAX_PARTITIONS = 256;
+
+		// Mix the bits of the key hash, as it's not guaranteed to be distributed
+		// uniformly. Lower bits are used for the slot, upper bits for the partition.
+		static ULONG mixHash(ULONG hash)
+		{
+			hash ^= hash >> 16;
+			hash *= 0x85EBCA6B;
+			hash ^= hash >> 13;
+			hash *= 0xC2B2AE35;
+			hash ^= hash >> 16;
+
+			return hash;
+		}
+
+		// Number of partitions the build side is split into, so that every partition
+		// fits the memory limit unless the keys are skewed
+		static ULONG getPartitionCount(FB_UINT64 buildSize, FB_UINT64 memoryLimit)
+		{
+			fb_assert(memoryLimit && buildSize);
+
+			// Partition size is rounded up, i.e. (buildSize - 1) / partitionCount + 1
+
+			ULONG partitionCount = 2;
+			while (partitionCount < MAX_PARTITIONS && (buildSize - 1) / partitionCount >= memoryLimit)
+				partitionCount <<= 1;
+
+			return partitionCount;
+		}
+
+		// Partitions use the upper bits of the mixed hash, while the slots of the partition
+		// table use the lower ones, so the rows of a partition are spread over all its slots
+		static ULONG getPartition(ULONG hash, ULONG partitionCount)
+		{
+			fb_assert(partitionCount && !(partitionCount & (partitionCount - 1)));
+			return (mixHash(hash) >> 24) & (partitionCount - 1);
+		}
+
+		// Maximum number of rows the table may be built for within the memory limit
+		static ULONG getMaxCount(FB_UINT64 memoryLimit)
+		{
+			if (!memoryLimit)
+				return MAX_UNLIMITED_COUNT;
+
+			return (ULONG) MIN(memoryLimit / ROW_BUILD_SIZE, MAX_TABLE_SIZE);
+		}
+
+		explicit HashJoinTable(MemoryPool& pool)
+			: Firebird::PermanentStorage(pool), m_entries(pool), m_slots(pool),
+			  m_mask(0), m_iterator(0), m_end(0)
+		{}
+
+		void reserve(ULONG count)
+		{
+			m_entries.ensureCapacity(MIN(count, MAX_PREALLOCATE_ENTRIES));
+		}
+
+		void add(ULONG hash, ULONG position)
+		{
+			m_entries.add(Entry(hash, position));
+		}
+
+		void build()
+		{
+			const ULONG count = m_entries.getCount();
+
+			// Choose the power-of-two table size, so that the load factor is below one
+
+			ULONG tableSize = MIN_TABLE_SIZE;
+			while (tableSize < count && tableSize < MAX_TABLE_SIZE)
+				tableSize <<= 1;
+
+			m_mask = tableSize - 1;
+
+			// Count entries per slot and convert the counters into offsets
+
+			ULONG* const slots = m_slots.getBuffer(tableSize + 1, false);
+			memset(slots, 0, (tableSize + 1) * sizeof(ULONG));
+
+			for (const auto& entry : m_entries)
+				slots[getSlot(entry.hash) + 1]++;
+
+			for (ULONG i = 1; i <= tableSize; i++)
+				slots[i] += slots[i - 1];
+
+			// Scatter entries into their slots
+
+			Firebird::Array<Entry> entries(getPool());
+			Entry* const ordered = entries.getBuffer(count, false);
+
+			{	// scope
+				Firebird::Array<ULONG> fill(getPool());
+				ULONG* const cursor = fill.getBuffer(tableSize, false);
+				memcpy(cursor, slots, tableSize * sizeof(ULONG));
+
+				for (const auto& entry : m_entries)
+					ordered[cursor[getSlot(entry.hash)]++] = entry;
+			}
+
+			// Order every slot by hash value, so that equal hashes are adjacent
+
+			for (ULONG i = 0; i < tableSize; i++)
+			{
+				if (slots[i + 1] - slots[i] > 1)
+				{
+					std::sort(ordered + slots[i], ordered + slots[i + 1],
+						[](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+				}
+			}
+
+			memcpy(m_entries.begin(), ordered, count * sizeof(Entry));
+
+			m_iterator = m_end = 0;
+		}
+
+		ULONG getCount() const
+		{
+			return m_entries.getCount();
+		}
+
+		void fillFilter(Firebird::BloomFilter& filter) const
+		{
+			for (const auto& entry : m_entries)
+				filter.add(entry.hash);
+		}
+
+		bool locate(ULONG hash)
+		{
+			const ULONG slot = getSlot(hash);
+			const Entry* const entries = m_entries.begin();
+
+			ULONG start = m_slots[slot];
+			const ULONG end = m_slots[slot + 1];
+
+			if (end - start > LINEAR_SEARCH_THRESHOLD)
+			{
+				const Entry* const found = std::lower_bound(entries + start, entries + end, hash,
+					[](const Entry& item, ULONG value) { return item.hash < value; });
+
+				start = found - entries;
+			}
+			else
+			{
+				while (start < end && entries[start].hash < hash)
+					start++;
+			}
+
+			if (start < end && entries[start].hash == hash)
+			{
+				m_iterator = start;
+				m_end = end;
+				return true;
+			}
+
+			m_iterator = m_end = 0;
+			return false;
+		}
+
+		bool iterate(ULONG hash, ULONG& position)
+		{
+			if (m_iterator >= m_end)
+				return false;
+
+			const Entry& entry = m_entries[m_iterator++];
+
+			if (hash != entry.hash)
+			{
+				m_iterator = m_end = 0;
+				return false;
+			}
+
+			position = entry.position;
+			return true;
+		}
+
+	private:
+		ULONG getSlot(ULONG hash) const
+		{
+			return mixHash(hash) & m_mask;
+		}
+
+		Firebird::Array<Entry> m_entries;
+		Firebird::Array<ULONG> m_slots;
+		ULONG m_mask;
+		ULONG m_iterator;
+		ULONG m_end;
+	};
+} // namespace Jrd
+
+#endif // JRD_HASH_JOIN_TABLE_H
@@ -332,7 +332,9 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 							rpb->rpb_number.getValue());
 
 					rpb->rpb_number.setValid(true);
-					return true;
+
+					if (checkBloomFilter(tdbb))
+						return true;
 				}
 			}
 
@@ -276,6 +276,23 @@ void NestedLoopJoin::findUsedStreams(StreamList& streams, bool expandAll) const
 		m_args[i]->findUsedStreams(streams, expandAll);
 }
 
+bool NestedLoopJoin::pushBloomFilter(const HashJoin* join, StreamType stream)
+{
+	// Rows of the outer stream are always a part of the join result,
+	// while inner streams may be filtered only inside an inner join
+
+	if (m_joinType != INNER_JOIN)
+		return m_args[0]->pushBloomFilter(join, stream);
+
+	for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
+	{
+		if (m_args[i]->pushBloomFilter(join, stream))
+			return true;
+	}
+
+	return false;
+}
+
 void NestedLoopJoin::invalidateRecords(Request* request) const
 {
 	for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
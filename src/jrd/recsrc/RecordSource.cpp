@@ -363,3 +363,19 @@ void RecordStream::nullRecords(thread_db* tdbb) const
 
 	record->fakeNulls();
 }
+
+bool RecordStream::setBloomFilter(const HashJoin* join, StreamType stream)
+{
+	// Only one join may filter the stream, the first (innermost) one wins
+
+	if (stream != m_stream || m_bloomFilter)
+		return false;
+
+	m_bloomFilter = join;
+	return true;
+}
+
+bool RecordStream::checkBloomFilter(thread_db* tdbb) const
+{
+	return !m_bloomFilter || m_bloomFilter->checkBloomFilter(tdbb);
+}
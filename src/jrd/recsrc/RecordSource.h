@@ -34,6 +34,11 @@
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 
+namespace Firebird
+{
+	class BloomFilter;
+}
+
 namespace Jrd
 {
 	class thread_db;
@@ -43,6 +48,7 @@ namespace Jrd
 	class BoolExprNode;
 	class DeclareLocalTableNode;
 	class Sort;
+	class PartitionedSort;
 	class CompilerScratch;
 	class BtrPageGCLock;
 	struct index_desc;
@@ -51,6 +57,8 @@ namespace Jrd
 	struct win;
 	class BaseBufferedStream;
 	class BufferedStream;
+	class HashJoin;
+	class HashGroupTable;
 	class PlanEntry;
 
 	enum JoinType { INNER_JOIN, OUTER_JOIN, SEMI_JOIN, ANTI_JOIN };
@@ -154,6 +162,20 @@ namespace Jrd
 			fb_assert(false);
 		}
 
+		// Pass the hash join's bloom filter down to the table scan of the given stream.
+		// Returns false if there is no such scan or it cannot be reached.
+		virtual bool pushBloomFilter(const HashJoin* /*join*/, StreamType /*stream*/)
+		{
+			return false;
+		}
+
+		// Count the remaining records of the opened stream at once, without fetching them.
+		// Returns false if this is not possible and records should be fetched as usual.
+		virtual bool countRecords(thread_db* /*tdbb*/, FB_UINT64& /*count*/) const
+		{
+			return false;
+		}
+
 		static bool rejectDuplicate(const UCHAR* /*data1*/, const UCHAR* /*data2*/, void* /*userArg*/)
 		{
 			return true;
@@ -218,8 +240,12 @@ namespace Jrd
 		void nullRecords(thread_db* tdbb) const override;
 
 	protected:
+		bool setBloomFilter(const HashJoin* join, StreamType stream);
+		bool checkBloomFilter(thread_db* tdbb) const;
+
 		const StreamType m_stream;
 		const Format* const m_format;
+		const HashJoin* m_bloomFilter = nullptr;
 	};
 
 
@@ -242,6 +268,13 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushBloomFilter(const HashJoin* join, StreamType stream) override
+		{
+			return setBloomFilter(join, stream);
+		}
+
+		bool countRecords(thread_db* tdbb, FB_UINT64& count) const override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -269,6 +302,11 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushBloomFilter(const HashJoin* join, StreamType stream) override
+		{
+			return setBloomFilter(join, stream);
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -311,6 +349,11 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushBloomFilter(const HashJoin* join, StreamType stream) override
+		{
+			return setBloomFilter(join, stream);
+		}
+
 		void setInversion(InversionNode* inversion, BoolExprNode* condition)
 		{
 			fb_assert(!m_inversion && !m_condition);
@@ -600,6 +643,8 @@ namespace Jrd
 			m_ansiNot = ansiNot;
 		}
 
+		bool pushBloomFilter(const HashJoin* join, StreamType stream) override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -616,6 +661,7 @@ namespace Jrd
 		bool m_ansiAny;
 		bool m_ansiAll;
 		bool m_ansiNot;
+		const HashJoin* m_bloomFilter = nullptr;
 	};
 
 	class PreFilteredStream : public FilteredStream
@@ -634,6 +680,7 @@ namespace Jrd
 		struct Impure : public RecordSource::Impure
 		{
 			Sort* irsb_sort;
+			PartitionedSort* irsb_merge;	// merges partitions sorted in parallel, if any
 		};
 
 	public:
@@ -748,7 +795,10 @@ namespace Jrd
 		bool internalGetRecord(thread_db* tdbb) const override;
 
 	private:
-		Sort* init(thread_db* tdbb) const;
+		void init(thread_db* tdbb, Impure* impure) const;
+		void putData(thread_db* tdbb, Request* request, UCHAR* data) const;
+		Sort* createSort(thread_db* tdbb) const;
+		static void releaseSort(Impure* impure);
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
@@ -873,6 +923,7 @@ namespace Jrd
 		void aggInit(thread_db* tdbb, Request* request, const MapNode* map) const;
 		bool aggPass(thread_db* tdbb, Request* request,
 			const NestValueArray& sourceList, const NestValueArray& targetList) const;
+		bool aggRetract(thread_db* tdbb, Request* request, const NestValueArray& sourceList) const;
 		void aggExecute(thread_db* tdbb, Request* request,
 			const NestValueArray& sourceList, const NestValueArray& targetList) const;
 		void aggFinish(thread_db* tdbb, Request* request, const MapNode* map) const;
@@ -930,6 +981,62 @@ namespace Jrd
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		bool countRecords(thread_db* tdbb) const;
+
+		bool m_countOnly;
+	};
+
+	class HashAggregatedStream final : public BaseAggWinStream<HashAggregatedStream, RecordSource>
+	{
+		class PartitionStack;
+
+	public:
+		struct Impure final : public BaseAggWinStream::Impure
+		{
+			HashGroupTable* groups;
+			PartitionStack* partitions;
+			ULONG position;
+			bool inputDone;
+		};
+
+	public:
+		HashAggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next);
+
+		static bool isSupported(thread_db* tdbb, CompilerScratch* csb,
+			NestValueArray& group, const MapNode* map);
+		static bool isWorthwhile(thread_db* tdbb, CompilerScratch* csb,
+			NestValueArray& group, double cardinality);
+
+	public:
+		void close(thread_db* tdbb) const override;
+
+		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+		Impure* getImpure(Request* request) const
+		{
+			return request->getImpure<Impure>(m_impure);
+		}
+
+	private:
+		ULONG computeKey(thread_db* tdbb, Request* request, UCHAR* keyBuffer) const;
+		bool aggregateInput(thread_db* tdbb, Request* request, Impure* impure) const;
+		void aggregateRecord(thread_db* tdbb, Request* request, Impure* impure,
+			ULONG level, RecordBuffer** spill) const;
+		void outputGroup(thread_db* tdbb, Request* request, Impure* impure, ULONG index) const;
+
+		Firebird::Array<const AggNode*> m_aggNodes;
+		Firebird::Array<ULONG> m_valueItems;
+		ULONG* m_keyLengths;
+		ULONG m_keyLength;
+		NestConst<BufferedStream> m_buffer;
 	};
 
 	class WindowedStream : public RecordSource
@@ -999,6 +1106,8 @@ namespace Jrd
 			void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
 			void nullRecords(thread_db* tdbb) const override;
 
+			static SINT64 getRetractCount(SINT64 lastStart, SINT64 lastEnd, SINT64 start, SINT64 end);
+
 		protected:
 			void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 			void internalOpen(thread_db* tdbb) const override;
@@ -1119,6 +1228,16 @@ namespace Jrd
 			return impure->irsb_position;
 		}
 
+		const Format* getFormat() const
+		{
+			return m_format;
+		}
+
+		// Copy the current records of the underlying streams into the buffer record
+		// and back, this allows callers to keep the records in their own buffers
+		void saveRecord(thread_db* tdbb, Record* buffer_record) const;
+		void restoreRecord(thread_db* tdbb, Record* buffer_record) const;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1152,6 +1271,8 @@ namespace Jrd
 		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
 		void nullRecords(thread_db* tdbb) const override;
 
+		bool pushBloomFilter(const HashJoin* join, StreamType stream) override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1196,6 +1317,7 @@ namespace Jrd
 	class HashJoin : public RecordSource
 	{
 		class HashTable;
+		class PartitionSet;
 
 		struct SubStream
 		{
@@ -1215,12 +1337,19 @@ namespace Jrd
 			HashTable* irsb_hash_table;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			bool irsb_leader_hashed;	// irsb_leader_hash is computed by checkBloomFilter()
+			PartitionSet* irsb_partitions;
+			ULONG irsb_partition;
+			FB_UINT64 irsb_leader_position;
+			Firebird::BloomFilter* irsb_bloom_filter;
+			ULONG irsb_bloom_checks;
+			ULONG irsb_bloom_rejects;
 		};
 
 	public:
 		HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 				 RecordSource* const* args, NestValueArray* const* keys,
-				 double selectivity = 0);
+				 double selectivity = 0, bool orderedLeader = false);
 
 		void close(thread_db* tdbb) const override;
 
@@ -1235,7 +1364,11 @@ namespace Jrd
 		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
 		void nullRecords(thread_db* tdbb) const override;
 
-		static unsigned maxCapacity();
+		bool pushBloomFilter(const HashJoin* join, StreamType stream) override;
+
+		bool checkBloomFilter(thread_db* tdbb) const;
+
+		static unsigned maxCapacity(thread_db* tdbb);
 
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
@@ -1246,9 +1379,66 @@ namespace Jrd
 		ULONG computeHash(thread_db* tdbb, Request* request,
 						  const SubStream& sub, UCHAR* buffer) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
+		bool fetchInnerRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream, ULONG position) const;
+
+		void partitionStreams(thread_db* tdbb, Impure* impure, FB_UINT64 buildSize) const;
+		bool loadPartition(thread_db* tdbb, Impure* impure) const;
+		bool fetchLeaderRecord(thread_db* tdbb, Impure* impure) const;
 
 		SubStream m_leader;
 		Firebird::Array<SubStream> m_args;
+		NestConst<BufferedStream> m_leaderBuffer;
+		const bool m_orderedLeader;		// leader order must be preserved, so never partition
+		bool m_bloomFilter = false;
+	};
+
+	// Inner join that chooses between nested loop and hash joining at runtime.
+	// Outer records are buffered until either the stream is exhausted or the
+	// threshold is reached, in the latter case the hash join is performed.
+
+	class AdaptiveJoin : public RecordSource
+	{
+		class OuterStream;
+
+		struct Impure : public RecordSource::Impure
+		{
+			RecordBuffer* irsb_buffer;
+			FB_UINT64 irsb_position;
+			const RecordSource* irsb_next;
+		};
+
+	public:
+		AdaptiveJoin(thread_db* tdbb, CompilerScratch* csb, RecordSource* outer,
+					 RecordSource* loopInner, RecordSource* hashInner,
+					 NestValueArray* const* keys, BoolExprNode* hashBoolean,
+					 double hashSelectivity, FB_UINT64 threshold, bool orderedOuter);
+
+		void close(thread_db* tdbb) const override;
+
+		bool refetchRecord(thread_db* tdbb) const override;
+		WriteLockResult lockRecord(thread_db* tdbb) const override;
+
+		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
+
+		void markRecursive() override;
+		void invalidateRecords(Request* request) const override;
+
+		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
+		void nullRecords(thread_db* tdbb) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		bool fetchOuter(thread_db* tdbb) const;
+
+		NestConst<RecordSource> m_outer;
+		NestConst<BufferedStream> m_outerBuffer;
+		NestConst<RecordSource> m_loopJoin;
+		NestConst<RecordSource> m_hashJoin;
+		const FB_UINT64 m_threshold;
 	};
 
 	class MergeJoin : public RecordSource
@@ -33,12 +33,228 @@
 #include "../jrd/mov_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/optimizer/Optimizer.h"
+#include "../common/Task.h"
+#include "../jrd/WorkerAttachment.h"
 
 #include "RecordSource.h"
 
 using namespace Firebird;
 using namespace Jrd;
 
+namespace
+{
+	// Flushes or finally sorts a number of sort partitions in parallel. Sorts do
+	// not access database pages, but spilling them to the temporary space needs
+	// the database context, so workers are bound to the worker attachments.
+	// The caller's attachment is used by the first worker.
+
+	class SortPartitionsTask : public Task
+	{
+	public:
+		enum Action { FLUSH, SORT };
+
+		SortPartitionsTask(thread_db* tdbb, MemoryPool* pool, const Array<Sort*>& partitions)
+			: Task(),
+			  m_pool(pool),
+			  m_dbb(tdbb->getDatabase()),
+			  m_partitions(partitions),
+			  m_items(*m_pool),
+			  m_action(FLUSH),
+			  m_next(0)
+		{
+			for (FB_SIZE_T i = 0; i < m_partitions.getCount(); i++)
+				m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+
+			m_items[0]->m_ownAttach = false;
+			m_items[0]->m_attStable = tdbb->getAttachment()->getStable();
+		}
+
+		virtual ~SortPartitionsTask()
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				delete *p;
+		}
+
+		class Item : public Task::WorkItem
+		{
+		public:
+			Item(SortPartitionsTask* task)
+				: Task::WorkItem(task),
+				  m_inuse(false),
+				  m_ownAttach(true),
+				  m_sort(nullptr)
+			{}
+
+			virtual ~Item()
+			{
+				if (!m_ownAttach || !m_attStable)
+					return;
+
+				{	// scope
+					AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+					if (!m_attStable->getHandle())
+						return;
+				}
+
+				FbLocalStatus status;
+				WorkerAttachment::releaseAttachment(&status, m_attStable);
+			}
+
+			SortPartitionsTask* getSortTask() const
+			{
+				return reinterpret_cast<SortPartitionsTask*>(m_task);
+			}
+
+			bool init(thread_db* tdbb)
+			{
+				FbStatusVector* const status = tdbb->tdbb_status_vector;
+
+				Attachment* att = nullptr;
+
+				if (m_ownAttach && !m_attStable.hasData())
+					m_attStable = WorkerAttachment::getAttachment(status, getSortTask()->m_dbb);
+
+				if (m_attStable)
+					att = m_attStable->getHandle();
+
+				if (!att)
+				{
+					Arg::Gds(isc_bad_db_handle).copyTo(status);
+					return false;
+				}
+
+				tdbb->setDatabase(att->att_database);
+				tdbb->setAttachment(att);
+
+				return true;
+			}
+
+			bool m_inuse;
+			bool m_ownAttach;
+			RefPtr<StableAttachmentPart> m_attStable;
+
+			// part of work: partition to flush or sort
+			Sort* m_sort;
+		};
+
+		bool handler(WorkItem& _item)
+		{
+			Item* const item = reinterpret_cast<Item*>(&_item);
+
+			ThreadContextHolder tdbb(NULL);
+
+			if (!item->init(tdbb))
+			{
+				setError(tdbb->tdbb_status_vector);
+				return false;
+			}
+
+			WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+			try
+			{
+				if (m_action == FLUSH)
+					item->m_sort->flush(tdbb);
+				else
+					item->m_sort->sort(tdbb);
+
+				return true;
+			}
+			catch (const Exception& ex)
+			{
+				ex.stuffException(tdbb->tdbb_status_vector);
+			}
+
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		bool getWorkItem(WorkItem** pItem)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			Item* item = reinterpret_cast<Item*>(*pItem);
+
+			if (!item)
+			{
+				for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				{
+					if (!(*p)->m_inuse)
+					{
+						(*p)->m_inuse = true;
+						*pItem = item = *p;
+						break;
+					}
+				}
+
+				if (!item)
+					return false;
+			}
+
+			if (!m_status.isSuccess() || m_next >= m_partitions.getCount())
+			{
+				item->m_inuse = false;
+				return false;
+			}
+
+			item->m_sort = m_partitions[m_next++];
+			return true;
+		}
+
+		bool getResult(IStatus* status)
+		{
+			if (status)
+			{
+				status->init();
+				status->setErrors(m_status.getErrors());
+			}
+
+			return m_status.isSuccess();
+		}
+
+		int getMaxWorkers()
+		{
+			return m_items.getCount();
+		}
+
+		// Handles all the partitions. Worker attachments are kept between runs.
+		void run(thread_db* tdbb, Coordinator& coordinator, Action action)
+		{
+			fb_assert(m_partitions.getCount() == m_items.getCount());
+
+			m_action = action;
+			m_next = 0;
+
+			{	// scope
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+				coordinator.runSync(this);
+			}
+
+			FbLocalStatus status;
+			if (!getResult(&status))
+				status.raise();
+		}
+
+	private:
+		void setError(FbStatusVector* status)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			if (m_status.isSuccess())
+				m_status.save(status);
+		}
+
+		MemoryPool* const m_pool;
+		Database* const m_dbb;
+		const Array<Sort*>& m_partitions;
+		HalfStaticArray<Item*, 8> m_items;
+		Action m_action;
+		FB_SIZE_T m_next;
+
+		Mutex m_mutex;
+		StatusHolder m_status;
+	};
+} // anonymous namespace
+
 // -----------------------------
 // Data access: external sorting
 // -----------------------------
@@ -64,12 +280,10 @@ void SortedStream::internalOpen(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open;
 
-	// Get rid of the old sort areas if this request has been used already.
-	// Null the pointer before calling init() because it may throw.
-	delete impure->irsb_sort;
-	impure->irsb_sort = nullptr;
+	// Get rid of the old sort areas if this request has been used already
+	releaseSort(impure);
 
-	impure->irsb_sort = init(tdbb);
+	init(tdbb, impure);
 }
 
 void SortedStream::close(thread_db* tdbb) const
@@ -84,8 +298,7 @@ void SortedStream::close(thread_db* tdbb) const
 	{
 		impure->irsb_flags &= ~irsb_open;
 
-		delete impure->irsb_sort;
-		impure->irsb_sort = nullptr;
+		releaseSort(impure);
 
 		m_next->close(tdbb);
 	}
@@ -179,108 +392,212 @@ void SortedStream::nullRecords(thread_db* tdbb) const
 	m_next->nullRecords(tdbb);
 }
 
-Sort* SortedStream::init(thread_db* tdbb) const
+Sort* SortedStream::createSort(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
 
-	m_next->open(tdbb);
-
 	// Initialize for sort. If this is really a project operation,
 	// establish a callback routine to reject duplicate records.
 
-	AutoPtr<Sort> scb(FB_NEW_POOL(request->req_sorts.getPool())
+	return FB_NEW_POOL(request->req_sorts.getPool())
 		Sort(tdbb->getDatabase(), &request->req_sorts,
 			 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
 			 m_map->keyItems.begin(),
-			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0));
-
-	// Pump the input stream dry while pushing records into sort. For
-	// each record, map all fields into the sort record. The reverse
-	// mapping is done in get_sort().
+			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0);
+}
 
-	dsc to, temp;
+void SortedStream::releaseSort(Impure* impure)
+{
+	// The first partition is the main sort itself
 
-	while (m_next->getRecord(tdbb))
+	if (impure->irsb_merge)
 	{
-		// "Put" a record to sort. Actually, get the address of a place
-		// to build a record.
+		for (FB_SIZE_T i = 1; i < impure->irsb_merge->getCount(); i++)
+			delete impure->irsb_merge->getPartition(i);
 
-		UCHAR* data = nullptr;
-		scb->put(tdbb, reinterpret_cast<ULONG**>(&data));
+		delete impure->irsb_merge;
+		impure->irsb_merge = nullptr;
+	}
 
-		// Zero out the sort key. This solves a multitude of problems.
+	delete impure->irsb_sort;
+	impure->irsb_sort = nullptr;
+}
 
-		memset(data, 0, m_map->length);
+void SortedStream::init(thread_db* tdbb, Impure* impure) const
+{
+	Database* const dbb = tdbb->getDatabase();
+	Request* const request = tdbb->getRequest();
 
-		// Loop thru all field (keys and hangers on) involved in the sort.
-		// Be careful to null field all unused bytes in the sort key.
+	m_next->open(tdbb);
 
-		const SortMap::Item* const end_item = m_map->items.begin() + m_map->items.getCount();
-		for (const SortMap::Item* item = m_map->items.begin(); item < end_item; item++)
-		{
-			to = item->desc;
-			to.dsc_address = data + (IPTR) to.dsc_address;
-			bool flag = false;
-			dsc* from = nullptr;
+	AutoPtr<Sort> scb(createSort(tdbb));
 
-			if (item->node)
-			{
-				from = EVL_expr(tdbb, request, item->node);
-				if (request->req_flags & req_null)
-					flag = true;
-			}
-			else
-			{
-				from = &temp;
+	// If parallel workers are allowed and the records do not fit the sort buffer,
+	// fill the buffers of a few partitions by turns. Once all of them are full,
+	// they are sorted and written to runs in parallel. At the end, partitions
+	// are sorted in parallel too and then merged together.
 
-				record_param* const rpb = &request->req_rpb[item->stream];
+	const FB_SIZE_T maxPartitions = MAX(tdbb->getAttachment()->att_parallel_workers, 1);
 
-				if (item->fieldId < 0)
+	Array<Sort*> partitions(*tdbb->getDefaultPool());
+	partitions.add(scb);
+
+	try
+	{
+		AutoPtr<Coordinator> coordinator;
+		AutoPtr<SortPartitionsTask> task;
+		Sort* current = scb;
+		FB_SIZE_T index = 0;
+
+		// Pump the input stream dry while pushing records into sort. For
+		// each record, map all fields into the sort record. The reverse
+		// mapping is done in mapData().
+
+		while (m_next->getRecord(tdbb))
+		{
+			if (maxPartitions > 1 && current->isBufferFull())
+			{
+				if (++index == partitions.getCount())
 				{
-					switch (item->fieldId)
+					if (index < maxPartitions)
+						partitions.add(createSort(tdbb));
+					else
 					{
-					case ID_TRANS:
-						*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
-						break;
-					case ID_DBKEY:
-						*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
-						break;
-					case ID_DBKEY_VALID:
-						*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
-						break;
-					default:
-						fb_assert(false);
+						if (!task)
+						{
+							coordinator = FB_NEW_POOL(*dbb->dbb_permanent) Coordinator(dbb->dbb_permanent);
+							task = FB_NEW_POOL(*tdbb->getDefaultPool())
+								SortPartitionsTask(tdbb, tdbb->getDefaultPool(), partitions);
+						}
+
+						task->run(tdbb, *coordinator, SortPartitionsTask::FLUSH);
+						index = 0;
 					}
-					continue;
 				}
 
-				if (!EVL_field(rpb->rpb_relation, rpb->rpb_record, item->fieldId, from))
-					flag = true;
+				current = partitions[index];
 			}
 
-			*(data + item->flagOffset) = flag ? TRUE : FALSE;
+			// "Put" a record to sort. Actually, get the address of a place
+			// to build a record.
 
-			if (!flag)
-			{
-				// If an INTL string is moved into the key portion of the sort record,
-				// then we want to sort by language dependent order
+			UCHAR* data = nullptr;
+			current->put(tdbb, reinterpret_cast<ULONG**>(&data));
 
-				if (IS_INTL_DATA(&item->desc) && isKey(&item->desc))
-				{
-					INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&item->desc), from, &to,
-						(m_map->flags & FLAG_UNIQUE ? INTL_KEY_UNIQUE : INTL_KEY_SORT));
-				}
-				else
+			putData(tdbb, request, data);
+		}
+
+		if (partitions.getCount() == 1)
+		{
+			scb->sort(tdbb);
+			impure->irsb_sort = scb.release();
+			return;
+		}
+
+		if (!task)
+		{
+			coordinator = FB_NEW_POOL(*dbb->dbb_permanent) Coordinator(dbb->dbb_permanent);
+			task = FB_NEW_POOL(*tdbb->getDefaultPool())
+				SortPartitionsTask(tdbb, tdbb->getDefaultPool(), partitions);
+		}
+
+		task->run(tdbb, *coordinator, SortPartitionsTask::SORT);
+
+		AutoPtr<PartitionedSort> merge(FB_NEW_POOL(request->req_sorts.getPool())
+			PartitionedSort(dbb, &request->req_sorts));
+
+		for (const auto partition : partitions)
+			merge->addPartition(partition);
+
+		merge->buildMergeTree();
+
+		impure->irsb_merge = merge.release();
+		impure->irsb_sort = scb.release();
+	}
+	catch (const Exception&)
+	{
+		if (!impure->irsb_sort)
+		{
+			for (FB_SIZE_T i = 1; i < partitions.getCount(); i++)
+				delete partitions[i];
+		}
+
+		throw;
+	}
+}
+
+void SortedStream::putData(thread_db* tdbb, Request* request, UCHAR* data) const
+{
+	dsc to, temp;
+
+	// Zero out the sort key. This solves a multitude of problems.
+
+	memset(data, 0, m_map->length);
+
+	// Loop thru all field (keys and hangers on) involved in the sort.
+	// Be careful to null field all unused bytes in the sort key.
+
+	const SortMap::Item* const end_item = m_map->items.begin() + m_map->items.getCount();
+	for (const SortMap::Item* item = m_map->items.begin(); item < end_item; item++)
+	{
+		to = item->desc;
+		to.dsc_address = data + (IPTR) to.dsc_address;
+		bool flag = false;
+		dsc* from = nullptr;
+
+		if (item->node)
+		{
+			from = EVL_expr(tdbb, request, item->node);
+			if (request->req_flags & req_null)
+				flag = true;
+		}
+		else
+		{
+			from = &temp;
+
+			record_param* const rpb = &request->req_rpb[item->stream];
+
+			if (item->fieldId < 0)
+			{
+				switch (item->fieldId)
 				{
-					MOV_move(tdbb, from, &to);
+				case ID_TRANS:
+					*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
+					break;
+				case ID_DBKEY:
+					*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
+					break;
+				case ID_DBKEY_VALID:
+					*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
+					break;
+				default:
+					fb_assert(false);
 				}
+				continue;
 			}
+
+			if (!EVL_field(rpb->rpb_relation, rpb->rpb_record, item->fieldId, from))
+				flag = true;
 		}
-	}
 
-	scb->sort(tdbb);
+		*(data + item->flagOffset) = flag ? TRUE : FALSE;
 
-	return scb.release();
+		if (!flag)
+		{
+			// If an INTL string is moved into the key portion of the sort record,
+			// then we want to sort by language dependent order
+
+			if (IS_INTL_DATA(&item->desc) && isKey(&item->desc))
+			{
+				INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&item->desc), from, &to,
+					(m_map->flags & FLAG_UNIQUE ? INTL_KEY_UNIQUE : INTL_KEY_SORT));
+			}
+			else
+			{
+				MOV_move(tdbb, from, &to);
+			}
+		}
+	}
 }
 
 bool SortedStream::compareKeys(const UCHAR* p, const UCHAR* q) const
@@ -330,7 +647,11 @@ UCHAR* SortedStream::getData(thread_db* tdbb) const
 	Impure* const impure = request->getImpure<Impure>(m_impure);
 
 	ULONG* data = nullptr;
-	impure->irsb_sort->get(tdbb, &data);
+
+	if (impure->irsb_merge)
+		impure->irsb_merge->get(tdbb, &data);
+	else
+		impure->irsb_sort->get(tdbb, &data);
 
 	return reinterpret_cast<UCHAR*>(data);
 }
@@ -801,10 +801,31 @@ bool WindowedStream::WindowStream::internalGetRecord(thread_db* tdbb) const
 			//
 			// This may be incompatible with some function like LIST, but currently LIST cannot
 			// be used in ordered windows anyway.
+			//
+			// If the window slides forward, the records leaving it are retracted from the
+			// aggregates, so moving frames are evaluated in linear time. This is not done
+			// if some aggregate cannot be reverted or if restarting the aggregation is cheaper.
+
+			SINT64 leaving = !lastWindow.isValid() ? -1 :
+				getRetractCount(lastWindow.startPosition, lastWindow.endPosition,
+					impure->windowBlock.startPosition, impure->windowBlock.endPosition);
+
+			bool reuse = (leaving >= 0);
 
-			if (!lastWindow.isValid() ||
-				impure->windowBlock.startPosition > lastWindow.startPosition ||
-				impure->windowBlock.endPosition < lastWindow.endPosition)
+			if (leaving > 0)
+			{
+				m_next->locate(tdbb, lastWindow.startPosition);
+
+				while (reuse && leaving-- > 0)
+				{
+					if (!m_next->getRecord(tdbb))
+						fb_assert(false);
+
+					reuse = aggRetract(tdbb, request, m_aggSources);
+				}
+			}
+
+			if (!reuse)
 			{
 				aggInit(tdbb, request, m_windowMap);
 				m_next->locate(tdbb, impure->windowBlock.startPosition);
@@ -938,6 +959,28 @@ void WindowedStream::WindowStream::nullRecords(thread_db* tdbb) const
 	m_next->nullRecords(tdbb);
 }
 
+// Number of records leaving the last window, which should be retracted from its aggregation
+// to reuse it for the new window. Records entering the window are passed by the caller.
+// Negative value means the aggregation should be restarted: the new window does not
+// overlap the last one, its end moved backward or retracting is more expensive
+// than aggregating the new window from scratch.
+SINT64 WindowedStream::WindowStream::getRetractCount(SINT64 lastStart, SINT64 lastEnd,
+	SINT64 start, SINT64 end)
+{
+	if (end < lastEnd)
+		return -1;
+
+	if (start <= lastStart)
+		return 0;
+
+	const SINT64 leaving = start - lastStart;
+
+	if (start > lastEnd || leaving > end - start)
+		return -1;
+
+	return leaving;
+}
+
 void WindowedStream::WindowStream::getFrameValue(thread_db* tdbb, Request* request,
 	const Frame* frame, impure_value_ex* impureValue) const
 {
@@ -101,6 +101,7 @@ RELATION(nam_indices, rel_indices, ODS_8_0, rel_persistent)
 	FIELD(f_idx_statistics, nam_statistics, fld_statistics, 1, ODS_8_0)
 	FIELD(f_idx_cond_blr, nam_cond_blr, fld_value, 1, ODS_13_1)
 	FIELD(f_idx_cond_source, nam_cond_source, fld_source, 1, ODS_13_1)
+	FIELD(f_idx_histogram, nam_histogram, fld_blob, 1, ODS_13_3)
 END_RELATION
 
 // Relation 5 (RDB$RELATION_FIELDS)
@@ -501,6 +502,9 @@ RELATION(nam_mon_database, rel_mon_database, ODS_11_1, rel_virtual)
 	FIELD(f_mon_db_na, nam_mon_na, fld_att_id, 0, ODS_13_0)
 	FIELD(f_mon_db_ns, nam_mon_ns, fld_stmt_id, 0, ODS_13_0)
 	FIELD(f_mon_db_repl_mode, nam_mon_repl_mode, fld_repl_mode, 0, ODS_13_0)
+	FIELD(f_mon_db_page_bufs_memory, nam_mon_page_bufs_memory, fld_short_description, 0, ODS_13_3)
+	FIELD(f_mon_db_gc_backlog, nam_mon_gc_backlog, fld_counter, 0, ODS_13_3)
+	FIELD(f_mon_db_gc_processed, nam_mon_gc_processed, fld_counter, 0, ODS_13_3)
 END_RELATION
 
 // Relation 34 (MON$ATTACHMENTS)
@@ -533,6 +537,8 @@ RELATION(nam_mon_attachments, rel_mon_attachments, ODS_11_1, rel_virtual)
 	FIELD(f_mon_att_remote_crypt, nam_wire_crypt_plugin, fld_remote_crypt, 0, ODS_13_0)
 	FIELD(f_mon_att_session_tz, nam_mon_session_tz, fld_tz_name, 0, ODS_13_1)
 	FIELD(f_mon_att_par_workers, nam_par_workers, fld_par_workers, 0, ODS_13_1)
+	FIELD(f_mon_att_stmt_cache_hits, nam_mon_stmt_cache_hits, fld_counter, 0, ODS_13_3)
+	FIELD(f_mon_att_stmt_cache_misses, nam_mon_stmt_cache_misses, fld_counter, 0, ODS_13_3)
 END_RELATION
 
 // Relation 35 (MON$TRANSACTIONS)
@@ -565,6 +571,9 @@ RELATION(nam_mon_statements, rel_mon_statements, ODS_11_1, rel_virtual)
 	FIELD(f_mon_stmt_timeout, nam_stmt_timeout, fld_stmt_timeout, 0, ODS_13_0)
 	FIELD(f_mon_stmt_timer, nam_stmt_timer, fld_stmt_timer, 0, ODS_13_0)
 	FIELD(f_mon_stmt_cmp_stmt_id, nam_mon_cmp_stmt_id, fld_stmt_id, 0, ODS_13_1)
+	FIELD(f_mon_stmt_temp_cache, nam_mon_temp_cache, fld_counter, 0, ODS_13_3)
+	FIELD(f_mon_stmt_max_temp_cache, nam_mon_max_temp_cache, fld_counter, 0, ODS_13_3)
+	FIELD(f_mon_stmt_temp_file, nam_mon_temp_file, fld_counter, 0, ODS_13_3)
 END_RELATION
 
 // Relation 37 (MON$CALL_STACK)
@@ -590,6 +599,8 @@ RELATION(nam_mon_io_stats, rel_mon_io_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_io_page_writes, nam_mon_page_writes, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_fetches, nam_mon_page_fetches, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_marks, nam_mon_page_marks, fld_counter, 0, ODS_11_1)
+	FIELD(f_mon_io_page_hot_hits, nam_mon_page_hot_hits, fld_counter, 0, ODS_13_3)
+	FIELD(f_mon_io_page_cold_hits, nam_mon_page_cold_hits, fld_counter, 0, ODS_13_3)
 END_RELATION
 
 // Relation 39 (MON$RECORD_STATS)
@@ -305,6 +305,13 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 
 	tdbb->tdbb_flags |= TDBB_replicator;
 
+	UCharBuffer unpacked;
+	if (decompressBlock(length, data, unpacked))
+	{
+		length = unpacked.getCount();
+		data = unpacked.begin();
+	}
+
 	BlockReader reader(length, data);
 
 	const auto traNum = reader.getTransactionId();
@@ -56,8 +56,12 @@ namespace
 	const ULONG DEFAULT_SEGMENT_COUNT = 8;
 	const ULONG DEFAULT_ARCHIVE_TIMEOUT = 60;				// seconds
 	const ULONG DEFAULT_GROUP_FLUSH_DELAY = 0;
+	const ULONG DEFAULT_COMPRESSION_LEVEL = 0;
+	const ULONG MAX_COMPRESSION_LEVEL = 9;
 	const ULONG DEFAULT_APPLY_IDLE_TIMEOUT = 10;				// seconds
 	const ULONG DEFAULT_APPLY_ERROR_TIMEOUT = 60;				// seconds
+	const ULONG DEFAULT_APPLY_WORKERS = 1;
+	const ULONG MAX_APPLY_WORKERS = 64;
 
 	void parseLong(const string& input, ULONG& output)
 	{
@@ -114,6 +118,7 @@ Config::Config()
 	  journalDirectory(getPool()),
 	  filePrefix(getPool()),
 	  groupFlushDelay(DEFAULT_GROUP_FLUSH_DELAY),
+	  compressionLevel(DEFAULT_COMPRESSION_LEVEL),
 	  archiveDirectory(getPool()),
 	  archiveCommand(getPool()),
 	  archiveTimeout(DEFAULT_ARCHIVE_TIMEOUT),
@@ -122,6 +127,7 @@ Config::Config()
 	  verboseLogging(false),
 	  applyIdleTimeout(DEFAULT_APPLY_IDLE_TIMEOUT),
 	  applyErrorTimeout(DEFAULT_APPLY_ERROR_TIMEOUT),
+	  applyWorkers(DEFAULT_APPLY_WORKERS),
 	  pluginName(getPool()),
 	  logErrors(true),
 	  reportErrors(false),
@@ -140,6 +146,7 @@ Config::Config(const Config& other)
 	  journalDirectory(getPool(), other.journalDirectory),
 	  filePrefix(getPool(), other.filePrefix),
 	  groupFlushDelay(other.groupFlushDelay),
+	  compressionLevel(other.compressionLevel),
 	  archiveDirectory(getPool(), other.archiveDirectory),
 	  archiveCommand(getPool(), other.archiveCommand),
 	  archiveTimeout(other.archiveTimeout),
@@ -148,6 +155,7 @@ Config::Config(const Config& other)
 	  verboseLogging(other.verboseLogging),
 	  applyIdleTimeout(other.applyIdleTimeout),
 	  applyErrorTimeout(other.applyErrorTimeout),
+	  applyWorkers(other.applyWorkers),
 	  pluginName(getPool(), other.pluginName),
 	  logErrors(other.logErrors),
 	  reportErrors(other.reportErrors),
@@ -254,6 +262,13 @@ Config* Config::get(const PathName& lookupName)
 				{
 					parseLong(value, config->groupFlushDelay);
 				}
+				else if (key == "compression_level")
+				{
+					parseLong(value, config->compressionLevel);
+
+					if (config->compressionLevel > MAX_COMPRESSION_LEVEL)
+						configError("invalid value (expected 0 to 9)", key, value);
+				}
 				else if (key == "journal_archive_directory")
 				{
 					config->archiveDirectory = value.c_str();
@@ -405,6 +420,13 @@ void Config::enumerate(ReplicaList& replicas)
 				{
 					parseLong(value, config->applyErrorTimeout);
 				}
+				else if (key == "apply_workers")
+				{
+					parseLong(value, config->applyWorkers);
+
+					if (!config->applyWorkers || config->applyWorkers > MAX_APPLY_WORKERS)
+						configError("invalid value (expected 1 to 64)", key, value);
+				}
 			}
 
 			if (dbName.hasData() && config->sourceDirectory.hasData())
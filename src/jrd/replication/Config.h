@@ -52,6 +52,7 @@ namespace Replication
 		Firebird::PathName journalDirectory;
 		Firebird::PathName filePrefix;
 		ULONG groupFlushDelay;
+		ULONG compressionLevel;
 		Firebird::PathName archiveDirectory;
 		Firebird::string archiveCommand;
 		ULONG archiveTimeout;
@@ -61,6 +62,7 @@ namespace Replication
 		bool verboseLogging;
 		ULONG applyIdleTimeout;
 		ULONG applyErrorTimeout;
+		ULONG applyWorkers;
 		Firebird::string pluginName;
 		bool logErrors;
 		bool reportErrors;
@@ -102,6 +102,7 @@ Manager::Manager(const string& dbId,
 	  m_buffers(getPool()),
 	  m_queue(getPool()),
 	  m_queueSize(0),
+	  m_packBuffer(getPool()),
 	  m_shutdown(false),
 	  m_signalled(false)
 {
@@ -281,6 +282,9 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 				fb_assert(length);
 				bool hasData = true;
 
+				const UCHAR* packed = nullptr;
+				ULONG packedLength = 0;
+
 				if (m_changeLog)
 				{
 					if (prepareBuffer == buffer)
@@ -296,7 +300,10 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 
 					if (hasData)
 					{
-						const auto sequence = m_changeLog->write(length, buffer->begin(), sync);
+						packedLength = length;
+						packed = pack(packedLength, buffer->begin());
+
+						const auto sequence = m_changeLog->write(packedLength, packed, sync);
 
 						if (sequence != m_sequence)
 						{
@@ -310,13 +317,20 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 						const auto block = (Block*) buffer->begin();
 						block->length += sizeof(UCHAR);
 						length += sizeof(UCHAR);
+						packed = nullptr;
 					}
 				}
 
+				if (m_replicas.hasData() && !packed)
+				{
+					packedLength = length;
+					packed = pack(packedLength, buffer->begin());
+				}
+
 				for (auto iter : m_replicas)
 				{
 					if (iter->status.isSuccess())
-						iter->replicator->process(&iter->status, length, buffer->begin());
+						iter->replicator->process(&iter->status, packedLength, packed);
 				}
 
 				m_queueSize -= length;
@@ -359,13 +373,16 @@ void Manager::bgWriter()
 					const auto length = (ULONG) buffer->getCount();
 					fb_assert(length);
 
+					ULONG packedLength = length;
+					const auto packed = pack(packedLength, buffer->begin());
+
 					if (m_changeLog)
-						m_changeLog->write(length, buffer->begin(), false);
+						m_changeLog->write(packedLength, packed, false);
 
 					for (auto iter : m_replicas)
 					{
 						if (iter->status.isSuccess())
-							iter->replicator->process(&iter->status, length, buffer->begin());
+							iter->replicator->process(&iter->status, packedLength, packed);
 					}
 
 					m_queueSize -= length;
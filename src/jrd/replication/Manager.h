@@ -33,6 +33,7 @@
 
 #include "Config.h"
 #include "ChangeLog.h"
+#include "Utils.h"
 
 namespace Replication
 {
@@ -91,6 +92,18 @@ namespace Replication
 	private:
 		void bgWriter();
 
+		// Returns either the original block or its compressed copy
+		const UCHAR* pack(ULONG& length, const UCHAR* data)
+		{
+			if (compressBlock(m_config->compressionLevel, length, data, m_packBuffer))
+			{
+				length = (ULONG) m_packBuffer.getCount();
+				return m_packBuffer.begin();
+			}
+
+			return data;
+		}
+
 		static THREAD_ENTRY_DECLARE writer_thread(THREAD_ENTRY_PARAM arg)
 		{
 			Manager* const mgr = static_cast<Manager*>(arg);
@@ -110,6 +123,7 @@ namespace Replication
 		Firebird::Mutex m_queueMutex;
 		ULONG m_queueSize;
 		FB_UINT64 m_sequence;
+		Firebird::UCharBuffer m_packBuffer;		// protected by m_queueMutex
 
 		volatile bool m_shutdown;
 		volatile bool m_signalled;
@@ -29,8 +29,11 @@
 #include "../common/ScanDir.h"
 #include "../common/os/mod_loader.h"
 #include "../common/os/path_utils.h"
+#include "../common/classes/zip.h"
+#include "../common/classes/init.h"
 #include "../jrd/constants.h"
 
+#include "Protocol.h"
 #include "Utils.h"
 
 #ifdef HAVE_UNISTD_H
@@ -71,6 +74,13 @@ namespace
 
 	const char* REPLICATION_LOGFILE = "replication.log";
 
+	// Blocks with less data are not worth compressing
+	const ULONG MIN_COMPRESS_LENGTH = 256;
+
+#ifdef HAVE_ZLIB_H
+	InitInstance<ZLib> zlib;
+#endif
+
 	class LogWriter : private GlobalStorage
 	{
 	public:
@@ -256,6 +266,118 @@ namespace Replication
 #endif
 	}
 
+	// Compress the replication block. Compressed block has BLOCK_COMPRESSED flag set
+	// and its data starts with the original data length followed by zlib stream.
+	// Returns false (and leaves output untouched) if compression is unavailable
+	// or useless for the given block.
+
+	bool compressBlock(int level, ULONG length, const UCHAR* data, UCharBuffer& output)
+	{
+		fb_assert(length >= sizeof(Block));
+
+		const auto header = (const Block*) data;
+		const ULONG dataLength = header->length;
+
+		if (!level || dataLength < MIN_COMPRESS_LENGTH || (header->flags & BLOCK_COMPRESSED))
+			return false;
+
+#ifdef HAVE_ZLIB_H
+		if (!zlib())
+			return false;
+
+		const ULONG prefix = sizeof(Block) + sizeof(ULONG);
+		UCHAR* const buffer = output.getBuffer(prefix + dataLength);
+
+		z_stream strm;
+		strm.zalloc = ZLib::allocFunc;
+		strm.zfree = ZLib::freeFunc;
+		strm.opaque = Z_NULL;
+
+		if (zlib().deflateInit(&strm, level) != Z_OK)
+			return false;
+
+		strm.next_in = const_cast<UCHAR*>(data + sizeof(Block));
+		strm.avail_in = dataLength;
+		strm.next_out = buffer + prefix;
+		strm.avail_out = dataLength;
+
+		// Z_STREAM_END is returned only if the whole block was packed in less space
+		const int ret = zlib().deflate(&strm, Z_FINISH);
+		const ULONG packedLength = (ULONG) strm.total_out;
+		zlib().deflateEnd(&strm);
+
+		if (ret != Z_STREAM_END || packedLength + sizeof(ULONG) >= dataLength)
+			return false;
+
+		Block newHeader = *header;
+		newHeader.flags |= BLOCK_COMPRESSED;
+		newHeader.length = sizeof(ULONG) + packedLength;
+
+		memcpy(buffer, &newHeader, sizeof(Block));
+		memcpy(buffer + sizeof(Block), &dataLength, sizeof(ULONG));
+		output.shrink(prefix + packedLength);
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Restore the original block if it's compressed, otherwise return false
+
+	bool decompressBlock(ULONG length, const UCHAR* data, UCharBuffer& output)
+	{
+		fb_assert(length >= sizeof(Block));
+
+		const auto header = (const Block*) data;
+
+		if (!(header->flags & BLOCK_COMPRESSED))
+			return false;
+
+		if (header->length < sizeof(ULONG) || sizeof(Block) + header->length > length)
+			raiseError("Replication block is malformed");
+
+#ifdef HAVE_ZLIB_H
+		if (!zlib())
+			raiseError("Compressed replication block cannot be processed, zlib library is not loaded");
+
+		ULONG dataLength;
+		memcpy(&dataLength, data + sizeof(Block), sizeof(ULONG));
+
+		UCHAR* const buffer = output.getBuffer(sizeof(Block) + dataLength);
+
+		z_stream strm;
+		strm.zalloc = ZLib::allocFunc;
+		strm.zfree = ZLib::freeFunc;
+		strm.opaque = Z_NULL;
+		strm.next_in = const_cast<UCHAR*>(data + sizeof(Block) + sizeof(ULONG));
+		strm.avail_in = header->length - sizeof(ULONG);
+
+		if (zlib().inflateInit(&strm) != Z_OK)
+			raiseError("Replication block decompression failed");
+
+		strm.next_out = buffer + sizeof(Block);
+		strm.avail_out = dataLength;
+
+		const int ret = zlib().inflate(&strm, Z_FINISH);
+		const ULONG unpackedLength = (ULONG) strm.total_out;
+		zlib().inflateEnd(&strm);
+
+		if (ret != Z_STREAM_END || unpackedLength != dataLength)
+			raiseError("Replication block decompression failed (error %d)", ret);
+
+		Block newHeader = *header;
+		newHeader.flags &= ~BLOCK_COMPRESSED;
+		newHeader.length = dataLength;
+		memcpy(buffer, &newHeader, sizeof(Block));
+
+		return true;
+#else
+		raiseError("Compressed replication block cannot be processed, zlib support is not built in");
+		return false;
+#endif
+	}
+
 	void logPrimaryError(const PathName& database, const string& message)
 	{
 		logMessage(PRIMARY_SIDE, ERROR_MSG, database, message);
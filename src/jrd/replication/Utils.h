@@ -25,6 +25,7 @@
 #define JRD_REPLICATION_UTILS_H
 
 #include "../common/classes/fb_string.h"
+#include "../common/classes/array.h"
 
 #ifdef WIN_NT
 #include <io.h>
@@ -50,6 +51,9 @@ namespace Replication
 	void raiseError(const char* msg, ...);
 	int executeShell(const Firebird::string& command);
 
+	bool compressBlock(int level, ULONG length, const UCHAR* data, Firebird::UCharBuffer& output);
+	bool decompressBlock(ULONG length, const UCHAR* data, Firebird::UCharBuffer& output);
+
 	void logPrimaryError(const Firebird::PathName& database,
 						 const Firebird::string& message);
 
@@ -49,6 +49,7 @@ class jrd_prc;
 class ValueListNode;
 class jrd_tra;
 class Savepoint;
+class BulkIndexKeys;
 class Cursor;
 class thread_db;
 
@@ -119,6 +120,7 @@ const USHORT rpb_gc_active		= 256;		// garbage collecting dead record version
 const USHORT rpb_uk_modified	= 512;		// record key field values are changed
 const USHORT rpb_long_tranum	= 1024;		// transaction number is 64-bit
 const USHORT rpb_not_packed		= 2048;		// record (or delta) is stored "as is"
+const USHORT rpb_lz_packed		= 4096;		// record (or delta) is LZ-style encoded
 
 // Stream flags
 
@@ -419,6 +421,10 @@ public:
 	RuntimeStatistics	req_base_stats;
 	AffectedRows req_records_affected;	// records affected by the last statement
 	FB_UINT64 req_profiler_ticks;		// profiler ticks
+	// Temp space usage is updated by the parallel workers too, see TempSpace
+	std::atomic<FB_UINT64> req_temp_cache_usage = 0;	// temp space memory used by the request
+	std::atomic<FB_UINT64> req_temp_cache_peak = 0;		// maximum temp space memory used by the current execution
+	std::atomic<FB_UINT64> req_temp_file_usage = 0;		// temp space spilled to disk by the request
 
 	const StmtNode*	req_next;			// next node for execution
 	EDS::Statement*	req_ext_stmt;		// head of list of active dynamic statements
@@ -450,6 +456,7 @@ public:
 	SnapshotData req_snapshot;
 	StatusXcp req_last_xcp;			// last known exception
 	bool req_batch_mode;
+	BulkIndexKeys* req_bulk_keys = nullptr;	// non-unique index keys deferred by batch
 
 	enum req_s {
 		req_evaluate,
@@ -359,24 +359,9 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		// Check that we are not at the beginning of the buffer in addition
 		// to checking for space for the record. This avoids the pointer
 		// record from underflowing in the second condition.
-		if ((UCHAR*) record < m_memory + m_longs ||
-			(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1))
+		if (isBufferFull())
 		{
-			putRun(tdbb);
-			while (true)
-			{
-				run_control* run = m_runs;
-				const USHORT depth = run->run_depth;
-				if (depth == MAX_MERGE_LEVEL)
-					break;
-				USHORT count = 1;
-				while ((run = run->run_next) && run->run_depth == depth)
-					count++;
-				if (count < RUN_GROUP)
-					break;
-				mergeRuns(count);
-			}
-			init();
+			writeBuffer(tdbb);
 			record = m_last_record;
 		}
 
@@ -405,6 +390,53 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 }
 
 
+void Sort::flush(thread_db* tdbb)
+{
+/**************************************
+ *
+ * Sort the records collected so far and write them
+ * to a run, so the buffer can be filled again.
+ * Used when the buffers of several sorts are filled by turns
+ * and then flushed in parallel.
+ *
+ **************************************/
+	try
+	{
+		if (m_last_record == (SR*) m_end_memory)
+			return;
+
+		diddleKey((UCHAR*) KEYOF(m_last_record), true, false);
+
+		writeBuffer(tdbb);
+	}
+	catch (const BadAlloc&)
+	{
+		Firebird::Arg::Gds(isc_sort_mem_err).raise();
+	}
+	catch (const status_exception& ex)
+	{
+		Firebird::Arg::Gds status(isc_sort_err);
+		status.append(Firebird::Arg::StatusVector(ex.value()));
+		status.raise();
+	}
+}
+
+
+bool Sort::isBufferFull() const
+{
+/**************************************
+ *
+ * Check whether the next record cannot be put into the
+ * buffer without writing the buffer contents to a run.
+ *
+ **************************************/
+	const SR* const record = m_last_record;
+
+	return ((UCHAR*) record < m_memory + m_longs ||
+		(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1));
+}
+
+
 void Sort::sort(thread_db* tdbb)
 {
 /**************************************
@@ -1955,7 +1987,7 @@ void Sort::orderAndSave(thread_db* tdbb)
  * scratch file as one big chunk
  *
  **************************************/
-	EngineCheckout cout(tdbb, FB_FUNCTION);
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
 	run_control* run = m_runs;
 	run->run_records = 0;
@@ -2041,6 +2073,34 @@ void Sort::putRun(thread_db* tdbb)
 }
 
 
+void Sort::writeBuffer(thread_db* tdbb)
+{
+/**************************************
+ *
+ * Write the buffer to a run, merge the runs of the same depth if
+ * there are enough of them, and set up to receive the next record.
+ *
+ **************************************/
+	putRun(tdbb);
+
+	while (true)
+	{
+		run_control* run = m_runs;
+		const USHORT depth = run->run_depth;
+		if (depth == MAX_MERGE_LEVEL)
+			break;
+		USHORT count = 1;
+		while ((run = run->run_next) && run->run_depth == depth)
+			count++;
+		if (count < RUN_GROUP)
+			break;
+		mergeRuns(count);
+	}
+
+	init();
+}
+
+
 void Sort::sortBuffer(thread_db* tdbb)
 {
 /**************************************
@@ -2051,7 +2111,7 @@ void Sort::sortBuffer(thread_db* tdbb)
  * been requested, detect and handle them.
  *
  **************************************/
-	EngineCheckout cout(tdbb, FB_FUNCTION);
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
 	// First, insert a pointer to the high key
 
@@ -2398,7 +2458,7 @@ sort_record* PartitionedSort::getMerge()
 		if (l == 0 && aSort->m_dup_callback)
 		{
 			UCHAR* rec_a = (UCHAR*)merge->mrg_record_a;
-			UCHAR* rec_b = (UCHAR*)merge->mrg_record_a;
+			UCHAR* rec_b = (UCHAR*)merge->mrg_record_b;
 
 			aSort->diddleKey(rec_a, false, true);
 			aSort->diddleKey(rec_b, false, true);
@@ -285,12 +285,15 @@ public:
 	void get(Jrd::thread_db*, ULONG**);
 	void put(Jrd::thread_db*, ULONG**);
 	void sort(Jrd::thread_db*);
+	void flush(Jrd::thread_db*);
 
 	bool isSorted() const
 	{
 		return m_flags & scb_sorted;
 	}
 
+	bool isBufferFull() const;
+
 	static FB_UINT64 readBlock(TempSpace* space, FB_UINT64 seek, UCHAR* address, ULONG length)
 	{
 		const size_t bytes = space->read(seek, address, length);
@@ -318,6 +321,7 @@ private:
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
 	void putRun(Jrd::thread_db*);
+	void writeBuffer(Jrd::thread_db*);
 	void sortBuffer(Jrd::thread_db*);
 	void sortRunsBySeek(int);
 
@@ -374,6 +378,16 @@ public:
 		m_parts.add(item);
 	}
 
+	FB_SIZE_T getCount() const
+	{
+		return m_parts.getCount();
+	}
+
+	Sort* getPartition(FB_SIZE_T n) const
+	{
+		return m_parts[n].srt_sort;
+	}
+
 	void buildMergeTree();
 
 private:
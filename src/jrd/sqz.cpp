@@ -47,6 +47,22 @@ using namespace Jrd;
 // they do not compress much but increase total number of runs thus affecting decompression speed.
 // Starting from Firebird v5, we don't compress runs shorter than 8 bytes. But this rule is not
 // set in stone, so let's not use lenghts between 4 and 7 bytes as some other special markers.
+//
+// Starting with ODS 13.3, the string may be LZ-style encoded instead, where repeating byte
+// sequences are replaced with back-references into the already unpacked part of the string.
+// Such strings are marked with a separate record header flag (rhd_lz_packed), older engines
+// refuse to open the database and thus never misinterpret them:
+//
+// positive length [1 .. 127] - up to 127 following bytes are copied "as is"
+// negative length [-1 .. -127] - {length, two-byte distance}, copy (3 - length) bytes
+//								  located at the given distance back in the output
+// negative length -128 - {-128, two-byte length, two-byte distance}, the same for longer copies
+// zero length bytes are padding, as above
+//
+// Byte runs are just references with distance 1, so this encoding is usually not worse
+// than RLE. However, it costs more CPU to pack, so it's used only if explicitly enabled
+// (LZRecordCompression setting) and only if the result is shorter than the RLE one.
+// Record fragments are always RLE encoded.
 
 namespace
 {
@@ -63,6 +79,43 @@ namespace
 		return (length <= MAX_SHORT_RUN) ? 0 :
 			(length <= MAX_MEDIUM_RUN) ? sizeof(USHORT) : sizeof(ULONG);
 	}
+
+	const unsigned MIN_LZ_LENGTH = 32;			// don't bother with shorter strings
+
+	const unsigned MIN_MATCH = 5;				// shorter copies do not save anything
+	const unsigned MAX_SHORT_MATCH = 3 + 127;	// 130
+	const unsigned MAX_LONG_MATCH = MAX_USHORT;
+	const unsigned MAX_DISTANCE = MAX_USHORT;
+
+	const unsigned HASH_BITS = 12;
+	const unsigned HASH_SIZE = 1 << HASH_BITS;
+
+	inline unsigned hashBytes(const UCHAR* data)
+	{
+		ULONG value;
+		memcpy(&value, data, sizeof(ULONG));
+		return (value * 2654435761U) >> (32 - HASH_BITS);
+	}
+
+	inline ULONG getLiteralsLength(ULONG length)
+	{
+		return length + (length + MAX_NONCOMP_RUN - 1) / MAX_NONCOMP_RUN;
+	}
+
+	inline UCHAR* putLiterals(UCHAR* output, const UCHAR* input, ULONG length)
+	{
+		while (length)
+		{
+			const auto max = MIN(length, (ULONG) MAX_NONCOMP_RUN);
+			*output++ = (UCHAR) max;
+			memcpy(output, input, max);
+			output += max;
+			input += max;
+			length -= max;
+		}
+
+		return output;
+	}
 };
 
 unsigned Compressor::nonCompressableRun(unsigned length)
@@ -97,15 +150,20 @@ Compressor::Compressor(thread_db* tdbb, ULONG length, const UCHAR* data)
 		*tdbb->getDefaultPool(),
 		tdbb->getDatabase()->getEncodedOdsVersion() >= ODS_13_1,
 		tdbb->getDatabase()->getEncodedOdsVersion() >= ODS_13_1,
+		tdbb->getDatabase()->getEncodedOdsVersion() >= ODS_13_3 &&
+			tdbb->getDatabase()->dbb_config->getLZRecordCompression(),
 		length,
 		data)
 {
 }
 
-Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, ULONG length, const UCHAR* data)
+Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, bool allowReferences,
+					   ULONG length, const UCHAR* data)
 	: m_runs(pool),
+	  m_lzData(pool),
 	  m_allowLongRuns(allowLongRuns),
-	  m_allowUnpacked(allowUnpacked)
+	  m_allowUnpacked(allowUnpacked),
+	  m_allowReferences(allowReferences)
 {
 	const auto end = data + length;
 	const auto input = data;
@@ -208,6 +266,114 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 		m_runs.clear();
 		m_length = length;
 	}
+
+	m_rleLength = m_length;
+
+	if (m_allowReferences && length >= MIN_LZ_LENGTH)
+		packReferences(pool, length, input);
+}
+
+void Compressor::packReferences(MemoryPool& pool, ULONG length, const UCHAR* data)
+{
+/**************************************
+ *
+ *	Try the LZ-style encoding of the input string.
+ *	Keep it only if it's shorter than the RLE one.
+ *
+ **************************************/
+	const auto limit = m_length;
+
+	// Never produce more than the RLE encoding does, just give up once it happens.
+	// Some slack is reserved for the reference written after the limit check.
+
+	auto output = m_lzData.getBuffer(limit + 2 * sizeof(USHORT) + 1, false);
+	const auto start = output;
+	const auto output_end = output + limit;
+
+	Firebird::Array<ULONG> hashTable(pool);
+	auto table = hashTable.getBuffer(HASH_SIZE, false);
+	memset(table, 0, HASH_SIZE * sizeof(ULONG));
+
+	const auto end = data + length;
+	auto literals = data;
+	auto p = data;
+
+	while (end - p >= (int) MIN_MATCH && output < output_end)
+	{
+		const auto hash = hashBytes(p);
+		const ULONG position = (ULONG) (p - data);
+		const auto candidate = table[hash];
+		table[hash] = position + 1;
+
+		if (candidate && position - (candidate - 1) <= MAX_DISTANCE)
+		{
+			const auto ref = data + candidate - 1;
+			const auto max = (ULONG) MIN(end - p, (int) MAX_LONG_MATCH);
+			ULONG count = 0;
+
+			while (count < max && ref[count] == p[count])
+				count++;
+
+			if (count >= MIN_MATCH)
+			{
+				const ULONG literalCount = p - literals;
+
+				if (output + getLiteralsLength(literalCount) >= output_end)
+					break;
+
+				output = putLiterals(output, literals, literalCount);
+
+				if (count <= MAX_SHORT_MATCH)
+					*output++ = (UCHAR) (3 - (int) count);
+				else
+				{
+					*output++ = (UCHAR) MIN_SCHAR;
+					put_short(output, count);
+					output += sizeof(USHORT);
+				}
+
+				put_short(output, p - ref);
+				output += sizeof(USHORT);
+
+				p += count;
+				literals = p;
+				continue;
+			}
+		}
+
+		p++;
+	}
+
+	const ULONG literalCount = end - literals;
+
+	if (output >= output_end || output + getLiteralsLength(literalCount) >= output_end)
+	{
+		m_lzData.free();
+		return;
+	}
+
+	output = putLiterals(output, literals, literalCount);
+
+	const auto lzLength = (ULONG) (output - start);
+	fb_assert(lzLength < limit);
+
+	m_lzData.shrink(lzLength);
+	m_length = lzLength;
+}
+
+void Compressor::discardReferences()
+{
+/**************************************
+ *
+ *	Switch back to the RLE encoding.
+ *	It's required to pack string fragments.
+ *
+ **************************************/
+	if (m_lzData.hasData())
+	{
+		m_lzData.free();
+		m_length = m_rleLength;
+	}
 }
 
 void Compressor::pack(const UCHAR* input, UCHAR* output) const
@@ -218,6 +384,12 @@ void Compressor::pack(const UCHAR* input, UCHAR* output) const
  *	Don't check nuttin' -- go for speed, man, raw SPEED!
  *
  **************************************/
+	if (m_lzData.hasData())
+	{
+		memcpy(output, m_lzData.begin(), m_lzData.getCount());
+		return;
+	}
+
 	if (m_runs.isEmpty())
 	{
 		// Perform raw byte copying instead of compressing
@@ -273,6 +445,7 @@ ULONG Compressor::truncate(ULONG outLength)
  *	Return the number of leading input bytes that fit the given output length.
  *
  **************************************/
+	discardReferences();
 	fb_assert(m_length > outLength);
 
 	if (m_runs.isEmpty())
@@ -345,6 +518,7 @@ ULONG Compressor::truncateTail(ULONG outLength)
  *	Return the number of trailing input bytes that fit the given output length.
  *
  **************************************/
+	discardReferences();
 	fb_assert(m_length > outLength);
 
 	if (m_runs.isEmpty())
@@ -414,7 +588,7 @@ ULONG Compressor::truncateTail(ULONG outLength)
 	return inLength;
 }
 
-ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
+ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input, bool references)
 {
 /**************************************
  *
@@ -422,6 +596,10 @@ ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
  *
  **************************************/
 	const auto end = input + inLength;
+
+	if (references)
+		return getReferencesLength(input, end);
+
 	ULONG result = 0;
 
 	while (input < end)
@@ -460,7 +638,7 @@ ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
 }
 
 UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
-						  ULONG outLength, UCHAR* output)
+						  ULONG outLength, UCHAR* output, bool references)
 {
 /**************************************
  *
@@ -471,6 +649,9 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 	const auto end = input + inLength;
 	const auto output_end = output + outLength;
 
+	if (references)
+		return unpackReferences(input, end, output, output_end);
+
 	while (input < end)
 	{
 		const int length = (signed char) *input++;
@@ -514,6 +695,119 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 	return output;
 }
 
+ULONG Compressor::getReferencesLength(const UCHAR* input, const UCHAR* end)
+{
+/**************************************
+ *
+ *	Calculate the unpacked length of the LZ-style encoded string.
+ *	Return zero if the string is malformed.
+ *
+ **************************************/
+	ULONG result = 0;
+
+	while (input < end)
+	{
+		const int length = (signed char) *input++;
+
+		if (length < 0)
+		{
+			auto copyLength = (unsigned) (3 - length);
+
+			if (length == MIN_SCHAR)
+			{
+				if (input + sizeof(USHORT) > end)
+					return 0;
+
+				copyLength = get_short(input);
+				input += sizeof(USHORT);
+			}
+
+			if (input + sizeof(USHORT) > end)
+				return 0;
+
+			const unsigned distance = get_short(input);
+			input += sizeof(USHORT);
+
+			if (!distance || distance > result)
+				return 0;
+
+			result += copyLength;
+		}
+		else
+		{
+			result += length;
+			input += length;
+		}
+	}
+
+	return (input == end) ? result : 0;
+}
+
+UCHAR* Compressor::unpackReferences(const UCHAR* input, const UCHAR* end,
+									UCHAR* output, UCHAR* output_end)
+{
+/**************************************
+ *
+ *	Decompress the LZ-style encoded string into a buffer.
+ *	Return the address where the output stopped.
+ *
+ **************************************/
+	const auto start = output;
+
+	while (input < end)
+	{
+		const int length = (signed char) *input++;
+
+		if (length < 0)
+		{
+			auto copyLength = (unsigned) (3 - length);
+
+			if (length == MIN_SCHAR)
+			{
+				if (input + sizeof(USHORT) > end)
+					BUGCHECK(179);	// msg 179 decompression overran buffer
+
+				copyLength = get_short(input);
+				input += sizeof(USHORT);
+			}
+
+			if (input + sizeof(USHORT) > end)
+				BUGCHECK(179);	// msg 179 decompression overran buffer
+
+			const unsigned distance = get_short(input);
+			input += sizeof(USHORT);
+
+			if (!distance || distance > (unsigned) (output - start) || output + copyLength > output_end)
+				BUGCHECK(179);	// msg 179 decompression overran buffer
+
+			const UCHAR* from = output - distance;
+
+			if (distance >= copyLength)
+			{
+				memcpy(output, from, copyLength);
+				output += copyLength;
+			}
+			else
+			{
+				// Overlapping copy, it's how the byte runs are encoded
+				for (const auto copyEnd = output + copyLength; output < copyEnd;)
+					*output++ = *from++;
+			}
+		}
+		else
+		{
+			if (input + length > end || output + length > output_end)
+				BUGCHECK(179);	// msg 179 decompression overran buffer
+
+			memcpy(output, input, length);
+			output += length;
+			input += length;
+		}
+	}
+
+	return output;
+}
+
 ULONG Difference::apply(ULONG diffLength, ULONG outLength, UCHAR* const output)
 {
 /**************************************
@@ -35,7 +35,8 @@ namespace Jrd
 	{
 	public:
 		Compressor(thread_db* tdbb, ULONG length, const UCHAR* data);
-		Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, ULONG length, const UCHAR* data);
+		Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, bool allowReferences,
+				   ULONG length, const UCHAR* data);
 
 		ULONG getPackedLength() const
 		{
@@ -44,26 +45,41 @@ namespace Jrd
 
 		bool isPacked() const
 		{
-			return m_runs.hasData();
+			return m_runs.hasData() || m_lzData.hasData();
+		}
+
+		// LZ-style encoded, must be unpacked with references = true
+		bool hasReferences() const
+		{
+			return m_lzData.hasData();
 		}
 
 		void pack(const UCHAR* input, UCHAR* output) const;
 		ULONG truncate(ULONG outLength);
 		ULONG truncateTail(ULONG outLength);
 
-		static ULONG getUnpackedLength(ULONG inLength, const UCHAR* input);
+		static ULONG getUnpackedLength(ULONG inLength, const UCHAR* input, bool references = false);
 		static UCHAR* unpack(ULONG inLength, const UCHAR* input,
-							 ULONG outLength, UCHAR* output);
+							 ULONG outLength, UCHAR* output, bool references = false);
 
 	private:
 		unsigned nonCompressableRun(unsigned length);
+		void packReferences(MemoryPool& pool, ULONG length, const UCHAR* data);
+		void discardReferences();
+
+		static ULONG getReferencesLength(const UCHAR* input, const UCHAR* end);
+		static UCHAR* unpackReferences(const UCHAR* input, const UCHAR* end,
+									   UCHAR* output, UCHAR* output_end);
 
 		Firebird::HalfStaticArray<int, 256> m_runs;
+		Firebird::Array<UCHAR> m_lzData;	// LZ-style image, if it's shorter than the RLE one
 		ULONG m_length = 0;
+		ULONG m_rleLength = 0;
 
 		// Compatibility options
 		bool m_allowLongRuns = true;
 		bool m_allowUnpacked = true;
+		bool m_allowReferences = false;
 	};
 
 	class Difference
@@ -0,0 +1,94 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/optimizer/Optimizer.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(AdaptiveJoinSuite)
+
+
+namespace
+{
+	// Costs of joining the given number of outer rows, as estimated by the optimizer
+	struct JoinCosts
+	{
+		double rowLoopCost;		// inner retrieval per outer row
+		double buildCost;		// hashing the inner stream
+		double rowProbeCost;	// probing the hash table per outer row
+
+		double loopCost(double outerRows) const
+		{
+			return outerRows * rowLoopCost;
+		}
+
+		double hashCost(double outerRows) const
+		{
+			return buildCost + outerRows * rowProbeCost;
+		}
+
+		double switchCardinality(double estimatedRows) const
+		{
+			return InnerJoin::getSwitchCardinality(estimatedRows, rowLoopCost,
+				hashCost(estimatedRows), rowProbeCost);
+		}
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(AdaptiveJoinTests)
+
+BOOST_AUTO_TEST_CASE(SwitchCardinalityTest)
+{
+	const JoinCosts costs = {100, 5000, 2};
+
+	// The switch point does not depend on the estimated outer cardinality
+
+	const double switchCardinality = costs.switchCardinality(10);
+	BOOST_TEST(switchCardinality == 5000.0 / 98, boost::test_tools::tolerance(1e-9));
+	BOOST_TEST(costs.switchCardinality(1000) == switchCardinality, boost::test_tools::tolerance(1e-9));
+
+	BOOST_TEST(costs.loopCost(switchCardinality) == costs.hashCost(switchCardinality),
+		boost::test_tools::tolerance(1e-9));
+
+	// The nested loop is used while the outer stream is exhausted before the threshold,
+	// the hash join is used once the threshold is reached
+
+	const auto threshold = (FB_UINT64) switchCardinality + 1;
+
+	BOOST_TEST(costs.loopCost(threshold - 1) <= costs.hashCost(threshold - 1));
+	BOOST_TEST(costs.loopCost(threshold) > costs.hashCost(threshold));
+}
+
+BOOST_AUTO_TEST_CASE(NoSwitchTest)
+{
+	// Probing is not cheaper than the nested loop, the hash join never wins
+
+	const JoinCosts cheapLoop = {2, 10, 2};
+	BOOST_TEST(cheapLoop.switchCardinality(10) == 0.0);
+
+	const JoinCosts cheaperLoop = {1, 10, 2};
+	BOOST_TEST(cheaperLoop.switchCardinality(10) == 0.0);
+
+	// Hash join wins even for a single row, no need to wait
+
+	const JoinCosts cheapHash = {100, 10, 2};
+	BOOST_TEST(cheapHash.switchCardinality(10) == 0.0);
+
+	// Switch point is too far away to buffer the outer rows until it
+
+	const JoinCosts expensiveHash = {3, 1e9, 2};
+	BOOST_TEST(expensiveHash.switchCardinality(10) == 0.0);
+
+	const double maxCardinality = MAXIMUM_ADAPTIVE_CARDINALITY;
+	const JoinCosts farHash = {3, maxCardinality, 2};
+	BOOST_TEST(farHash.switchCardinality(10) == maxCardinality);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// AdaptiveJoinTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// AdaptiveJoinSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -17,7 +17,7 @@ BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
 
 	const UCHAR data[] = "111111111123456777777";
 	const auto dataLength = sizeof(data) - 1;
-	const Compressor dcc(pool, false, false, dataLength, data);
+	const Compressor dcc(pool, false, false, false, dataLength, data);
 
 	const auto packedLength = dcc.getPackedLength();
 	Array<UCHAR> packBuffer;
@@ -33,6 +33,65 @@ BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
 	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
 }
 
+BOOST_AUTO_TEST_CASE(PackAndUnpackReferencesTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	const UCHAR data[] =
+		"{\"name\": \"first\", \"value\": 12345}, {\"name\": \"second\", \"value\": 67890}, "
+		"{\"name\": \"third\", \"value\": 00000000000000000000000000000000000000000000}";
+	const auto dataLength = sizeof(data) - 1;
+
+	const Compressor rleDcc(pool, true, true, false, dataLength, data);
+	const Compressor dcc(pool, true, true, true, dataLength, data);
+	BOOST_TEST(dcc.isPacked());
+	BOOST_TEST(dcc.hasReferences());
+	BOOST_TEST(!rleDcc.hasReferences());
+	BOOST_TEST(dcc.getPackedLength() < rleDcc.getPackedLength());
+
+	// LZ-style image is unpacked only if flagged as such
+
+	const auto packedLength = dcc.getPackedLength();
+	Array<UCHAR> packBuffer;
+	dcc.pack(data, packBuffer.getBuffer(packedLength, false));
+
+	Array<UCHAR> unpackBuffer;
+	unpackBuffer.getBuffer(Compressor::getUnpackedLength(packBuffer.getCount(), packBuffer.begin(), true), false);
+	BOOST_TEST(unpackBuffer.getCount() == dataLength);
+
+	BOOST_TEST(Compressor::unpack(packBuffer.getCount(), packBuffer.begin(),
+		unpackBuffer.getCount(), unpackBuffer.begin(), true) == unpackBuffer.end());
+
+	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
+
+	// RLE image of the same string is unpacked the old way
+
+	const auto rleLength = rleDcc.getPackedLength();
+	Array<UCHAR> rleBuffer;
+	rleDcc.pack(data, rleBuffer.getBuffer(rleLength, false));
+
+	unpackBuffer.getBuffer(Compressor::getUnpackedLength(rleBuffer.getCount(), rleBuffer.begin(), false), false);
+	BOOST_TEST(unpackBuffer.getCount() == dataLength);
+
+	BOOST_TEST(Compressor::unpack(rleBuffer.getCount(), rleBuffer.begin(),
+		unpackBuffer.getCount(), unpackBuffer.begin(), false) == unpackBuffer.end());
+
+	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(UnpackLegacyEmptyRunTest)
+{
+	// Zero-length medium run is not a special marker in the unflagged RLE image
+
+	const UCHAR packed[] = {(UCHAR) -1, 0, 0, 'a', 3, 'x', 'y', 'z'};
+
+	BOOST_TEST(Compressor::getUnpackedLength(sizeof(packed), packed) == 3u);
+
+	UCHAR unpacked[3];
+	BOOST_TEST(Compressor::unpack(sizeof(packed), packed, sizeof(unpacked), unpacked) == unpacked + 3);
+	BOOST_TEST(memcmp(unpacked, "xyz", 3) == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorTests
 
 
@@ -0,0 +1,146 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/recsrc/HashGroupTable.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(HashGroupTableSuite)
+
+
+namespace
+{
+	const ULONG KEY_LENGTH = 8;
+
+	// Poor hash, so that the chains are long and the partitions are predictable
+	ULONG makeKey(HashGroupTable& groups, FB_UINT64 value)
+	{
+		memcpy(groups.getKeyBuffer(), &value, KEY_LENGTH);
+		return (ULONG) (value % 1000) << 22 | (ULONG) (value % 97);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(HashGroupTableTests)
+
+BOOST_AUTO_TEST_CASE(AggregateInMemoryTest)
+{
+	HashGroupTable groups(*getDefaultMemoryPool(), KEY_LENGTH, 2, 1, 0);
+
+	// Every value is aggregated into its own group, the states stay in place
+	// while the table grows
+
+	const FB_UINT64 GROUPS = 10000;
+
+	for (unsigned pass = 0; pass < 3; pass++)
+	{
+		for (FB_UINT64 value = 0; value < GROUPS; value++)
+		{
+			const ULONG hash = makeKey(groups, value);
+
+			ULONG index;
+			if (!groups.find(hash, index))
+			{
+				BOOST_REQUIRE(pass == 0);
+				index = groups.add(hash);
+			}
+
+			impure_value_ex* const states = groups.getStates(index);
+			states[0].vlu_misc.vlu_int64 += 1;
+			states[1].vlu_misc.vlu_int64 += value;
+		}
+	}
+
+	BOOST_TEST(groups.getCount() == GROUPS);
+	BOOST_TEST(!groups.isFull());
+
+	for (FB_UINT64 value = 0; value < GROUPS; value++)
+	{
+		ULONG index;
+		BOOST_REQUIRE(groups.find(makeKey(groups, value), index));
+
+		const impure_value_ex* const states = groups.getStates(index);
+		BOOST_TEST(states[0].vlu_misc.vlu_int64 == 3);
+		BOOST_TEST(states[1].vlu_misc.vlu_int64 == (SINT64) (3 * value));
+	}
+
+	ULONG index;
+	BOOST_TEST(!groups.find(makeKey(groups, GROUPS), index));
+
+	groups.clear();
+	BOOST_TEST(groups.getCount() == 0u);
+	BOOST_TEST(!groups.find(makeKey(groups, 0), index));
+}
+
+BOOST_AUTO_TEST_CASE(SpillTest)
+{
+	const FB_UINT64 MEMORY_LIMIT = 64 * 1024;
+	HashGroupTable groups(*getDefaultMemoryPool(), KEY_LENGTH, 1, 0, MEMORY_LIMIT);
+
+	// Groups are added until the memory limit is reached, the records
+	// of the remaining groups are routed into partitions by the hash
+
+	FB_UINT64 value = 0;
+
+	while (!groups.isFull())
+	{
+		const ULONG hash = makeKey(groups, value++);
+		groups.add(hash);
+	}
+
+	BOOST_TEST(groups.getCount() > 0u);
+	BOOST_TEST(groups.getCount() < MEMORY_LIMIT / KEY_LENGTH);
+
+	ULONG counts[HashGroupTable::PARTITION_COUNT] = {};
+
+	for (FB_UINT64 spilled = value; spilled < value + 1000; spilled++)
+	{
+		const ULONG hash = makeKey(groups, spilled);
+
+		ULONG index;
+		BOOST_TEST(!groups.find(hash, index));
+
+		const ULONG number = HashGroupTable::getPartition(hash, 0);
+		BOOST_REQUIRE(number < (ULONG) HashGroupTable::PARTITION_COUNT);
+		counts[number]++;
+	}
+
+	// Keys are spread over all the partitions
+
+	for (const auto count : counts)
+		BOOST_TEST(count > 0u);
+}
+
+BOOST_AUTO_TEST_CASE(SpillLevelsTest)
+{
+	// Every spill level uses its own bits of the hash, so the records of a partition
+	// are split further at the next level, while staying within the same partition
+	// of the previous levels
+
+	const ULONG hash = 0x9ABCDEF5;
+
+	BOOST_TEST(HashGroupTable::getPartition(hash, 0) == 0x9u);
+	BOOST_TEST(HashGroupTable::getPartition(hash, 1) == 0xAu);
+	BOOST_TEST(HashGroupTable::getPartition(hash, 2) == 0xBu);
+	BOOST_TEST(HashGroupTable::getPartition(hash, HashGroupTable::MAX_SPILL_LEVEL - 1) == 0xEu);
+
+	ULONG counts[HashGroupTable::PARTITION_COUNT] = {};
+
+	for (ULONG i = 0; i < 256; i++)
+	{
+		const ULONG partitionHash = (0x5u << 28) | (i << 20);
+		BOOST_TEST(HashGroupTable::getPartition(partitionHash, 0) == 0x5u);
+		counts[HashGroupTable::getPartition(partitionHash, 1)]++;
+	}
+
+	for (const auto count : counts)
+		BOOST_TEST(count == 16u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// HashGroupTableTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// HashGroupTableSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,196 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/recsrc/HashJoinTable.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(HashJoinTableSuite)
+
+
+namespace
+{
+	// Count the rows matching the hash
+	void checkMatches(HashJoinTable& table, ULONG hash, unsigned expected)
+	{
+		unsigned count = 0;
+
+		if (table.locate(hash))
+		{
+			ULONG position;
+			while (table.iterate(hash, position))
+				count++;
+		}
+
+		BOOST_TEST(count == expected);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(HashJoinTableTests)
+
+BOOST_AUTO_TEST_CASE(BuildAndProbeTest)
+{
+	HashJoinTable table(*getDefaultMemoryPool());
+
+	// Hashes 0..999, the hash N is repeated N % 5 + 1 times, so that
+	// the slots get collisions and duplicates of different lengths
+
+	const ULONG HASHES = 1000;
+	ULONG position = 0;
+	Array<ULONG> owners;
+
+	for (unsigned pass = 0; pass < 5; pass++)
+	{
+		for (ULONG hash = 0; hash < HASHES; hash++)
+		{
+			if (hash % 5 >= pass)
+			{
+				table.add(hash * 7919, position++);
+				owners.add(hash * 7919);
+			}
+		}
+	}
+
+	table.build();
+	BOOST_TEST(table.getCount() == position);
+
+	for (ULONG hash = 0; hash < HASHES; hash++)
+		checkMatches(table, hash * 7919, hash % 5 + 1);
+
+	checkMatches(table, 1, 0);
+	checkMatches(table, HASHES * 7919, 0);
+
+	// Positions returned for a hash belong to the rows added with that hash
+
+	const ULONG hash = 123 * 7919;
+	BOOST_REQUIRE(table.locate(hash));
+
+	ULONG found;
+	while (table.iterate(hash, found))
+		BOOST_TEST(owners[found] == hash);
+}
+
+BOOST_AUTO_TEST_CASE(LongSlotTest)
+{
+	HashJoinTable table(*getDefaultMemoryPool());
+
+	// Slot having many rows is binary searched, the duplicates are returned together
+
+	const ULONG DUPLICATES = 20;
+	ULONG position = 0;
+
+	for (ULONG i = 0; i < DUPLICATES; i++)
+		table.add(42, position++);
+
+	for (ULONG hash = 0; hash < 100; hash++)
+		table.add(hash, position++);
+
+	table.build();
+
+	for (ULONG hash = 0; hash < 100; hash++)
+		checkMatches(table, hash, hash == 42 ? DUPLICATES + 1 : 1);
+
+	checkMatches(table, 100, 0);
+}
+
+BOOST_AUTO_TEST_CASE(MaxCountTest)
+{
+	// The whole table being built must fit the memory limit
+
+	const ULONG rowSize = HashJoinTable::ROW_BUILD_SIZE;
+	const FB_UINT64 memoryLimit = 64 * 1024 * 1024;
+
+	BOOST_TEST(HashJoinTable::getMaxCount(memoryLimit) == memoryLimit / rowSize);
+	BOOST_TEST(HashJoinTable::getMaxCount(memoryLimit) * (FB_UINT64) rowSize <= memoryLimit);
+	BOOST_TEST(HashJoinTable::getMaxCount(1024) == 1024 / rowSize);
+
+	// Zero limit and huge limits still keep the table size bounded
+
+	BOOST_TEST(HashJoinTable::getMaxCount(0) > 0u);
+	BOOST_TEST(HashJoinTable::getMaxCount(MAX_UINT64) <= (1u << 30));
+}
+
+BOOST_AUTO_TEST_CASE(PartitionCountTest)
+{
+	const FB_UINT64 memoryLimit = 1024 * 1024;
+	const ULONG maxPartitions = HashJoinTable::MAX_PARTITIONS;
+
+	// The build side exceeding the limit is split at least in two
+
+	BOOST_TEST(HashJoinTable::getPartitionCount(memoryLimit + 1, memoryLimit) == 2u);
+	BOOST_TEST(HashJoinTable::getPartitionCount(2 * memoryLimit, memoryLimit) == 2u);
+	BOOST_TEST(HashJoinTable::getPartitionCount(2 * memoryLimit + 1, memoryLimit) == 4u);
+	BOOST_TEST(HashJoinTable::getPartitionCount(100 * memoryLimit, memoryLimit) == 128u);
+
+	// Every partition fits the limit, unless there're too many of them
+
+	for (FB_UINT64 buildSize = memoryLimit; buildSize < 1000 * memoryLimit; buildSize += buildSize / 3)
+	{
+		const ULONG count = HashJoinTable::getPartitionCount(buildSize, memoryLimit);
+		BOOST_TEST(!(count & (count - 1)));
+		BOOST_TEST((count == maxPartitions || buildSize <= count * memoryLimit));
+	}
+
+	BOOST_TEST(HashJoinTable::getPartitionCount(MAX_UINT64, memoryLimit) == maxPartitions);
+}
+
+BOOST_AUTO_TEST_CASE(PartitionSplitTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	// Rows are spread evenly between partitions, and every partition table
+	// finds the rows of its own partition
+
+	const ULONG PARTITIONS = 16;
+	const ULONG ROWS = 64 * 1024;
+
+	HashJoinTable* tables[PARTITIONS];
+	ULONG counts[PARTITIONS] = {};
+
+	for (auto& table : tables)
+		table = FB_NEW_POOL(pool) HashJoinTable(pool);
+
+	for (ULONG hash = 0; hash < ROWS; hash++)
+	{
+		const ULONG partition = HashJoinTable::getPartition(hash, PARTITIONS);
+		BOOST_REQUIRE(partition < PARTITIONS);
+
+		tables[partition]->add(hash, counts[partition]++);
+	}
+
+	for (ULONG i = 0; i < PARTITIONS; i++)
+	{
+		BOOST_TEST(counts[i] > ROWS / PARTITIONS * 9 / 10);
+		BOOST_TEST(counts[i] < ROWS / PARTITIONS * 11 / 10);
+
+		// Same partition is chosen for the same hash with a larger partition count
+
+		const ULONG hash = i * 7919;
+		BOOST_TEST(HashJoinTable::getPartition(hash, PARTITIONS * 2) % PARTITIONS ==
+			HashJoinTable::getPartition(hash, PARTITIONS));
+	}
+
+	for (ULONG i = 0; i < PARTITIONS; i++)
+	{
+		tables[i]->build();
+		BOOST_TEST(tables[i]->getCount() == counts[i]);
+	}
+
+	for (ULONG hash = 0; hash < ROWS; hash++)
+	{
+		HashJoinTable* const table = tables[HashJoinTable::getPartition(hash, PARTITIONS)];
+		checkMatches(*table, hash, 1);
+	}
+
+	for (auto table : tables)
+		delete table;
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// HashJoinTableTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// HashJoinTableSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
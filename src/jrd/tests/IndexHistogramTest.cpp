@@ -0,0 +1,165 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/btr.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(IndexHistogramSuite)
+
+
+namespace
+{
+	void makeKey(temporary_key& key, unsigned value)
+	{
+		key.key_length = 2;
+		key.key_data[0] = (UCHAR) (value >> 8);
+		key.key_data[1] = (UCHAR) value;
+		key.key_flags = 0;
+		key.key_nulls = 0;
+	}
+
+	// 10 NULLs followed by the values 0..99 repeated 10 times each,
+	// except the value 50 which is repeated 200 times
+	void collect(IndexHistogram& histogram)
+	{
+		for (unsigned i = 0; i < 10; i++)
+			histogram.add(nullptr, 0, i == 0);
+
+		for (unsigned value = 0; value < 100; value++)
+		{
+			temporary_key key;
+			makeKey(key, value);
+
+			const unsigned count = (value == 50) ? 200 : 10;
+
+			for (unsigned i = 0; i < count; i++)
+				histogram.add(key.key_data, key.key_length, i == 0);
+		}
+
+		histogram.finish();
+	}
+
+	double equal(const IndexHistogram& histogram, unsigned value)
+	{
+		temporary_key key;
+		makeKey(key, value);
+		return histogram.getEqualSelectivity(&key);
+	}
+
+	double range(const IndexHistogram& histogram, unsigned lower, unsigned upper)
+	{
+		temporary_key lowerKey, upperKey;
+		makeKey(lowerKey, lower);
+		makeKey(upperKey, upper);
+		return histogram.getRangeSelectivity(&lowerKey, &upperKey);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(IndexHistogramTests)
+
+BOOST_AUTO_TEST_CASE(CollectTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	collect(histogram);
+
+	BOOST_TEST(histogram.keyCount == 1200u);
+	BOOST_TEST(histogram.valueCount == 101u);
+	BOOST_TEST(histogram.nullCount == 10u);
+
+	const unsigned maxBoundaries = IndexHistogram::MAX_BOUNDARIES;
+	BOOST_TEST(histogram.boundaries.getCount() >= maxBoundaries);
+	BOOST_TEST(histogram.boundaries.getCount() < 2 * maxBoundaries);
+
+	// Only the skewed value is more common than the average one
+	BOOST_REQUIRE(histogram.frequent.getCount() == 1u);
+	BOOST_TEST(histogram.frequent[0].count == 200u);
+}
+
+BOOST_AUTO_TEST_CASE(EqualSelectivityTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+
+	temporary_key nullKey;
+	nullKey.key_length = 0;
+
+	BOOST_TEST(equal(histogram, 50) == 0.0);
+
+	collect(histogram);
+
+	BOOST_TEST(equal(histogram, 50) == 200.0 / 1200, boost::test_tools::tolerance(1e-9));
+	BOOST_TEST(equal(histogram, 7) == 10.0 / 1200, boost::test_tools::tolerance(1e-9));
+	BOOST_TEST(histogram.getEqualSelectivity(&nullKey) == 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(RangeSelectivityTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	collect(histogram);
+
+	// The range around the skewed value is estimated much larger
+	// than the range of the same width elsewhere
+
+	const double skewed = range(histogram, 45, 55);
+	const double uniform = range(histogram, 60, 70);
+
+	BOOST_TEST(skewed > 0.2);
+	BOOST_TEST(skewed < 0.3);
+	BOOST_TEST(uniform > 0.05);
+	BOOST_TEST(uniform < 0.15);
+
+	// Open ranges skip NULLs and cover the whole table together
+
+	temporary_key key;
+	makeKey(key, 50);
+
+	const double below = histogram.getRangeSelectivity(nullptr, &key);
+	const double above = histogram.getRangeSelectivity(&key, nullptr);
+
+	BOOST_TEST(histogram.getRangeSelectivity(nullptr, nullptr) == 1190.0 / 1200,
+		boost::test_tools::tolerance(1e-9));
+	BOOST_TEST(below + above > 0.9);
+	BOOST_TEST(below + above < 1.3);
+}
+
+BOOST_AUTO_TEST_CASE(StoreAndLoadTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	IndexHistogram histogram(pool);
+	collect(histogram);
+
+	UCharBuffer buffer;
+	histogram.store(buffer);
+
+	IndexHistogram loaded(pool);
+	BOOST_REQUIRE(loaded.load(buffer.begin(), buffer.getCount()));
+
+	BOOST_TEST(loaded.keyCount == histogram.keyCount);
+	BOOST_TEST(loaded.valueCount == histogram.valueCount);
+	BOOST_TEST(loaded.nullCount == histogram.nullCount);
+	BOOST_TEST(loaded.step == histogram.step);
+	BOOST_TEST(loaded.boundaries.getCount() == histogram.boundaries.getCount());
+	BOOST_TEST(loaded.frequent.getCount() == histogram.frequent.getCount());
+
+	for (unsigned value = 0; value < 100; value += 5)
+	{
+		BOOST_TEST(equal(loaded, value) == equal(histogram, value));
+		BOOST_TEST(range(loaded, value, value + 10) == range(histogram, value, value + 10));
+	}
+
+	// Damaged blob is rejected
+
+	buffer[0] ^= 0xFF;
+	BOOST_TEST(!loaded.load(buffer.begin(), buffer.getCount()));
+	BOOST_TEST(loaded.isEmpty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexHistogramTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexHistogramSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,221 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/TempSpace.h"
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(TempSpaceSuite)
+
+
+namespace
+{
+	const FB_SIZE_T CHUNK_SIZE = 64 * 1024;	// temporary file chunk size
+	const FB_SIZE_T BLOCK_SIZE = 8 * CHUNK_SIZE;
+
+	class MemoryFile : public File
+	{
+	public:
+		explicit MemoryFile(MemoryPool& pool, FB_SIZE_T size)
+			: data(pool)
+		{
+			memset(data.getBuffer(size, false), 0, size);
+		}
+
+		FB_SIZE_T read(offset_t offset, void* buffer, FB_SIZE_T length) override
+		{
+			BOOST_REQUIRE(offset + length <= data.getCount());
+			memcpy(buffer, data.begin() + offset, length);
+			++reads;
+			return length;
+		}
+
+		FB_SIZE_T write(offset_t offset, const void* buffer, FB_SIZE_T length) override
+		{
+			BOOST_REQUIRE(offset + length <= data.getCount());
+			memcpy(data.begin() + offset, buffer, length);
+			++writes;
+			return length;
+		}
+
+		void unlink() override
+		{}
+
+		offset_t getSize() const override
+		{
+			return data.getCount();
+		}
+
+		Array<UCHAR> data;
+		unsigned reads = 0;
+		unsigned writes = 0;
+	};
+
+	// Compressible, but not trivially so
+	UCHAR pattern(offset_t offset)
+	{
+		return (UCHAR) ((offset / 7) % 251);
+	}
+
+	void fill(UCHAR* buffer, offset_t offset, FB_SIZE_T length)
+	{
+		for (FB_SIZE_T i = 0; i < length; i++)
+			buffer[i] = pattern(offset + i);
+	}
+
+	// Write the whole block by records which cross the chunk boundaries,
+	// then read them back in a different order and by different pieces
+	void testReadWrite(bool compressed)
+	{
+		auto& pool = *getDefaultMemoryPool();
+
+		MemoryFile file(pool, BLOCK_SIZE);
+		TempSpace::FileBlock block(pool, &file, NULL, BLOCK_SIZE, compressed);
+
+		const FB_SIZE_T RECORD_SIZE = 1000;
+		UCHAR record[RECORD_SIZE];
+
+		for (offset_t offset = 0; offset < BLOCK_SIZE; offset += RECORD_SIZE)
+		{
+			const auto length = (FB_SIZE_T) MIN(RECORD_SIZE, BLOCK_SIZE - offset);
+			fill(record, offset, length);
+			BOOST_TEST(block.write(offset, record, length) == length);
+		}
+
+		// Reversed order, evicts the cached chunks
+
+		UCHAR buffer[RECORD_SIZE], expected[RECORD_SIZE];
+		const FB_SIZE_T PIECE_SIZE = 333;
+
+		for (SINT64 offset = BLOCK_SIZE - PIECE_SIZE; offset >= 0; offset -= PIECE_SIZE * 3)
+		{
+			BOOST_TEST(block.read(offset, buffer, PIECE_SIZE) == PIECE_SIZE);
+			fill(expected, offset, PIECE_SIZE);
+			BOOST_TEST(memcmp(buffer, expected, PIECE_SIZE) == 0);
+		}
+
+		// Pieces around every chunk boundary
+
+		for (offset_t offset = CHUNK_SIZE; offset < BLOCK_SIZE; offset += CHUNK_SIZE)
+		{
+			BOOST_TEST(block.read(offset - PIECE_SIZE / 2, buffer, PIECE_SIZE) == PIECE_SIZE);
+			fill(expected, offset - PIECE_SIZE / 2, PIECE_SIZE);
+			BOOST_TEST(memcmp(buffer, expected, PIECE_SIZE) == 0);
+		}
+
+		// The whole block at once
+
+		Array<UCHAR> all, allExpected;
+		BOOST_TEST(block.read(0, all.getBuffer(BLOCK_SIZE, false), BLOCK_SIZE) == BLOCK_SIZE);
+		fill(allExpected.getBuffer(BLOCK_SIZE, false), 0, BLOCK_SIZE);
+		BOOST_TEST(memcmp(all.begin(), allExpected.begin(), BLOCK_SIZE) == 0);
+
+		// Overwrite across the chunk boundary and read it back
+
+		memset(record, 'x', RECORD_SIZE);
+		BOOST_TEST(block.write(2 * CHUNK_SIZE - RECORD_SIZE / 2, record, RECORD_SIZE) == RECORD_SIZE);
+		BOOST_TEST(block.read(2 * CHUNK_SIZE - RECORD_SIZE, buffer, RECORD_SIZE) == RECORD_SIZE);
+		fill(expected, 2 * CHUNK_SIZE - RECORD_SIZE, RECORD_SIZE / 2);
+		memset(expected + RECORD_SIZE / 2, 'x', RECORD_SIZE / 2);
+		BOOST_TEST(memcmp(buffer, expected, RECORD_SIZE) == 0);
+
+		// Modify other chunks, so that the changed ones are evicted from cache
+
+		for (unsigned chunk = 3; chunk < BLOCK_SIZE / CHUNK_SIZE; chunk++)
+			BOOST_TEST(block.write(chunk * CHUNK_SIZE + 10, "yyyyyyyyyy", 10) == 10u);
+
+		BOOST_TEST(block.read(2 * CHUNK_SIZE, buffer, RECORD_SIZE) == RECORD_SIZE);
+		memset(expected, 'x', RECORD_SIZE / 2);
+		fill(expected + RECORD_SIZE / 2, 2 * CHUNK_SIZE + RECORD_SIZE / 2, RECORD_SIZE / 2);
+		BOOST_TEST(memcmp(buffer, expected, RECORD_SIZE) == 0);
+
+		for (unsigned chunk = 3; chunk < BLOCK_SIZE / CHUNK_SIZE; chunk++)
+		{
+			BOOST_TEST(block.read(chunk * CHUNK_SIZE + 5, buffer, 20) == 20u);
+			fill(expected, chunk * CHUNK_SIZE + 5, 20);
+			memset(expected + 5, 'y', 10);
+			BOOST_TEST(memcmp(buffer, expected, 20) == 0);
+		}
+
+		if (!compressed)
+		{
+			// Uncompressed chunks are stored as is
+			BOOST_TEST(memcmp(file.data.begin(), allExpected.begin(), CHUNK_SIZE) == 0);
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(TempSpaceTests)
+
+BOOST_AUTO_TEST_CASE(FileBlockTest)
+{
+	testReadWrite(false);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedFileBlockTest)
+{
+	testReadWrite(true);
+}
+
+BOOST_AUTO_TEST_CASE(FileBlockCleanChunksTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	MemoryFile file(pool, BLOCK_SIZE);
+	TempSpace::FileBlock block(pool, &file, NULL, BLOCK_SIZE, true);
+
+	Array<UCHAR> data;
+	fill(data.getBuffer(BLOCK_SIZE, false), 0, BLOCK_SIZE);
+	BOOST_TEST(block.write(0, data.begin(), BLOCK_SIZE) == BLOCK_SIZE);
+
+	const auto writes = file.writes;
+
+	// Reading and rewriting the same contents never write chunks back
+
+	UCHAR buffer[100];
+
+	for (unsigned pass = 0; pass < 2; pass++)
+	{
+		for (offset_t offset = 50; offset < BLOCK_SIZE; offset += CHUNK_SIZE / 2)
+		{
+			BOOST_TEST(block.read(offset, buffer, sizeof(buffer)) == sizeof(buffer));
+			BOOST_TEST(block.write(offset, buffer, sizeof(buffer)) == sizeof(buffer));
+		}
+	}
+
+	BOOST_TEST(file.writes == writes);
+}
+
+BOOST_AUTO_TEST_CASE(FileBlockRandomReadTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	MemoryFile file(pool, BLOCK_SIZE);
+	TempSpace::FileBlock block(pool, &file, NULL, BLOCK_SIZE, false);
+
+	Array<UCHAR> data;
+	fill(data.getBuffer(BLOCK_SIZE, false), 0, BLOCK_SIZE);
+	BOOST_TEST(block.write(0, data.begin(), BLOCK_SIZE) == BLOCK_SIZE);
+
+	// Small reads of the uncompressed chunks transfer only the requested bytes
+
+	UCHAR buffer[100];
+	file.reads = 0;
+	unsigned count = 0;
+
+	for (offset_t offset = 12345; offset < BLOCK_SIZE - sizeof(buffer); offset += 54321)
+	{
+		BOOST_TEST(block.read(offset, buffer, sizeof(buffer)) == sizeof(buffer));
+		BOOST_TEST(memcmp(buffer, data.begin() + offset, sizeof(buffer)) == 0);
+		count++;
+	}
+
+	BOOST_TEST(file.reads == count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// TempSpaceTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// TempSpaceSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
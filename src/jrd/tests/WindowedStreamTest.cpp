@@ -0,0 +1,232 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/recsrc/RecordSource.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(WindowedStreamSuite)
+
+
+namespace
+{
+	typedef WindowedStream::WindowStream WindowStream;
+
+	// SUM and MAX of a frame, with the same retract rules as the aggregate nodes
+	struct Aggregate
+	{
+		void init()
+		{
+			sum = 0;
+			count = 0;
+			max = MIN_SINT64;
+		}
+
+		void pass(SINT64 value)
+		{
+			sum += value;
+			count++;
+			max = MAX(max, value);
+			passes++;
+		}
+
+		bool retract(SINT64 value)
+		{
+			retracts++;
+
+			// The extreme cannot be removed, the new one is unknown
+			if (value >= max)
+				return false;
+
+			sum -= value;
+			count--;
+			return true;
+		}
+
+		SINT64 sum = 0;
+		SINT64 count = 0;
+		SINT64 max = MIN_SINT64;
+		unsigned passes = 0;
+		unsigned retracts = 0;
+	};
+
+	struct Frame
+	{
+		SINT64 start;
+		SINT64 end;
+	};
+
+	// Aggregate every frame the way WindowStream does, reusing the last frame's
+	// aggregation when possible, and compare it with the aggregation from scratch
+	void aggregateFrames(const Array<SINT64>& values, const Array<Frame>& frames, Aggregate& aggregate)
+	{
+		Frame last = {MIN_SINT64, MIN_SINT64};
+		bool lastValid = false;
+
+		for (const auto& frame : frames)
+		{
+			SINT64 leaving = !lastValid ? -1 :
+				WindowStream::getRetractCount(last.start, last.end, frame.start, frame.end);
+
+			bool reuse = (leaving >= 0);
+
+			for (SINT64 position = last.start; reuse && leaving-- > 0; position++)
+				reuse = aggregate.retract(values[position]);
+
+			SINT64 position = frame.start;
+
+			if (!reuse)
+				aggregate.init();
+			else
+			{
+				for (; position < last.start; position++)
+					aggregate.pass(values[position]);
+
+				position = last.end + 1;
+			}
+
+			for (; position <= frame.end; position++)
+				aggregate.pass(values[position]);
+
+			Aggregate expected;
+			expected.init();
+
+			for (SINT64 i = frame.start; i <= frame.end; i++)
+				expected.pass(values[i]);
+
+			BOOST_TEST(aggregate.sum == expected.sum);
+			BOOST_TEST(aggregate.count == expected.count);
+			BOOST_TEST(aggregate.max == expected.max);
+
+			last = frame;
+			lastValid = true;
+		}
+	}
+
+	// ROWS BETWEEN <preceding> PRECEDING AND <following> FOLLOWING
+	void makeFrames(Array<Frame>& frames, SINT64 count, SINT64 preceding, SINT64 following)
+	{
+		for (SINT64 i = 0; i < count; i++)
+		{
+			const Frame frame = {MAX(i - preceding, 0), MIN(i + following, count - 1)};
+			frames.add(frame);
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(WindowedStreamTests)
+
+BOOST_AUTO_TEST_CASE(RetractCountTest)
+{
+	// Frame containing the last one reuses it as is
+
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 10, 20) == 0);
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 5, 25) == 0);
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 10, 21) == 0);
+
+	// Frame sliding forward retracts the leaving records
+
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 11, 21) == 1);
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 15, 20) == 5);
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 20, 40) == 10);
+
+	// Restarted if the end moves backward, the frames don't overlap
+	// or more records leave the frame than remain in it
+
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 10, 19) < 0);
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 21, 30) < 0);
+	BOOST_TEST(WindowStream::getRetractCount(10, 20, 18, 20) < 0);
+}
+
+BOOST_AUTO_TEST_CASE(SlidingFrameTest)
+{
+	const SINT64 COUNT = 1000;
+
+	// Increasing values never retract the maximum, so the frame is never restarted
+
+	Array<SINT64> values;
+	for (SINT64 i = 0; i < COUNT; i++)
+		values.add(i * 3);
+
+	Array<Frame> frames;
+	makeFrames(frames, COUNT, 5, 3);
+
+	Aggregate aggregate;
+	aggregateFrames(values, frames, aggregate);
+
+	// Linear time: every record enters and leaves the frame once
+
+	BOOST_TEST(aggregate.passes <= (unsigned) COUNT);
+	BOOST_TEST(aggregate.retracts <= (unsigned) COUNT);
+}
+
+BOOST_AUTO_TEST_CASE(RetractRefusedTest)
+{
+	const SINT64 COUNT = 200;
+
+	// Decreasing values retract the maximum every time, so the frames are
+	// aggregated from scratch, but the results are still correct
+
+	Array<SINT64> values;
+	for (SINT64 i = 0; i < COUNT; i++)
+		values.add(COUNT - i);
+
+	Array<Frame> frames;
+	makeFrames(frames, COUNT, 2, 2);
+
+	Aggregate aggregate;
+	aggregateFrames(values, frames, aggregate);
+
+	BOOST_TEST(aggregate.passes > (unsigned) COUNT);
+}
+
+BOOST_AUTO_TEST_CASE(GrowingAndShrinkingFrameTest)
+{
+	const SINT64 COUNT = 100;
+
+	Array<SINT64> values;
+	for (SINT64 i = 0; i < COUNT; i++)
+		values.add((i * 7919) % 101);
+
+	// ROWS BETWEEN UNBOUNDED PRECEDING AND CURRENT ROW
+
+	Array<Frame> frames;
+	makeFrames(frames, COUNT, COUNT, 0);
+
+	Aggregate growing;
+	aggregateFrames(values, frames, growing);
+
+	BOOST_TEST(growing.passes == (unsigned) COUNT);
+	BOOST_TEST(growing.retracts == 0u);
+
+	// ROWS BETWEEN CURRENT ROW AND UNBOUNDED FOLLOWING
+
+	frames.clear();
+	makeFrames(frames, COUNT, 0, COUNT);
+
+	Aggregate shrinking;
+	aggregateFrames(values, frames, shrinking);
+
+	// Frames of varying widths, both of their ends move back and forth
+
+	frames.clear();
+
+	for (SINT64 i = 0; i < COUNT; i++)
+	{
+		const SINT64 width = (i * 31) % 7;
+		const Frame frame = {MAX(i - width, 0), MIN(i + (i % 3), COUNT - 1)};
+		frames.add(frame);
+	}
+
+	Aggregate mixed;
+	aggregateFrames(values, frames, mixed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// WindowedStreamTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// WindowedStreamSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -1433,6 +1433,7 @@ static void print_rhd(USHORT length, const rhd* header)
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_large) ? "LRG" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_damaged) ? "DAM" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_not_packed) ? "NPK" : "   ");
+		fprintf(stdout, "%s ", (header->rhd_flags & rhd_lz_packed) ? "LZP" : "   ");
 		fprintf(stdout, "\n");
 	}
 }
@@ -2775,9 +2776,9 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 	const auto format = MET_format(vdr_tdbb, relation, header->rhd_format);
 	auto remainingLength = format->fmt_length;
 
-	auto calculateLength = [remainingLength](ULONG length, const UCHAR* data, bool notPacked)
+	auto calculateLength = [remainingLength](ULONG length, const UCHAR* data, USHORT flags)
 	{
-		if (notPacked)
+		if (flags & rhd_not_packed)
 		{
 			if (length > remainingLength)
 			{
@@ -2793,11 +2794,10 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 			return length;
 		}
 
-		return Compressor::getUnpackedLength(length, data);
+		return Compressor::getUnpackedLength(length, data, (flags & rhd_lz_packed) != 0);
 	};
 
-	bool notPacked = (fragment->rhdf_flags & rhd_not_packed) != 0;
-	remainingLength -= calculateLength(length, p, notPacked);
+	remainingLength -= calculateLength(length, p, fragment->rhdf_flags);
 
 	// Next, chase down fragments, if any
 
@@ -2849,8 +2849,7 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 			length -= RHD_SIZE;
 		}
 
-		notPacked = (fragment->rhdf_flags & rhd_not_packed) != 0;
-		remainingLength -= calculateLength(length, p, notPacked);
+		remainingLength -= calculateLength(length, p, fragment->rhdf_flags);
 
 		page_number = fragment->rhdf_f_page;
 		line_number = fragment->rhdf_f_line;
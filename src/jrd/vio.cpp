@@ -597,7 +597,8 @@ namespace
 			return output;
 		}
 
-		return Compressor::unpack(rpb->rpb_length, rpb->rpb_address, outLength, output);
+		return Compressor::unpack(rpb->rpb_length, rpb->rpb_address, outLength, output,
+								  (rpb->rpb_flags & rpb_lz_packed) != 0);
 	}
 };
 
@@ -5269,6 +5270,390 @@ void VIO_garbage_collect_idx(thread_db* tdbb, jrd_tra* transaction,
 	clearRecordStack(staying);
 }
 
+enum class GCPageResult
+{
+	DONE,
+	RELATION_EXIT,
+	GC_EXIT
+};
+
+static GCPageResult garbage_collect_page(thread_db* tdbb, record_param* rpb,
+	jrd_tra* transaction, ULONG dp_sequence)
+{
+/**************************************
+ *
+ *	g a r b a g e _ c o l l e c t _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Attempt to garbage collect all records on the
+ *	given data page of the relation. Report whether
+ *	the garbage collector or the relation should stop.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	jrd_rel* const relation = rpb->rpb_relation;
+
+	rpb->rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
+	const RecordNumber last(rpb->rpb_number.getValue() + dbb->dbb_max_records);
+
+	GCPageResult result = GCPageResult::DONE;
+
+	while (VIO_next_record(tdbb, rpb, transaction, NULL, DPM_next_data_page))
+	{
+		CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
+
+		if (!(dbb->dbb_flags & DBB_garbage_collector))
+		{
+			result = GCPageResult::GC_EXIT;
+			break;
+		}
+
+		if (relation->rel_flags & (REL_deleting | REL_gc_disabled))
+		{
+			result = GCPageResult::RELATION_EXIT;
+			break;
+		}
+
+		JRD_reschedule(tdbb);
+
+		if (rpb->rpb_number >= last)
+			break;
+
+		// Refresh our notion of the oldest transactions for
+		// efficient garbage collection. This is very cheap.
+
+		transaction->tra_oldest = dbb->dbb_oldest_transaction;
+		transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+	}
+
+	if (TipCache* cache = dbb->dbb_tip_cache)
+		cache->updateActiveSnapshots(tdbb, &tdbb->getAttachment()->att_active_snapshots);
+
+	return result;
+}
+
+
+namespace Jrd
+{
+
+// Distributes the data pages of a single relation collected by the garbage
+// collector between worker attachments. The garbage collector attachment
+// itself is used as the first worker.
+
+class GCTask : public Task
+{
+public:
+	static const ULONG PAGES_PER_ITEM = 16;
+
+	GCTask(thread_db* tdbb, MemoryPool* pool, GarbageCollector* gc,
+		   USHORT relID, PageBitmap* pages, int workers) : Task(),
+		m_pool(pool),
+		m_dbb(tdbb->getDatabase()),
+		m_gc(gc),
+		m_items(*m_pool),
+		m_stop(false),
+		m_gcExit(false),
+		m_relExit(false),
+		m_processed(0),
+		m_relID(relID),
+		m_pages(pages)
+	{
+		Attachment* att = tdbb->getAttachment();
+
+		for (int i = 0; i < workers; i++)
+			m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+
+		m_items[0]->m_ownAttach = false;
+		m_items[0]->m_attStable = att->getStable();
+		m_items[0]->m_tra = tdbb->getTransaction();
+	}
+
+	virtual ~GCTask()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
+
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(GCTask* task) : Task::WorkItem(task),
+			m_inuse(false),
+			m_ownAttach(true),
+			m_tra(NULL),
+			m_pages(*task->m_pool)
+		{}
+
+		virtual ~Item()
+		{
+			if (!m_ownAttach || !m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		GCTask* getGCTask() const
+		{
+			return reinterpret_cast<GCTask*> (m_task);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			FbStatusVector* status = tdbb->tdbb_status_vector;
+
+			Attachment* att = NULL;
+
+			if (m_ownAttach && !m_attStable.hasData())
+				m_attStable = WorkerAttachment::getAttachment(status, getGCTask()->m_dbb);
+
+			if (m_attStable)
+				att = m_attStable->getHandle();
+
+			if (!att)
+			{
+				Arg::Gds(isc_bad_db_handle).copyTo(status);
+				return false;
+			}
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+
+			if (m_ownAttach && !m_tra)
+			{
+				try
+				{
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+					m_tra = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+				}
+				catch(const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+			tdbb->markAsSweeper();
+
+			return true;
+		}
+
+		bool m_inuse;
+		bool m_ownAttach;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+
+		// part of work: data pages to garbage collect
+		HalfStaticArray<ULONG, PAGES_PER_ITEM> m_pages;
+	};
+
+	bool handler(WorkItem& _item);
+
+	bool getWorkItem(WorkItem** pItem);
+	bool getResult(IStatus* status)
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers()
+	{
+		return m_items.getCount();
+	}
+
+	bool gcExit() const
+	{
+		return m_gcExit;
+	}
+
+	bool relExit() const
+	{
+		return m_relExit;
+	}
+
+	ULONG getProcessed() const
+	{
+		return m_processed;
+	}
+
+private:
+	// return pages of the item back to the common bitmap,
+	// the remaining workers or the garbage collector will handle them
+	void returnPages(Item* item)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		for (const auto dp_sequence : item->m_pages)
+			m_pages->set(dp_sequence);
+
+		item->m_pages.clear();
+	}
+
+	void setError(IStatus* status, bool stopTask)
+	{
+		const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+		if (!copyStatus && (!stopTask || m_stop))
+			return;
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		if (m_status.isSuccess() && copyStatus)
+			m_status.save(status);
+		if (stopTask)
+			m_stop = true;
+	}
+
+	MemoryPool* m_pool;
+	Database* m_dbb;
+	GarbageCollector* m_gc;
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	StatusHolder m_status;
+	volatile bool m_stop;
+	volatile bool m_gcExit;
+	volatile bool m_relExit;
+	std::atomic<ULONG> m_processed;
+
+	const USHORT m_relID;		// relation to work on
+	PageBitmap* const m_pages;	// data pages not handled yet
+};
+
+
+bool GCTask::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	if (!item->init(tdbb))
+	{
+		// Worker attachment is not available, leave its work to others
+		returnPages(item);
+		return false;
+	}
+
+	WorkerContextHolder wrkHolder(tdbb, FB_FUNCTION);
+
+	// Collect the garbage ourselves instead of notifying the garbage collector
+
+	Attachment* const att = tdbb->getAttachment();
+	AutoSetRestoreFlag<ULONG> notifyFlag(&att->att_flags, ATT_notify_gc, false);
+	AutoSetRestoreFlag<ULONG> gcFlag(&att->att_flags, ATT_garbage_collector, true);
+
+	record_param rpb;
+	rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+
+	try
+	{
+		jrd_rel* const relation = MET_lookup_relation_id(tdbb, m_relID, false);
+
+		if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
+			m_relExit = m_stop = true;
+		else
+		{
+			jrd_rel::GCShared gcGuard(tdbb, relation);
+
+			if (!gcGuard.gcEnabled())
+				m_relExit = m_stop = true;
+			else
+			{
+				rpb.rpb_relation = relation;
+
+				for (const auto dp_sequence : item->m_pages)
+				{
+					if (m_stop)
+						break;
+
+					const auto result = garbage_collect_page(tdbb, &rpb, item->m_tra, dp_sequence);
+
+					if (result == GCPageResult::GC_EXIT)
+						m_gcExit = m_stop = true;
+					else if (result == GCPageResult::RELATION_EXIT)
+						m_relExit = m_stop = true;
+					else
+					{
+						m_gc->pageProcessed();
+						++m_processed;
+					}
+				}
+			}
+		}
+
+		delete rpb.rpb_record;
+		return !m_stop;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+		delete rpb.rpb_record;
+	}
+
+	setError(tdbb->tdbb_status_vector, true);
+	return false;
+}
+
+bool GCTask::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+	}
+
+	if (!item)
+		return false;
+
+	// assign next portion of data pages to item
+	item->m_pages.clear();
+
+	while (!m_stop && item->m_pages.getCount() < PAGES_PER_ITEM && m_pages->getFirst())
+	{
+		const ULONG dp_sequence = m_pages->current();
+		m_pages->clear(dp_sequence);
+		item->m_pages.add(dp_sequence);
+	}
+
+	if (item->m_pages.hasData())
+		return true;
+
+	item->m_inuse = false;
+	return false;
+}
+
+}; // namespace Jrd
+
+
 void Database::garbage_collector(Database* dbb)
 {
 /**************************************
@@ -5336,6 +5721,7 @@ void Database::garbage_collector(Database* dbb)
 			// to finish up and exit.
 
 			bool flush = false;
+			Coordinator coordinator(dbb->dbb_permanent);
 
 			while (dbb->dbb_flags & DBB_garbage_collector)
 			{
@@ -5361,16 +5747,18 @@ void Database::garbage_collector(Database* dbb)
 				relation = NULL;
 
 				USHORT relID;
+				ULONG pageCount = 0;
 				PageBitmap* gc_bitmap = NULL;
 
 				if ((dbb->dbb_flags & DBB_gc_pending) &&
-					(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID)))
+					(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID, pageCount)))
 				{
 					relation = MET_lookup_relation_id(tdbb, relID, false);
 					if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
 					{
 						delete gc_bitmap;
 						gc_bitmap = NULL;
+						gc->pagesSkipped(pageCount);
 						gc->removeRelation(relID);
 					}
 
@@ -5378,83 +5766,86 @@ void Database::garbage_collector(Database* dbb)
 					{
 						jrd_rel::GCShared gcGuard(tdbb, relation);
 						if (!gcGuard.gcEnabled())
+						{
+							delete gc_bitmap;
+							gc->pagesSkipped(pageCount);
 							continue;
+						}
 
-						rpb.rpb_relation = relation;
-
-						while (gc_bitmap->getFirst())
+						if (!transaction)
 						{
-							const ULONG dp_sequence = gc_bitmap->current();
-
-							if (!(dbb->dbb_flags & DBB_garbage_collector))
-							{
-								gc_exit = true;
-								break;
-							}
+							// Start a "precommitted" transaction by using read-only,
+							// read committed. Of particular note is the absence of a
+							// transaction lock which means the transaction does not
+							// inhibit garbage collection by its very existence.
 
-							if (gc_exit)
-								break;
+							transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+							tdbb->setTransaction(transaction);
+						}
 
-							gc_bitmap->clear(dp_sequence);
+						found = flush = true;
+						rpb.rpb_relation = relation;
 
-							if (!transaction)
-							{
-								// Start a "precommitted" transaction by using read-only,
-								// read committed. Of particular note is the absence of a
-								// transaction lock which means the transaction does not
-								// inhibit garbage collection by its very existence.
+						bool rel_exit = false;
+						ULONG processed = 0;
 
-								transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
-								tdbb->setTransaction(transaction);
-							}
+						// Pages left unprocessed, also when an error is raised below,
+						// are not waiting for garbage collection anymore
+						Cleanup skipPages([&]()
+						{
+							gc->pagesSkipped(pageCount - processed);
+						});
 
-							found = flush = true;
-							rpb.rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
-							const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
+						// Distribute big enough amount of pages between parallel workers.
+						// Pages left unhandled by them are processed below.
 
-							// Attempt to garbage collect all records on the data page.
+						const int workers = MIN(dbb->dbb_config->getGCParallelWorkers(),
+							(int) ((pageCount + GCTask::PAGES_PER_ITEM - 1) / GCTask::PAGES_PER_ITEM));
 
-							bool rel_exit = false;
+						if (workers > 1)
+						{
+							GCTask task(tdbb, dbb->dbb_permanent, gc, relID, gc_bitmap, workers);
+							FbLocalStatus local_status;
 
-							while (VIO_next_record(tdbb, &rpb, transaction, NULL, DPM_next_data_page))
-							{
-								CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+							{	// scope
+								EngineCheckout cout(tdbb, FB_FUNCTION);
+								coordinator.runSync(&task);
+							}
 
-								if (!(dbb->dbb_flags & DBB_garbage_collector))
-								{
-									gc_exit = true;
-									break;
-								}
+							processed += task.getProcessed();
 
-								if (relation->rel_flags & REL_deleting)
-								{
-									rel_exit = true;
-									break;
-								}
+							if (!task.getResult(&local_status))
+								local_status.raise();
 
-								if (relation->rel_flags & REL_gc_disabled)
-								{
-									rel_exit = true;
-									break;
-								}
+							gc_exit = task.gcExit();
+							rel_exit = task.relExit();
+						}
 
-								JRD_reschedule(tdbb);
+						while (!gc_exit && !rel_exit && gc_bitmap->getFirst())
+						{
+							const ULONG dp_sequence = gc_bitmap->current();
 
-								if (rpb.rpb_number >= last)
-									break;
+							if (!(dbb->dbb_flags & DBB_garbage_collector))
+							{
+								gc_exit = true;
+								break;
+							}
 
-								// Refresh our notion of the oldest transactions for
-								// efficient garbage collection. This is very cheap.
+							gc_bitmap->clear(dp_sequence);
 
-								transaction->tra_oldest = dbb->dbb_oldest_transaction;
-								transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
-							}
+							// Attempt to garbage collect all records on the data page.
 
-							if (TipCache* cache = dbb->dbb_tip_cache)
-								cache->updateActiveSnapshots(tdbb, &attachment->att_active_snapshots);
+							const auto result = garbage_collect_page(tdbb, &rpb, transaction, dp_sequence);
 
-							if (gc_exit || rel_exit)
-								break;
+							if (result == GCPageResult::GC_EXIT)
+								gc_exit = true;
+							else if (result == GCPageResult::RELATION_EXIT)
+								rel_exit = true;
+							else
+							{
+								gc->pageProcessed();
+								processed++;
+							}
 						}
 
 						if (gc_exit)
@@ -5689,8 +6080,8 @@ static void list_staying_fast(thread_db* tdbb, record_param* rpb, RecordStack& s
 	fb_assert(temp.rpb_b_page == rpb->rpb_b_page);
 	fb_assert(temp.rpb_b_line == rpb->rpb_b_line);
 
-	fb_assert((temp.rpb_flags & ~(rpb_incomplete | rpb_not_packed)) ==
-			  (rpb->rpb_flags & ~(rpb_incomplete | rpb_not_packed)));
+	fb_assert((temp.rpb_flags & ~(rpb_incomplete | rpb_not_packed | rpb_lz_packed)) ==
+			  (rpb->rpb_flags & ~(rpb_incomplete | rpb_not_packed | rpb_lz_packed)));
 
 	Record* backout_rec = NULL;
 	RuntimeStatistics::Accumulator backversions(tdbb, rpb->rpb_relation,
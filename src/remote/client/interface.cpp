@@ -4780,6 +4780,10 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		fb_assert(!statement->rsr_rows_pending);
 	}
 
+	// Rows requested by earlier batches which have not arrived yet
+
+	const ULONG rowsInFlight = statement->rsr_rows_pending;
+
 	// Check to see if data is waiting.  If not, solicite data.
 
 	if ((!statement->rsr_flags.test(Rsr::STREAM_END | Rsr::STREAM_ERR) &&
@@ -4817,8 +4821,13 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		{
 			if (operation == fetch_next || operation == fetch_prior)
 			{
-				sqldata->p_sqldata_messages = REMOTE_compute_batch_size(
-					port, 0, op_fetch_response, statement->rsr_select_format);
+				if (!statement->rsr_fetch_batch)
+				{
+					statement->rsr_fetch_batch = REMOTE_compute_batch_size(
+						port, 0, op_fetch_response, statement->rsr_select_format);
+				}
+
+				sqldata->p_sqldata_messages = statement->rsr_fetch_batch;
 			}
 
 			// Reorder data when the local buffer is half empty
@@ -4867,6 +4876,17 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 	fb_assert(statement->rsr_msgs_waiting || statement->rsr_rows_pending ||
 			  statement->haveException() || statement->rsr_flags.test(Rsr::STREAM_END));
 
+	// If the local buffer is already empty while the pipelined batch is still
+	// on the way, the rows are consumed faster than the round trip completes.
+	// Ask for bigger batches to keep more data streaming over the wire.
+
+	if (!statement->rsr_msgs_waiting && rowsInFlight && statement->rsr_fetch_batch &&
+		!statement->haveException() && !statement->rsr_flags.test(Rsr::STREAM_END))
+	{
+		statement->rsr_fetch_batch =
+			REMOTE_grow_batch_size(statement->rsr_fetch_batch, statement->rsr_select_format);
+	}
+
 	while (!statement->haveException() &&			// received a database error
 		!statement->rsr_flags.test(Rsr::STREAM_END) &&	// reached end of stream
 		statement->rsr_msgs_waiting < 2	&&			// Have looked ahead for end of batch
@@ -24,6 +24,7 @@
 #include "firebird.h"
 #include <string.h>
 #include "ibase.h"
+#include "memory_routines.h"
 #include "../remote/remote.h"
 #include "../remote/merge_proto.h"
 #include "../yvalve/gds_proto.h"
@@ -48,7 +49,8 @@ USHORT MERGE_database_info(const UCHAR* const in,
 							USHORT base_level,
 							const UCHAR* version,
 							const UCHAR* id,
-							USHORT protocol)
+							USHORT protocol,
+							const rem_port* port)
 {
 /**************************************
  *
@@ -59,6 +61,7 @@ USHORT MERGE_database_info(const UCHAR* const in,
  * Functional description
  *	Merge server / remote interface / Y-valve information into
  *	database block.  Return the actual length of the packet.
+ *	Wire traffic items are replaced when the port is passed.
  *	See also jrd/utl.cpp for decoding of this block.
  *
  **************************************/
@@ -164,6 +167,42 @@ USHORT MERGE_database_info(const UCHAR* const in,
 			--out;
 			break;
 
+		case fb_info_wire_snd_bytes:
+		case fb_info_wire_rcv_bytes:
+		case fb_info_wire_snd_raw_bytes:
+		case fb_info_wire_rcv_raw_bytes:
+			if (port)
+			{
+				if (out + 2 + sizeof(SINT64) >= end)
+				{
+					out[-1] = isc_info_truncated;
+					return 0;
+				}
+
+				FB_UINT64 value = 0;
+				switch (input.getClumpTag())
+				{
+				case fb_info_wire_snd_bytes:
+					value = port->port_snd_bytes;
+					break;
+				case fb_info_wire_rcv_bytes:
+					value = port->port_rcv_bytes;
+					break;
+				case fb_info_wire_snd_raw_bytes:
+					value = port->port_snd_raw_bytes;
+					break;
+				case fb_info_wire_rcv_raw_bytes:
+					value = port->port_rcv_raw_bytes;
+					break;
+				}
+
+				PUT_WORD(out, (USHORT) sizeof(SINT64));
+				put_vax_int64(out, (SINT64) value);
+				out += sizeof(SINT64);
+				break;
+			}
+			// fall through
+
 		default:
 			{
 				USHORT length = input.getClumpLength();
@@ -25,7 +25,8 @@
 #define REMOTE_MERGE_PROTO_H
 
 USHORT MERGE_database_info(const UCHAR*, UCHAR*, USHORT, USHORT,
-							USHORT, USHORT, const UCHAR*, const UCHAR*, USHORT);
+							USHORT, USHORT, const UCHAR*, const UCHAR*, USHORT,
+							const rem_port* = NULL);
 
 #endif // REMOTE_MERGE_PROTO_H
 
@@ -56,6 +56,7 @@ enum LegacyPlugin {PLUGIN_NEW = 0, PLUGIN_LEGACY, PLUGIN_TRUSTED};
 
 void		REMOTE_cleanup_transaction (struct Rtr *);
 USHORT		REMOTE_compute_batch_size (rem_port*, USHORT, P_OP, const rem_fmt*);
+USHORT		REMOTE_grow_batch_size (USHORT, const rem_fmt*);
 void		REMOTE_get_timeout_params(rem_port* port, Firebird::ClumpletReader* pb);
 struct Rrq*	REMOTE_find_request (struct Rrq *, USHORT);
 void		REMOTE_free_packet (rem_port*, struct packet *, bool = false);
@@ -248,6 +248,34 @@ USHORT REMOTE_compute_batch_size(rem_port* port,
 }
 
 
+USHORT REMOTE_grow_batch_size(USHORT batch_size, const rem_fmt* format)
+{
+/**************************************
+ *
+ *	R E M O T E _ g r o w _ b a t c h _ s i z e
+ *
+ **************************************
+ *
+ * Functional description
+ *
+ * The client ran out of rows while the next batch was still
+ * in flight, i.e. the batch was consumed faster than the round
+ * trip to the server. Double the batch so that the following
+ * request covers more of the link latency, but never ask for
+ * more rows than we agreed to cache on the client.
+ *
+ **************************************/
+
+	ULONG limit = MAX_BATCH_CACHE_SIZE / MAX(format->fmt_length, 1);
+	limit = MIN(limit, MAX_USHORT);
+	limit = MAX(limit, MIN_ROWS_PER_BATCH);
+
+	const ULONG result = MIN((ULONG) batch_size * 2, limit);
+
+	return static_cast<USHORT>(MAX(result, batch_size));
+}
+
+
 Rrq* REMOTE_find_request(Rrq* request, USHORT level)
 {
 /**************************************
@@ -563,6 +591,7 @@ void REMOTE_reset_statement( Rsr* statement)
 	statement->rsr_msgs_waiting = 0;
 	statement->rsr_reorder_level = 0;
 	statement->rsr_batch_count = 0;
+	statement->rsr_fetch_batch = 0;
 
 	// only one entry
 
@@ -1409,7 +1438,13 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 {
 #ifdef WIRE_COMPRESS_SUPPORT
 	if (!port->port_compressed)
-		return packet_receive(port, buffer, buffer_length, length);
+	{
+		if (!packet_receive(port, buffer, buffer_length, length))
+			return false;
+
+		port->port_rcv_raw_bytes += *length;
+		return true;
+	}
 
 	z_stream& strm = port->port_recv_stream;
 	strm.avail_out = buffer_length;
@@ -1472,6 +1507,8 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 	}
 
 	*length = (SSHORT) (buffer_length - strm.avail_out);
+	port->port_rcv_raw_bytes += *length;
+
 	if (strm.avail_in)	// Z-buffer still has some data - probably can call inflate() once more on them
 		port->port_z_data = true;
 	else
@@ -1483,7 +1520,11 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 
 	return true;
 #else
-	return packet_receive(port, buffer, buffer_length, length);
+	if (!packet_receive(port, buffer, buffer_length, length))
+		return false;
+
+	port->port_rcv_raw_bytes += *length;
+	return true;
 #endif
 }
 
@@ -1491,12 +1532,13 @@ bool REMOTE_deflate(RemoteXdr* xdrs, ProtoWrite* proto_write, PacketSend* packet
 {
 #ifdef WIRE_COMPRESS_SUPPORT
 	rem_port* port = xdrs->x_public;
+	const ULONG dataLength = xdrs->x_private - xdrs->x_base;
+	port->port_snd_raw_bytes += dataLength;
+
 	if (!(port->port_compressed && (port->port_flags & PORT_compressed)))
 		return proto_write(xdrs);
 
 	z_stream& strm = port->port_send_stream;
-	strm.avail_in = xdrs->x_private - xdrs->x_base;
-	strm.next_in = (Bytef*) xdrs->x_base;
 
 	if (!strm.next_out)
 	{
@@ -1504,6 +1546,32 @@ bool REMOTE_deflate(RemoteXdr* xdrs, ProtoWrite* proto_write, PacketSend* packet
 		strm.next_out = (Bytef*) &port->port_compressed[REM_SEND_OFFSET(port->port_buff_size)];
 	}
 
+	// Small packets are not worth the CPU spent on compressing them, send them
+	// as stored blocks. The level may be changed only while deflate has no
+	// pending input, i.e. right after the previous packet was flushed.
+
+	if (port->port_z_flushed)
+	{
+		const int level = (flush && dataLength < port->port_z_threshold) ?
+			Z_NO_COMPRESSION : port->port_z_level;
+
+		if (level != port->port_z_cur_level)
+		{
+			strm.avail_in = 0;
+
+			const int ret = zlib().deflateParams(&strm, level, Z_DEFAULT_STRATEGY);
+			if (ret == Z_OK)
+				port->port_z_cur_level = level;
+			else if (ret != Z_BUF_ERROR)
+				return false;
+		}
+	}
+
+	port->port_z_flushed = flush;
+
+	strm.avail_in = dataLength;
+	strm.next_in = (Bytef*) xdrs->x_base;
+
 	bool expectMoreOut = flush;
 
 	while (strm.avail_in || expectMoreOut)
@@ -1578,7 +1646,13 @@ void rem_port::initCompression()
 		port_send_stream.zalloc = Firebird::ZLib::allocFunc;
 		port_send_stream.zfree = Firebird::ZLib::freeFunc;
 		port_send_stream.opaque = Z_NULL;
-		int ret = zlib().deflateInit(&port_send_stream, Z_DEFAULT_COMPRESSION);
+		const auto config = getPortConfig();
+		port_z_level = config->getWireCompressionLevel();
+		port_z_cur_level = port_z_level;
+		port_z_threshold = config->getWireCompressionThreshold();
+		port_z_flushed = true;
+
+		int ret = zlib().deflateInit(&port_send_stream, port_z_level);
 		if (ret != Z_OK)
 			(Firebird::Arg::Gds(isc_deflate_init) << Firebird::Arg::Num(ret)).raise();
 		port_send_stream.next_out = NULL;
@@ -484,6 +484,7 @@ struct Rsr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rsr>
 	USHORT			rsr_msgs_waiting; 	// count of full rsr_messages
 	USHORT			rsr_reorder_level; 	// Trigger pipelining at this level
 	USHORT			rsr_batch_count; 	// Count of batches in pipeline
+	USHORT			rsr_fetch_batch;	// Adaptive prefetch batch size
 
 	Firebird::string rsr_cursor_name;	// Name for cursor to be set on open
 	bool			rsr_delayed_format;	// Out format was delayed on execute, set it on fetch
@@ -552,6 +553,7 @@ public:
 		rsr_format(0), rsr_message(0), rsr_buffer(0), rsr_status(0),
 		rsr_id(0), rsr_fmt_length(0),
 		rsr_rows_pending(0), rsr_msgs_waiting(0), rsr_reorder_level(0), rsr_batch_count(0),
+		rsr_fetch_batch(0),
 		rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0), rsr_self(NULL),
 		rsr_fetch_operation(fetch_next), rsr_fetch_position(0)
 	{ }
@@ -1182,10 +1184,16 @@ struct rem_port : public Firebird::GlobalStorage, public Firebird::RefCounted
 	FB_UINT64 port_rcv_packets;
 	FB_UINT64 port_snd_bytes;
 	FB_UINT64 port_rcv_bytes;
+	FB_UINT64 port_snd_raw_bytes;		// bytes sent before compression
+	FB_UINT64 port_rcv_raw_bytes;		// bytes received after decompression
 
 #ifdef WIRE_COMPRESS_SUPPORT
 	z_stream port_send_stream, port_recv_stream;
 	UCharArrayAutoPtr	port_compressed;
+	int			port_z_level;			// configured deflate level
+	int			port_z_cur_level;		// deflate level in effect
+	ULONG		port_z_threshold;		// don't compress smaller packets
+	bool		port_z_flushed;			// no pending data in deflate stream
 #endif
 
 public:
@@ -1221,7 +1229,12 @@ public:
 		port_known_server_keys(getPool()), port_crypt_plugin(NULL),
 		port_client_crypt_callback(NULL), port_server_crypt_callback(NULL), port_crypt_name(getPool()),
 		port_replicator(NULL), port_buffer(FB_NEW_POOL(getPool()) UCHAR[rpt]),
-		port_snd_packets(0), port_rcv_packets(0), port_snd_bytes(0), port_rcv_bytes(0)
+		port_snd_packets(0), port_rcv_packets(0), port_snd_bytes(0), port_rcv_bytes(0),
+		port_snd_raw_bytes(0), port_rcv_raw_bytes(0)
+#ifdef WIRE_COMPRESS_SUPPORT
+		, port_z_level(Z_DEFAULT_COMPRESSION), port_z_cur_level(Z_DEFAULT_COMPRESSION),
+		port_z_threshold(0), port_z_flushed(true)
+#endif
 	{
 		addRef();
 		memset(&port_linger, 0, sizeof port_linger);
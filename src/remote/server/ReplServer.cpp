@@ -32,6 +32,9 @@
 #include "../common/os/path_utils.h"
 #include "../common/isc_proto.h"
 #include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/Hash.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/semaphore.h"
 #include "../common/ThreadStart.h"
 #include "../common/utils_proto.h"
 #include "../common/classes/ParsedList.h"
@@ -75,6 +78,11 @@ namespace
 	const USHORT CTL_VERSION1 = 1;
 	const USHORT CTL_CURRENT_VERSION = CTL_VERSION1;
 
+	// Parallel apply: max number of blocks queued per worker and
+	// max number of blocks applied before the control file is updated
+	const FB_SIZE_T MAX_QUEUED_BLOCKS = 64;
+	const ULONG MAX_UNSAVED_BLOCKS = 1024;
+
 	volatile bool shutdownFlag = false;
 	AtomicCounter activeThreads;
 	Semaphore shutdownSemaphore;
@@ -336,6 +344,411 @@ namespace
 #endif
 	};
 
+	IAttachment* attachReplica(const Replication::Config* config)
+	{
+		ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
+
+		dpb.insertByte(isc_dpb_no_db_triggers, 1);
+		dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
+		dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(config->dbName));
+
+		DispatcherPtr provider;
+		FbLocalStatus localStatus;
+
+		const auto att =
+			provider->attachDatabase(&localStatus, config->dbName.c_str(),
+									 dpb.getBufferLength(), dpb.getBuffer());
+		localStatus.check();
+
+		return att;
+	}
+
+	// Tables changed by the replication block and other details that matter
+	// when blocks of different transactions are applied in parallel.
+	// Table names are reduced to hash values: a collision may only cause
+	// some extra ordering between transactions, never a missed conflict.
+
+	typedef SortedArray<ULONG, InlineStorage<ULONG, 8> > RelationSet;
+
+	// Pseudo table standing for all the tables linked by foreign keys.
+	// Their changes are ordered as a whole, so that e.g. a detail record
+	// is never applied before the master one it refers to.
+	const ULONG LINKED_RELATIONS = 0;
+
+	struct BlockInfo
+	{
+		explicit BlockInfo(MemoryPool& pool)
+			: relations(pool), exclusive(false), cleanup(false)
+		{}
+
+		RelationSet relations;
+		bool exclusive;		// SQL statement is executed, apply it alone
+		bool cleanup;		// transaction(s) are cleaned up
+	};
+
+	class BlockScanner
+	{
+	public:
+		BlockScanner(ULONG length, const UCHAR* data)
+			: m_data(data + sizeof(Block)), m_end(data + length)
+		{}
+
+		// Returns false if the block cannot be parsed, error is reported by the applier
+		bool scan(BlockInfo& info)
+		{
+			HalfStaticArray<ULONG, 16> atoms;
+
+			while (m_data < m_end)
+			{
+				const UCHAR op = *m_data++;
+
+				switch (op)
+				{
+				case opStartTransaction:
+				case opPrepareTransaction:
+				case opCommitTransaction:
+				case opRollbackTransaction:
+				case opStartSavepoint:
+				case opReleaseSavepoint:
+				case opRollbackSavepoint:
+					break;
+
+				case opCleanupTransaction:
+					info.cleanup = true;
+					break;
+
+				case opInsertRecord:
+				case opUpdateRecord:
+				case opDeleteRecord:
+					{
+						SLONG atom;
+						if (!getInt32(atom) || atom < 0 || (ULONG) atom >= atoms.getCount())
+							return false;
+
+						if (!info.relations.exist(atoms[atom]))
+							info.relations.add(atoms[atom]);
+
+						if (!skipRecord() || (op == opUpdateRecord && !skipRecord()))
+							return false;
+					}
+					break;
+
+				case opStoreBlob:
+					if (!skip(2 * sizeof(SLONG)))
+						return false;
+
+					while (m_data < m_end)
+					{
+						if (m_data + sizeof(USHORT) > m_end)
+							return false;
+
+						USHORT length;
+						memcpy(&length, m_data, sizeof(USHORT));
+						m_data += sizeof(USHORT);
+
+						if (!length)
+							break;
+
+						if (!skip(length))
+							return false;
+					}
+					break;
+
+				case opExecuteSql:
+				case opExecuteSqlIntl:
+					info.exclusive = true;
+					return true;
+
+				case opSetSequence:
+					// Sequences are never decremented by the applier, order does not matter
+					if (!skip(sizeof(SLONG) + sizeof(SINT64)))
+						return false;
+					break;
+
+				case opDefineAtom:
+					{
+						if (m_data >= m_end)
+							return false;
+
+						const UCHAR length = *m_data++;
+						if (m_data + length > m_end)
+							return false;
+
+						atoms.add(InternalHash::hash(length, m_data));
+						m_data += length;
+					}
+					break;
+
+				default:
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		const UCHAR* m_data;
+		const UCHAR* const m_end;
+
+		bool skip(ULONG length)
+		{
+			if (m_data + length > m_end)
+				return false;
+
+			m_data += length;
+			return true;
+		}
+
+		bool getInt32(SLONG& value)
+		{
+			if (m_data + sizeof(SLONG) > m_end)
+				return false;
+
+			memcpy(&value, m_data, sizeof(SLONG));
+			m_data += sizeof(SLONG);
+			return true;
+		}
+
+		bool skipRecord()
+		{
+			SLONG length;
+			return getInt32(length) && length >= 0 && skip(length);
+		}
+	};
+
+	// Worker applying replication blocks using its own attachment.
+	// Blocks are queued by the replication thread, see Target::dispatch().
+
+	class ApplyWorker : public GlobalStorage
+	{
+		struct Task
+		{
+			Task(MemoryPool& pool, FB_UINT64 aTicket, FB_UINT64 aSequence, ULONG aOffset,
+				 ULONG length, const UCHAR* block)
+				: ticket(aTicket), sequence(aSequence), offset(aOffset),
+				  queued(fb_utils::query_performance_counter()), data(pool)
+			{
+				data.add(block, length);
+			}
+
+			const FB_UINT64 ticket;
+			const FB_UINT64 sequence;
+			const ULONG offset;
+			const SINT64 queued;
+			Array<UCHAR> data;
+		};
+
+	public:
+		ApplyWorker(const Replication::Config* config, unsigned number)
+			: m_transactions(0), m_errorSequence(0), m_errorOffset(0),
+			  m_blocks(0), m_maxLag(0),
+			  m_number(number), m_queue(getPool()),
+			  m_dispatched(0), m_applied(0), m_failed(false), m_stop(false)
+		{
+			m_attachment.assignRefNoIncr(attachReplica(config));
+
+			FbLocalStatus localStatus;
+			const auto repl = m_attachment->createReplicator(&localStatus);
+			localStatus.check();
+			m_replicator.assignRefNoIncr(repl);
+
+			Thread::start(apply_thread, this, THREAD_medium, &m_thread);
+		}
+
+		~ApplyWorker()
+		{
+			m_stop = true;
+			m_work.release();
+			Thread::waitForCompletion(m_thread);
+
+			while (m_queue.hasData())
+				delete m_queue.pop();
+		}
+
+		unsigned getNumber() const
+		{
+			return m_number;
+		}
+
+		// Called by the replication thread only
+
+		FB_UINT64 enqueue(FB_UINT64 ticket, FB_UINT64 sequence, ULONG offset,
+						  ULONG length, const UCHAR* data)
+		{
+			while (getQueueLength() >= MAX_QUEUED_BLOCKS && !shutdownFlag && !m_failed)
+				m_done.tryEnter(0, 100);
+
+			const auto task = FB_NEW_POOL(getPool()) Task(getPool(), ticket, sequence, offset, length, data);
+
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+				m_queue.add(task);
+			}
+
+			m_dispatched = ticket;
+			m_work.release();
+
+			return ticket;
+		}
+
+		void waitFor(FB_UINT64 ticket)
+		{
+			while (m_applied.load() < ticket && !shutdownFlag)
+				m_done.tryEnter(0, 100);
+		}
+
+		bool isIdle() const
+		{
+			return m_applied.load() >= m_dispatched;
+		}
+
+		FB_UINT64 getDispatched() const
+		{
+			return m_dispatched;
+		}
+
+		FB_SIZE_T getQueueLength()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return m_queue.getCount();
+		}
+
+		bool isFailed() const
+		{
+			return m_failed;
+		}
+
+		// Number of transactions routed to this worker and not finished yet
+		ULONG m_transactions;
+
+		// Error details are stable once isFailed() returns true
+		FbLocalStatus m_status;
+		FB_UINT64 m_errorSequence;
+		ULONG m_errorOffset;
+
+		// Statistics since the last report: blocks applied and max time
+		// between block queueing and its completion
+		std::atomic<ULONG> m_blocks;
+		std::atomic<SINT64> m_maxLag;
+
+	private:
+		static THREAD_ENTRY_DECLARE apply_thread(THREAD_ENTRY_PARAM arg)
+		{
+			static_cast<ApplyWorker*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			while (true)
+			{
+				m_work.enter();
+
+				Task* task = nullptr;
+
+				{	// scope
+					MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+					if (m_queue.hasData())
+					{
+						task = m_queue[0];
+						m_queue.remove((FB_SIZE_T) 0);
+					}
+				}
+
+				if (!task)
+				{
+					if (m_stop)
+						break;
+
+					continue;
+				}
+
+				// After a failure the remaining blocks are skipped,
+				// they will be re-applied after reconnect
+				if (!m_failed && !m_stop)
+				{
+					FbLocalStatus localStatus;
+					m_replicator->process(&localStatus, task->data.getCount(), task->data.begin());
+
+					if (!localStatus.isSuccess())
+					{
+						m_status->setErrors(localStatus->getErrors());
+						m_errorSequence = task->sequence;
+						m_errorOffset = task->offset;
+						m_failed = true;
+					}
+				}
+
+				const SINT64 lag = fb_utils::query_performance_counter() - task->queued;
+				if (lag > m_maxLag.load())
+					m_maxLag = lag;
+				++m_blocks;
+
+				m_applied = task->ticket;
+				delete task;
+
+				m_done.release();
+			}
+		}
+
+		const unsigned m_number;
+		RefPtr<IAttachment> m_attachment;
+		RefPtr<IReplicator> m_replicator;
+		Thread::Handle m_thread;
+
+		Mutex m_mutex;
+		Array<Task*> m_queue;
+		Semaphore m_work;
+		Semaphore m_done;
+
+		FB_UINT64 m_dispatched;
+		std::atomic<FB_UINT64> m_applied;
+		std::atomic<bool> m_failed;
+		std::atomic<bool> m_stop;
+	};
+
+	// Transaction being applied by a worker
+	struct TxnRoute
+	{
+		TxnRoute(MemoryPool& pool, TraNumber id, ApplyWorker* aWorker)
+			: tra_id(id), worker(aWorker), relations(pool), exclusive(false)
+		{}
+
+		static const TraNumber& generate(const TxnRoute* item)
+		{
+			return item->tra_id;
+		}
+
+		const TraNumber tra_id;
+		ApplyWorker* const worker;
+		RelationSet relations;		// tables changed by the transaction
+		bool exclusive;				// transaction executed SQL statement(s)
+	};
+
+	typedef SortedArray<TxnRoute*, EmptyStorage<TxnRoute*>, TraNumber, TxnRoute> TxnRouteList;
+
+	// Last blocks (per worker) changing the table
+	struct RelationWriters
+	{
+		RelationWriters(MemoryPool& pool, ULONG rel, FB_SIZE_T workers)
+			: relation(rel), tickets(pool)
+		{
+			tickets.resize(workers, 0);
+		}
+
+		static const ULONG& generate(const RelationWriters* item)
+		{
+			return item->relation;
+		}
+
+		const ULONG relation;
+		HalfStaticArray<FB_UINT64, 8> tickets;
+	};
+
+	typedef SortedArray<RelationWriters*, EmptyStorage<RelationWriters*>, ULONG, RelationWriters> RelationWritersList;
+
 	class Target : public GlobalStorage
 	{
 	public:
@@ -343,7 +756,9 @@ namespace
 			: m_config(config),
 			  m_attachment(nullptr), m_replicator(nullptr),
 			  m_sequence(0), m_connected(false),
-			  m_lastError(getPool()), m_errorSequence(0), m_errorOffset(0)
+			  m_lastError(getPool()), m_errorSequence(0), m_errorOffset(0),
+			  m_workers(getPool()), m_routes(getPool()), m_writers(getPool()),
+			  m_linked(getPool()), m_ticket(0), m_unsaved(0)
 		{
 		}
 
@@ -367,25 +782,24 @@ namespace
 			if (m_connected)
 				return m_sequence;
 
-			ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
-
-			dpb.insertByte(isc_dpb_no_db_triggers, 1);
-			dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
-			dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(m_config->dbName));
-
 #ifndef NO_DATABASE
-			DispatcherPtr provider;
 			FbLocalStatus localStatus;
 
-			const auto att =
-				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
-										 dpb.getBufferLength(), dpb.getBuffer());
-			localStatus.check();
-			m_attachment.assignRefNoIncr(att);
+			m_attachment.assignRefNoIncr(attachReplica(m_config));
 
-			const auto repl = m_attachment->createReplicator(&localStatus);
-			localStatus.check();
-			m_replicator.assignRefNoIncr(repl);
+			if (m_config->applyWorkers > 1)
+			{
+				for (unsigned i = 0; i < m_config->applyWorkers; i++)
+					m_workers.add(FB_NEW ApplyWorker(m_config, i));
+
+				loadLinkedRelations();
+			}
+			else
+			{
+				const auto repl = m_attachment->createReplicator(&localStatus);
+				localStatus.check();
+				m_replicator.assignRefNoIncr(repl);
+			}
 
 			fb_assert(!m_sequence);
 
@@ -413,6 +827,19 @@ namespace
 
 		void shutdown()
 		{
+			while (m_workers.hasData())
+				delete m_workers.pop();
+
+			while (m_routes.hasData())
+				delete m_routes.pop();
+
+			while (m_writers.hasData())
+				delete m_writers.pop();
+
+			m_linked.clear();
+			m_ticket = 0;
+			m_unsaved = 0;
+
 			m_replicator = nullptr;
 			m_attachment = nullptr;
 			m_sequence = 0;
@@ -424,6 +851,12 @@ namespace
 #ifdef NO_DATABASE
 			return true;
 #else
+			if (m_workers.hasData())
+			{
+				dispatch(sequence, offset, length, data);
+				return;
+			}
+
 			fb_assert(m_replicator);
 
 			FbLocalStatus localStatus;
@@ -432,6 +865,55 @@ namespace
 #endif
 		}
 
+		// Check whether all blocks replicated so far are applied, so that
+		// the current position may be stored in the control file.
+		// Being too far ahead of the control file, wait for the workers.
+		bool checkpoint()
+		{
+			if (m_workers.isEmpty())
+				return true;
+
+			checkWorkers();
+
+			bool idle = true;
+			for (const auto worker : m_workers)
+				idle = idle && worker->isIdle();
+
+			if (!idle && ++m_unsaved >= MAX_UNSAVED_BLOCKS)
+			{
+				drain();
+				idle = !shutdownFlag;
+			}
+
+			if (idle)
+				m_unsaved = 0;
+
+			return idle;
+		}
+
+		// Wait for all dispatched blocks to be applied
+		void drain()
+		{
+			for (const auto worker : m_workers)
+				worker->waitFor(worker->getDispatched());
+
+			checkWorkers();
+		}
+
+		void reportWorkers()
+		{
+			const double frequency = (double) fb_utils::query_performance_frequency();
+
+			for (const auto worker : m_workers)
+			{
+				const ULONG blocks = worker->m_blocks.exchange(0);
+				const SINT64 lag = worker->m_maxLag.exchange(0);
+
+				verbose("Worker %u applied %u block(s), max lag %.3lfs",
+						worker->getNumber(), blocks, lag / frequency);
+			}
+		}
+
 		bool isShutdown() const
 		{
 			return (m_attachment == NULL);
@@ -491,6 +973,209 @@ namespace
 		}
 
 	private:
+		void checkWorkers()
+		{
+			for (const auto worker : m_workers)
+			{
+				if (worker->isFailed())
+					checkCompletion(worker->m_status, worker->m_errorSequence, worker->m_errorOffset);
+			}
+		}
+
+		// Collect the tables referencing or referenced by foreign keys
+		void loadLinkedRelations()
+		{
+			FbLocalStatus localStatus;
+
+			RefPtr<ITransaction> transaction(REF_NO_INCR,
+				m_attachment->startTransaction(&localStatus, 0, NULL));
+			localStatus.check();
+
+			const char* sql =
+				"select trim(rc.rdb$relation_name) from rdb$relation_constraints rc "
+				"	where rc.rdb$constraint_type = 'FOREIGN KEY' "
+				"union "
+				"select trim(uq.rdb$relation_name) from rdb$ref_constraints ref "
+				"	join rdb$relation_constraints uq on uq.rdb$constraint_name = ref.rdb$const_name_uq";
+
+			FB_MESSAGE(Result, CheckStatusWrapper,
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), name)
+			) result(&localStatus, fb_get_master_interface());
+
+			RefPtr<IResultSet> cursor(REF_NO_INCR,
+				m_attachment->openCursor(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+										 NULL, NULL, result.getMetadata(), NULL, 0));
+			localStatus.check();
+
+			m_linked.clear();
+
+			while (cursor->fetchNext(&localStatus, result.getData()) == IStatus::RESULT_OK)
+			{
+				const ULONG relation = InternalHash::hash(result->name.length,
+					(const UCHAR*) result->name.str);
+
+				if (!m_linked.exist(relation))
+					m_linked.add(relation);
+			}
+
+			localStatus.check();
+		}
+
+		// Wait until changes of the table made by other workers are applied
+		void waitForWriters(ULONG relation, const ApplyWorker* worker)
+		{
+			FB_SIZE_T pos;
+			if (!m_writers.find(relation, pos))
+				return;
+
+			const auto writers = m_writers[pos];
+
+			for (const auto other : m_workers)
+			{
+				if (other != worker)
+					other->waitFor(writers->tickets[other->getNumber()]);
+			}
+		}
+
+		void setWriter(ULONG relation, const ApplyWorker* worker, FB_UINT64 ticket)
+		{
+			FB_SIZE_T pos;
+			if (!m_writers.find(relation, pos))
+			{
+				const auto writers =
+					FB_NEW_POOL(getPool()) RelationWriters(getPool(), relation, m_workers.getCount());
+				pos = m_writers.add(writers);
+			}
+
+			m_writers[pos]->tickets[worker->getNumber()] = ticket;
+		}
+
+		// Choose the worker with less transactions (and then less queued blocks)
+		ApplyWorker* pickWorker() const
+		{
+			ApplyWorker* best = nullptr;
+
+			for (const auto worker : m_workers)
+			{
+				if (!best || worker->m_transactions < best->m_transactions ||
+					(worker->m_transactions == best->m_transactions &&
+						worker->getQueueLength() < best->getQueueLength()))
+				{
+					best = worker;
+				}
+			}
+
+			return best;
+		}
+
+		// Route the block to the worker applying its transaction. Blocks of other
+		// transactions changing the same tables, if applied by different workers,
+		// are waited for to preserve the original order of conflicting changes.
+		// Tables linked by foreign keys are ordered as a single one.
+		// SQL statements (DDL) and blocks not bound to a transaction are applied
+		// exclusively, with all the workers being idle.
+		void dispatch(FB_UINT64 sequence, ULONG offset, ULONG length, const UCHAR* data)
+		{
+			checkWorkers();
+
+			const Block* const header = (const Block*) data;
+			const TraNumber traNumber = header->traNumber;
+
+			BlockInfo info(getPool());
+			if (!BlockScanner(length, data).scan(info))
+				info.exclusive = true;
+
+			bool linked = false;
+			for (const auto relation : info.relations)
+				linked = linked || m_linked.exist(relation);
+
+			if (linked && !info.relations.exist(LINKED_RELATIONS))
+				info.relations.add(LINKED_RELATIONS);
+
+			if (!traNumber)
+			{
+				drain();
+
+				if (info.cleanup)
+				{
+					// Every worker has to cleanup transactions it's applying
+					for (const auto worker : m_workers)
+						worker->enqueue(++m_ticket, sequence, offset, length, data);
+
+					while (m_routes.hasData())
+						delete m_routes.pop();
+
+					for (const auto worker : m_workers)
+						worker->m_transactions = 0;
+				}
+				else
+					m_workers[0]->enqueue(++m_ticket, sequence, offset, length, data);
+
+				drain();
+
+				if (info.exclusive)
+					loadLinkedRelations();
+
+				return;
+			}
+
+			TxnRoute* route = nullptr;
+
+			FB_SIZE_T pos;
+			if (m_routes.find(traNumber, pos))
+				route = m_routes[pos];
+			else
+			{
+				const auto worker = pickWorker();
+				route = FB_NEW_POOL(getPool()) TxnRoute(getPool(), traNumber, worker);
+				pos = m_routes.add(route);
+				worker->m_transactions++;
+			}
+
+			const auto worker = route->worker;
+			const bool end = (header->flags & BLOCK_END_TRANS);
+
+			if (info.exclusive)
+				route->exclusive = true;
+
+			if (info.exclusive || (end && route->exclusive))
+				drain();
+			else
+			{
+				for (const auto relation : info.relations)
+					waitForWriters(relation, worker);
+			}
+
+			const FB_UINT64 ticket = worker->enqueue(++m_ticket, sequence, offset, length, data);
+
+			for (const auto relation : info.relations)
+			{
+				setWriter(relation, worker, ticket);
+
+				if (!route->relations.exist(relation))
+					route->relations.add(relation);
+			}
+
+			if (end)
+			{
+				// Transaction end makes its changes visible to the others
+
+				for (const auto relation : route->relations)
+					setWriter(relation, worker, ticket);
+
+				if (route->exclusive)
+				{
+					// Foreign keys could be changed by the DDL just applied
+					drain();
+					loadLinkedRelations();
+				}
+
+				m_routes.remove(pos);
+				worker->m_transactions--;
+				delete route;
+			}
+		}
+
 		AutoPtr<const Replication::Config> m_config;
 		RefPtr<IAttachment> m_attachment;
 		RefPtr<IReplicator> m_replicator;
@@ -499,6 +1184,12 @@ namespace
 		string m_lastError;
 		FB_UINT64 m_errorSequence;
 		ULONG m_errorOffset;
+		Array<ApplyWorker*> m_workers;
+		TxnRouteList m_routes;
+		RelationWritersList m_writers;
+		RelationSet m_linked;		// tables linked by foreign keys
+		FB_UINT64 m_ticket;
+		ULONG m_unsaved;
 	};
 
 	typedef Array<Target*> TargetList;
@@ -732,6 +1423,7 @@ namespace
 			// Second pass: replicate the chain of contiguous segments
 
 			Array<UCHAR> buffer(pool);
+			UCharBuffer unpacked(pool);
 			TransactionList transactions(pool);
 
 			const FB_UINT64 max_sequence = queue.back()->header.hdr_sequence;
@@ -828,6 +1520,9 @@ namespace
 				if (memcmp(&header, &segment->header, sizeof(SegmentHeader)))
 					raiseError("Journal file %s was unexpectedly changed", segment->filename.c_str());
 
+				// Compressed blocks: stored and original size
+				FB_UINT64 packedLength = 0, unpackedLength = 0;
+
 				ULONG totalLength = sizeof(SegmentHeader);
 				while (totalLength < segment->header.hdr_length)
 				{
@@ -852,15 +1547,32 @@ namespace
 						if (read(file, data + sizeof(Block), blockLength) != blockLength)
 							raiseError("Journal file %s read failed (error %d)", segment->filename.c_str(), ERRNO);
 
-						replicate(target, transactions, sequence, totalLength,
-								  length, data, rewind);
+						if (decompressBlock(length, data, unpacked))
+						{
+							packedLength += length;
+							unpackedLength += unpacked.getCount();
+
+							replicate(target, transactions, sequence, totalLength,
+									  unpacked.getCount(), unpacked.begin(), rewind);
+						}
+						else
+						{
+							replicate(target, transactions, sequence, totalLength,
+									  length, data, rewind);
+						}
 					}
 
 					totalLength += length;
 
-					control.savePartial(sequence, totalLength, transactions);
+					if (target->checkpoint())
+						control.savePartial(sequence, totalLength, transactions);
 				}
 
+				target->drain();
+
+				if (shutdownFlag)
+					return PROCESS_SHUTDOWN;
+
 				control.saveComplete(sequence, transactions);
 
 				file.release();
@@ -887,6 +1599,15 @@ namespace
 				target->verbose("Segment %" UQUADFORMAT " (%u bytes) is replicated in %s, %s",
 								sequence, totalLength, interval.c_str(), extra.c_str());
 
+				if (packedLength)
+				{
+					target->verbose("Segment %" UQUADFORMAT " contains %" UQUADFORMAT " bytes of changes compressed into %"
+									UQUADFORMAT " bytes (ratio %.2lf)", sequence, unpackedLength, packedLength,
+									(double) unpackedLength / packedLength);
+				}
+
+				target->reportWorkers();
+
 				if (!oldest_sequence)
 					segment->remove();
 
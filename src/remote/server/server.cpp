@@ -4109,6 +4109,14 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 
 	const USHORT max_records = prefetch ? sqldata->p_sqldata_messages : 1;
 
+	// Modern clients limit the batch by their cache size and grow it adaptively
+	// when the link latency dominates, so let the whole batch stream out instead
+	// of cutting it after a fixed number of packets.
+
+	const ULONG max_packets = (this->port_protocol >= PROTOCOL_VERSION13) ?
+		MAX(MAX_PACKETS_PER_BATCH, MAX_BATCH_CACHE_SIZE / this->port_buff_size) :
+		MAX_PACKETS_PER_BATCH;
+
 	// Get ready to ship the data out
 
 	P_SQLDATA* response = &sendL->p_sqldata;
@@ -4236,9 +4244,9 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 
 		// If we've hit maximum prefetch size, break out of loop
 
-		const USHORT packets = this->port_snd_packets - org_packets;
+		const FB_UINT64 packets = this->port_snd_packets - org_packets;
 
-		if (packets >= MAX_PACKETS_PER_BATCH && count >= MIN_ROWS_PER_BATCH)
+		if (packets >= max_packets && count >= MIN_ROWS_PER_BATCH)
 			break;
 	}
 
@@ -4611,7 +4619,7 @@ void rem_port::info(P_OP op, P_INFO* stuff, PACKET* sendL)
 				DbImplementation::current.backwardCompatibleImplementation(), 4, 1,
 				reinterpret_cast<const UCHAR*>(version.c_str()),
 				reinterpret_cast<const UCHAR*>(this->port_host->str_data),
-				protocol);
+				protocol, this);
 		}
 		break;
 